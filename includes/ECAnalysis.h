@@ -0,0 +1,104 @@
+#ifndef _EIGHTCHIP_ANALYSIS_INCLUDED_
+#define _EIGHTCHIP_ANALYSIS_INCLUDED_
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "ECCpu.h"
+#include "ECGlobals.h"
+#include "ECOpcodes.h"
+#include "ECQuirks.h"
+
+//-------------------------------------------------------------------------------------------------
+// Straight line of instructions entered at start only and left at its last instruction only
+struct EightChipBlock
+{
+    // Address of the first instruction and address right after the last one
+    WORD start;
+    WORD end;
+
+    // Address of the last instruction and instructions in the block, F000 NNNN being 4 bytes long
+    WORD last;
+    int length;
+
+    // Instruction that ends the block (see. EightChipOpcodeId)
+    EightChipOpcodeId terminator;
+
+    // Blocks control can flow to, a call flows to the instruction after it
+    std::vector< WORD > successors;
+
+    // Times the block was entered and instructions executed in it during profiling
+    unsigned long long executions;
+    unsigned long long instructions;
+};
+
+//-------------------------------------------------------------------------------------------------
+// What each byte of memory was found to be
+enum EightChipCodeMark
+{
+    CODE_NONE = 0,
+    CODE_INSTRUCTION,  // First byte of an instruction
+    CODE_OPERAND,      // Second byte of an instruction
+};
+
+//-------------------------------------------------------------------------------------------------
+struct EightChipAnalysis
+{
+    // Rom image, loaded at 0x200, and the profile it was analysed under
+    std::vector< BYTE > rom;
+    EightChipProfile profile = PROFILE_EIGHTCHIP;
+
+    // EightChipCodeMark of every address of the game memory
+    std::vector< BYTE > codeMap;
+
+    // Basic blocks by start address
+    std::map< WORD, EightChipBlock > blocks;
+
+    // Subroutine entry points (and 0x200) to the subroutines they call
+    std::map< WORD, std::set< WORD > > calls;
+
+    // BNNN instructions, their target depends on V0
+    std::vector< WORD > computedJumps;
+
+    // Instructions writing into code (FX33/FX55 with a known I), and the ones writing at an I
+    // the analysis couldn't follow
+    std::vector< WORD > selfModifyingWrites;
+    std::vector< WORD > unknownWrites;
+
+    // Rom bytes that are never decoded as code [start, end), and constants loaded into I
+    std::vector< std::pair< WORD, WORD > > dataRegions;
+    std::set< WORD > dataReferences;
+
+    // Addresses executed during profiling that the static analysis didn't reach
+    std::map< WORD, unsigned long long > unknownExecutions;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ecanalysis
+{
+    // Recovers the blocks, call graph and data regions of a rom by recursive descent from 0x200,
+    // following I under the profile's quirks
+    void Analyse( const BYTE* rom, size_t size, EightChipProfile profile, EightChipAnalysis& res );
+
+    // Runs the rom headless with the given quirks and fills in the execution counts of the blocks
+    void Profile( int frames,
+                  int opcodes_per_frame,
+                  EightChipProfile profile,
+                  EightChipAnalysis& res );
+
+    // Block holding an address, nullptr if the address isn't code
+    const EightChipBlock* FindBlock( const EightChipAnalysis& analysis, WORD address );
+
+    // Is the address the first byte of an instruction, or any byte of one
+    bool IsInstruction( const EightChipAnalysis& analysis, WORD address );
+    bool IsCode( const EightChipAnalysis& analysis, WORD address );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
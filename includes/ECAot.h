@@ -0,0 +1,144 @@
+#ifndef _EIGHTCHIP_AOT_INCLUDED_
+#define _EIGHTCHIP_AOT_INCLUDED_
+
+#include <memory>
+#include <vector>
+
+#include "ECCpu.h"
+#include "ECEngine.h"
+#include "ECGlobals.h"
+#include "ECQuirks.h"
+#include "ECState.h"
+
+//-------------------------------------------------------------------------------------------------
+
+class EightChipAotRunner;
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * A basic block translated by eight_chip_aot (see. src/aot/ECAotTool.cpp). Runs the whole block
+ * and returns the instructions it ran, or 0 without touching anything when it can't: the budget
+ * is smaller than the block, or its code was changed since it was translated.
+ */
+typedef int ( *EightChipAotBlock )( EightChipAotRunner& aot, int budget );
+
+struct EightChipAotEntry
+{
+    WORD address;
+    EightChipAotBlock block;
+};
+
+// Everything eight_chip_aot generates for a rom
+struct EightChipAotProgram
+{
+    const char* name;
+    EightChipProfile profile;
+
+    // The rom the blocks were translated from, as loaded at 0x200
+    const BYTE* rom;
+    size_t size;
+
+    // Sorted by address
+    const EightChipAotEntry* blocks;
+    size_t count;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Runs a translated rom on a CPU: the block starting at the PC when there is one, the interpreter
+ * for one instruction otherwise. Code that wasn't found statically, or was written over since,
+ * is interpreted. Debuggers and tracers attached to the CPU don't see the translated blocks.
+ */
+class EightChipAotRunner
+{
+public:
+    EightChipAotRunner( const EightChipAotProgram& program, EightChipCPU& cpu );
+
+public:
+    // Resets the CPU with the rom and its profile
+    bool Load( );
+
+    // Executes exactly count instructions
+    void Run( int count );
+
+    // Instructions run by the blocks and by the interpreter since the runner was created
+    unsigned long long GetTranslated( ) const;
+    unsigned long long GetInterpreted( ) const;
+
+public:
+    // Called by the translated blocks
+    EightChipState& GetState( )
+    {
+        return m_State;
+    }
+
+    // Runs an instruction the block doesn't handle itself, the PC pointing past it
+    void Execute( WORD opcode )
+    {
+        m_CPU.ExecuteFetchedOpCode( opcode );
+    }
+
+    // Are the bytes [start, end) of the game memory still those of the rom
+    bool IsIntact( WORD start, WORD end ) const;
+
+    // Skips the instruction at the PC, which is 4 bytes long when it's F000 NNNN
+    void SkipNext( );
+
+private:
+    const EightChipAotProgram& m_Program;
+    EightChipCPU& m_CPU;
+    EightChipState& m_State;
+
+    // Block starting at each address, nullptr where there is none
+    std::vector< EightChipAotBlock > m_Blocks;
+
+    unsigned long long m_Translated;
+    unsigned long long m_Interpreted;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** A translated rom as an engine, to be checked against the interpreter (see. eclockstep). */
+class EightChipAotEngine : public EightChipEngine
+{
+public:
+    explicit EightChipAotEngine( const EightChipAotProgram& program );
+
+public:
+    const char* GetName( ) const override;
+
+    // Only the rom and the profile the program was translated from load
+    bool Load( const BYTE* rom, size_t size, EightChipProfile profile, unsigned int seed ) override;
+    void Run( int count ) override;
+    void DecreaseTimers( ) override;
+    void KeyDown( int key ) override;
+    void KeyUp( int key ) override;
+    const EightChipState& GetState( ) const override;
+    void SetState( const EightChipState& state ) override;
+
+    // The blocks only write registers, the instructions that write memory or the display are
+    // left to the CPU
+    void TakeWrites( QWORD pages[ MEMORY_PAGES / 64 ], int& planes ) override;
+
+private:
+    std::unique_ptr< EightChipCPU > m_CPU;
+    EightChipAotRunner m_Runner;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ecaot
+{
+    /**
+     * main( ) of the binaries eight_chip_aot generates:
+     *   NAME [--frames N] [--opcodes-per-frame N] [--seed N] [--verify]
+     * runs the rom headless and reports the speed and the last frame, --verify runs it in
+     * lockstep with the interpreter instead.
+     */
+    int Main( const EightChipAotProgram& program, int argc, char* argv[ ] );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -1,17 +1,25 @@
 #ifndef _EIGHTCHIP_APP_INCLUDED_
 #define _EIGHTCHIP_APP_INCLUDED_
 
+#include <memory>
+
+#include <SDL.h>
+
 #include "ECCpu.h"
 #include "ECGlobals.h"
+#include "ECLatency.h"
+#include "ECPresenter.h"
+#include "ECShared.h"
 
 //-------------------------------------------------------------------------------------------------
 
 namespace ecgfx
 {
-    void InitOpenGL( SDL_Window* window );
-    bool InitGraphics( SDL_Window* window );
+    // Picks the presenter from the settings, nullptr when its name is unknown
+    std::unique_ptr< EightChipPresenter > LoadPresenter( const SETTINGS_MAP& settings );
 
-    void DrawGraphics( EightChipCPU* cpu, SDL_Window* window );
+    // Creates the window when the presenter draws into one, window stays nullptr otherwise
+    bool InitGraphics( SDL_Window*& window, EightChipPresenter* presenter );
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -24,7 +32,13 @@ namespace ecemulate
 
     void SetupInput( EightChipCPU* cpu, SDL_Event event );
 
-    void EmulateCycle( EightChipCPU* cpu, const SETTINGS_MAP& settings, bool& status, SDL_Window* window );
+    SDL_AudioDeviceID InitAudio( );
+    void PlayAudio( EightChipCPU* cpu, SDL_AudioDeviceID device, short volume );
+
+    void EmulateCycle( EightChipCPU* cpu,
+                       const SETTINGS_MAP& settings,
+                       bool& status,
+                       EightChipPresenter* presenter );
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -64,8 +78,11 @@ private:
     // Map of settings for the emulator
     SETTINGS_MAP settings;
 
-    // Pointer to the SDL window
+    // Pointer to the SDL window, nullptr with the null presenter
     SDL_Window* main_window;
+
+    // Puts the frames in the window
+    std::unique_ptr< EightChipPresenter > presenter;
 };
 
 //-------------------------------------------------------------------------------------------------
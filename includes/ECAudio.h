@@ -0,0 +1,37 @@
+#ifndef _EIGHTCHIP_AUDIO_INCLUDED_
+#define _EIGHTCHIP_AUDIO_INCLUDED_
+
+#include "ECGlobals.h"
+
+//-------------------------------------------------------------------------------------------------
+/** Playback position inside the 128 bits audio pattern, carried from one buffer to the next.
+ * The whole 32 bits wrap around exactly at the end of the pattern: the top 7 bits are the bit
+ * being played and the 25 others the fraction of it already played.
+ */
+using AUDIO_PHASE = unsigned int;
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ecaudio
+{
+    // Bits of the pattern played per second at a pitch
+    double GetPlaybackRate( BYTE pitch );
+
+    // Resamples the pattern to sample_rate, -amplitude for 0 bits and +amplitude for 1 bits
+    void RenderPattern( const BYTE pattern[ AUDIO_PATTERN_SIZE ],
+                        BYTE pitch,
+                        int sample_rate,
+                        short amplitude,
+                        AUDIO_PHASE& phase,
+                        short* out,
+                        int count );
+
+    // Adds source into out with saturation, scaling it by volume (0 - 32767)
+    void Mix( const short* source, short volume, short* out, int count );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
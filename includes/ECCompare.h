@@ -0,0 +1,29 @@
+#ifndef _EIGHTCHIP_COMPARE_INCLUDED_
+#define _EIGHTCHIP_COMPARE_INCLUDED_
+
+//-------------------------------------------------------------------------------------------------
+// Comparison of a guest value against a constant, shared by the debugger's conditions and the
+// explorer's targets
+enum EightChipCompare
+{
+    COMPARE_EQUAL = 0,
+    COMPARE_NOT_EQUAL,
+    COMPARE_LESS,
+    COMPARE_LESS_EQUAL,
+    COMPARE_GREATER,
+    COMPARE_GREATER_EQUAL,
+};
+
+//-------------------------------------------------------------------------------------------------
+
+namespace eccompare
+{
+    // Whether value compare constant holds
+    bool Holds( int value, EightChipCompare compare, int constant );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,98 @@
+#ifndef _EIGHTCHIP_COVERAGE_INCLUDED_
+#define _EIGHTCHIP_COVERAGE_INCLUDED_
+
+#include <string>
+
+#include "ECGlobals.h"
+
+//-------------------------------------------------------------------------------------------------
+// Coverage file layout, bump the version whenever it changes
+static const unsigned int COVERAGE_MAGIC = 0x56434345;  // "ECCV"
+static const unsigned int COVERAGE_VERSION = 1;
+
+//-------------------------------------------------------------------------------------------------
+// What the guest did with each address of the game memory
+enum EightChipCoverageKind
+{
+    COVERAGE_EXECUTED = 0,  // An instruction was fetched from it
+    COVERAGE_READ,          // Read as data: sprites, FX65, XO-CHIP loads and audio patterns
+    COVERAGE_WRITTEN,       // Written by FX33, FX55 and the XO-CHIP stores
+    COVERAGE_KINDS,
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Header of a coverage file, followed by the bitmap of each EightChipCoverageKind in turn. */
+struct EightChipCoverageHeader
+{
+    unsigned int magic;
+    unsigned int version;
+
+    // Runs merged into the file
+    unsigned long long runs;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * One bit per address of the game memory and per EightChipCoverageKind, set by the coverage
+ * interpreter (see. EightChipCPU::SetCoverage). Marking an address is a single OR, so the
+ * coverage can be left on for batch runs and fuzzing. Bitmaps of several runs of a rom merge into
+ * what all of them covered.
+ */
+class EightChipCoverage
+{
+public:
+    EightChipCoverage( );
+
+public:
+    void Clear( );
+
+    // Adds what another run covered
+    void Merge( const EightChipCoverage& other );
+
+    // Writes the bitmaps to a file, or reads them back (see. EightChipCoverageHeader)
+    bool Save( const std::string& filename ) const;
+    bool Load( const std::string& filename );
+
+    // Merges into the file what it already holds, when it exists, then saves it
+    bool MergeInto( const std::string& filename ) const;
+
+    bool IsCovered( EightChipCoverageKind kind, WORD address ) const;
+
+    // Addresses covered in [start, end)
+    int Count( EightChipCoverageKind kind, int start = 0, int end = ROMSIZE ) const;
+
+    // Runs merged in, 1 for a bitmap filled by a single run
+    unsigned long long GetRuns( ) const;
+
+    // Hooks of the coverage interpreter
+    void OnInstruction( WORD address )
+    {
+        Mark( COVERAGE_EXECUTED, address );
+    }
+
+    void OnRead( WORD address )
+    {
+        Mark( COVERAGE_READ, address );
+    }
+
+    void OnWrite( WORD address )
+    {
+        Mark( COVERAGE_WRITTEN, address );
+    }
+
+private:
+    void Mark( EightChipCoverageKind kind, WORD address )
+    {
+        m_Bits[ kind ][ address / 64 ] |= 1ULL << ( address % 64 );
+    }
+
+private:
+    QWORD m_Bits[ COVERAGE_KINDS ][ ROMSIZE / 64 ];
+    unsigned long long m_Runs;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -1,73 +1,154 @@
 #ifndef _EIGHTCHIP_CPU_INCLUDED_
 #define _EIGHTCHIP_CPU_INCLUDED_
 
-#include <SDL.h>
-#include <SDL_opengl.h>
-
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <cstdlib>
 #include <cstring>
-#include <vector>
 
+#include "ECDisplay.h"
 #include "ECGlobals.h"
+#include "ECOpcodes.h"
+#include "ECQuirks.h"
+#include "ECState.h"
+
+//-------------------------------------------------------------------------------------------------
+/** Faults raised by the guest program.
+ * The CPU never touches memory outside of its own state when one of these occurs: the faulting
+ * stack access is dropped, memory addresses wrap around, and the flag is latched until
+ * ClearFaults( ) so the host can decide whether to stop, report or ignore it.
+ */
+enum EightChipFault
+{
+    FAULT_NONE = 0,
+    FAULT_STACK_UNDERFLOW = 1 << 0,  // 00EE with an empty stack
+    FAULT_STACK_OVERFLOW = 1 << 1,   // 2NNN with STACK_DEPTH return addresses already pushed
+    FAULT_MEMORY_BOUNDS = 1 << 2,    // PC, I+N or I+Vx outside of the game memory
+    FAULT_ILLEGAL_OPCODE = 1 << 3,   // Opcode that doesn't decode to any instruction
+};
+
+//-------------------------------------------------------------------------------------------------
+
+class EightChipCoverage;
+class EightChipDebugger;
+class EightChipRomImage;
+class EightChipSnapshot;
+class EightChipTracer;
 
 //-------------------------------------------------------------------------------------------------
 
-class EightChipCPU
+class EightChipCPU : protected EightChipState
 {
+    // Translated blocks work on the state directly (see. ecaot)
+    friend class EightChipAotRunner;
+
 private:
     static EightChipCPU* m_Instance;
 
-    /** 0xFFF bytes of memory.
-    *
-    * Memory Map:
-    * 0x000-0x1FF - Chip 8 interpreter (contains font set in emu)
-    * 0x050-0x0A0 - Used for the built in 4x5 pixel font set (0-F)
-    * 0x200-0xFFF - Program ROM and work RAM
-    */
-    BYTE m_GameMemory[ ROMSIZE ];
-
-    /** 16 registers, 8-bits (BYTE) each.
-    * called V0 to VF. VF doubles as the carry flag.
-    */
-    BYTE m_Registers[ 16 ];
-
-    /** Delay Timer active whenever register DT is non-zero.
-    * This timer subtracts 1 from DT at rate of 60Hz until 0 then deactivates.
-    */
-    BYTE m_DelayTimer;
-
-    /** Sound Timer active whenever register ST is non-zero.
-    * This timer subtracts 1 from ST at rate of 60Hz.
-    * Chip-8 will buzz as long as ST is greater than 0.
-    */
-    BYTE m_SoundTimer;
-    BYTE m_KeyState[ 16 ];
-
-    // 16-bits address register used to access memory
-    WORD m_AddressI;
-
-    // 16-bits program counter
-    WORD m_ProgramCounter;
-
-    /**
-    * 16-bits stack for return addresses to memory which is used for subroutine return calls.
-    * This is emulated thanks to the push back/pop.
-    */
-    std::vector< WORD > m_Stack;
+    // Interpreter instantiated for the quirks of the current profile and the hooks in use (see.
+    // SetProfile, SetDebugger, SetTracer)
+    typedef void ( EightChipCPU::*OPCODE_RUNNER )( int count );
+    static const OPCODE_RUNNER* const PROFILE_RUNNERS[ PROFILE_COUNT ];
 
-private:
-    EightChipCPU( );
+    EightChipProfile m_Profile;
+    OPCODE_RUNNER m_RunOpCodes;
+    OPCODE_RUNNER m_RunCycles;
+
+    // Handlers of the current profile (see. OPCODE_HANDLERS)
+    typedef void ( EightChipCPU::*OPCODE_HANDLER )( WORD opcode );
+    static const OPCODE_HANDLER* const PROFILE_HANDLERS[ PROFILE_COUNT ];
+
+    const OPCODE_HANDLER* m_Handlers;
+
+    // see. EightChipHooks
+    int m_Hooks;
+    EightChipDebugger* m_Debugger;
+    EightChipTracer* m_Tracer;
+    EightChipCoverage* m_Coverage;
+
+    // Image the memory was last reset to (see. IncrementalReset), and the pages written since,
+    // one bit each
+    std::shared_ptr< const EightChipRomImage > m_Image;
+    QWORD m_DirtyPages[ MEMORY_PAGES / 64 ];
+
+    // Pages and display planes written since the last TakeWrites( ), one bit each
+    QWORD m_WrittenPages[ MEMORY_PAGES / 64 ];
+    int m_WrittenPlanes;
 
 public:
+    EightChipCPU( );
     ~EightChipCPU( );
 
+    // The state is cache line aligned, which operator new only honours from C++17
+    static void* operator new( size_t size );
+    static void operator delete( void* ptr );
+
     // CPU instance
     static EightChipCPU* GetInstance( );
 
     bool InitRom( const std::string& rom_filename );
+    bool InitRom( const BYTE* rom, size_t size );
     void ExecuteNextOpCode( );
+    void ExecuteOpCodes( int count );
+
+    // Runs for that many COSMAC VIP machine cycles rather than instructions (see. ectiming). A
+    // DXYN then waits for the next DecreaseTimers( ), as the VIP waited for its display interrupt.
+    void ExecuteCycles( int cycles );
+
+    // Runs an instruction fetched by someone else, the PC already pointing past it. No hooks are
+    // called, the instruction isn't seen by a debugger or a tracer.
+    void ExecuteFetchedOpCode( WORD opcode );
+
+    // Resets the guest to a rom image, and takes its profile. The CPU keeps its own copy of the
+    // memory: when it was last reset to that same image only the pages written since are copied.
+    void IncrementalReset( const std::shared_ptr< const EightChipRomImage >& image );
+
+    // Variant the rom was written for, kept across InitRom( ) (see. ecquirks)
+    void SetProfile( EightChipProfile profile );
+    EightChipProfile GetProfile( ) const;
+
+    // Copies raw bytes into the game memory without resetting anything else.
+    bool PatchMemory( WORD address, const BYTE* data, size_t size );
+
+    // Runs the debug interpreter while a debugger is attached, nullptr detaches it. The
+    // debugger isn't owned and must outlive the attachment.
+    void SetDebugger( EightChipDebugger* debugger );
+    EightChipDebugger* GetDebugger( ) const;
+
+    // Records every instruction into the tracer while one is attached, nullptr detaches it. Works
+    // alongside a debugger, the tracer isn't owned either.
+    void SetTracer( EightChipTracer* tracer );
+    EightChipTracer* GetTracer( ) const;
+
+    // Marks the addresses executed, read and written while a coverage is attached, nullptr
+    // detaches it. Fused sequences are run one instruction at a time meanwhile, the coverage
+    // isn't owned.
+    void SetCoverage( EightChipCoverage* coverage );
+    EightChipCoverage* GetCoverage( ) const;
+
+    // Faults raised since the last ClearFaults( ) (see. EightChipFault)
+    int GetFaults( ) const;
+    void ClearFaults( );
+
+    // Seeds the random number generator used by CXKK.
+    void SetRandomSeed( unsigned int seed );
+
+    // Address of the next instruction to execute
+    WORD GetProgramCounter( ) const;
+
+    // SUPER-CHIP display mode and exit state
+    bool IsHighResolution( ) const;
+    bool IsHalted( ) const;
+
+    // Blocked in FX0A with no key down: only the timers change until a key is pressed
+    bool IsWaitingForKey( ) const;
+
+    // Sound: plays the audio pattern at the pitch while the sound timer is running
+    BYTE GetSoundTimer( ) const;
+    const BYTE* GetAudioPattern( ) const;
+    BYTE GetPitch( ) const;
 
     // Delay/Sound Timers decrements
     void DecreaseTimers( );
@@ -76,72 +157,189 @@ public:
     void KeyDown( int key );
     void KeyUp( int key );
 
-    // Screen (Height x Width x RGB).. OpenGL takes Width then Height.. Figures!
-    BYTE m_ScreenPixels[ WINDOW_HEIGHT ][ WINDOW_WIDTH ][ 3 ];
+    // Snapshots of the whole guest state, the profile isn't part of it
+    const EightChipState& GetState( ) const;
+    void SetState( const EightChipState& state );
+
+    // Compact snapshots of a CPU reset to a rom image since, see. EightChipSnapshot. Saving is
+    // refused when the state didn't come from an image, loading resets to the snapshot's.
+    bool SaveSnapshot( EightChipSnapshot& snapshot ) const;
+    void LoadSnapshot( const EightChipSnapshot& snapshot );
+
+    // Memory pages and display planes written since the previous call, one bit each, which are
+    // then forgotten. Replacing the whole state counts as writing all of them (see.
+    // EightChipStateHash).
+    void TakeWrites( QWORD pages[ MEMORY_PAGES / 64 ], int& planes );
+
+    // Screen at the native resolution (see. EightChipState)
+    using EightChipState::m_Display;
 
 private:
+    // Picks the interpreter for the profile and the hooks
+    void SelectRunner( );
+
     // Initialise CPU/Screen
     void CPUReset( );
     void ClearScreen( );
 
-    // Play a sound. Only one tone is played, frequency is predefined.
-    void PlayBeep( );
-
-    // OpCodes reading and execution
+    // OpCodes reading and execution, the quirks are resolved at compile time
     WORD GetNextOpCode( );
 
+    template < class QUIRKS >
+    void RunOpCodes( int count );
+
+    // Interpreters of a profile indexed by EightChipHooks
+    template < class QUIRKS >
+    static const OPCODE_RUNNER HOOKED_RUNNERS[ HOOKS_ALL + 1 ];
+
+    // Macro-op fusion: runs the instruction just fetched together with the ones after it when
+    // they make a known sequence, and returns how many ran, never more than budget
+    WORD PeekOpCode( WORD address ) const;
+
+    template < class QUIRKS >
+    int RunFused( WORD opcode, EightChipOpcodeId id, int budget );
+    int RunTimerWait( WORD opcode, int budget );
+    int RunCountingLoop( WORD opcode, int budget );
+
+    // Handlers indexed by EightChipOpcodeId (see. ecops::DECODE_TABLE)
+    template < class QUIRKS >
+    static const OPCODE_HANDLER OPCODE_HANDLERS[ OP_COUNT ];
+
+    void OpCodeIllegal( WORD opcode );
+
+    // The handler when the profile has the instruction, OpCodeIllegal otherwise
+    template < bool SUPPORTED >
+    static constexpr OPCODE_HANDLER Supported( OPCODE_HANDLER handler )
+    {
+        return SUPPORTED ? handler : &EightChipCPU::OpCodeIllegal;
+    }
+
+    template < void ( EightChipCPU::*HANDLER )( ) >
+    void OpCodeNoOperand( WORD opcode );
+
+    // Masked accesses to the game memory, addresses past the end wrap around and raise
+    // FAULT_MEMORY_BOUNDS.
+    BYTE ReadMemory( int address );
+    void WriteMemory( int address, BYTE value );
+
+    // Records the pages of [address, address + size) as written to
+    void MarkDirty( int address, size_t size );
+
+    // The whole memory and display were replaced
+    void MarkAllWritten( );
+
+    // Accesses made by instructions to their data, which the watchpoints see in the debug
+    // interpreter
+    template < class QUIRKS >
+    BYTE ReadData( int address );
+    template < class QUIRKS >
+    void WriteData( int address, BYTE value );
+
+    // Random byte for CXKK
+    BYTE NextRandom( );
+
+    // Skips the next instruction, which is 4 bytes long when it's F000 NNNN and the profile has it
+    template < class QUIRKS >
+    void SkipNextInstruction( );
+
+    // Draws a sprite onto one bit plane, for DXYN
+    template < class QUIRKS >
+    void DrawSprite( EightChipPlane& plane,
+                     int address,
+                     int spriteX,
+                     int spriteY,
+                     int spriteHeight,
+                     int spriteBytes );
+
     //
     int GetKeyPressed( );
 
-    // Clear screen and draw graphics. (DecodeOpCode0)
+    // Clear screen and draw graphics.
     void OpCode00E0( );
+    template < class QUIRKS >
     void OpCodeDXYN( WORD opcode );
 
-    // Skips an instruction if key is pressed or not. (DecodeOpCodeE)
+    // SUPER-CHIP scrolling, exit and display modes.
+    void OpCode00CN( WORD opcode );
+    void OpCode00FB( );
+    void OpCode00FC( );
+    void OpCode00FD( );
+    void OpCode00FE( );
+    void OpCode00FF( );
+
+    // XO-CHIP scrolling and register ranges
+    void OpCode00DN( WORD opcode );
+    template < class QUIRKS >
+    void OpCode5XY2( WORD opcode );
+    template < class QUIRKS >
+    void OpCode5XY3( WORD opcode );
+
+    // Skips an instruction if key is pressed or not.
+    template < class QUIRKS >
     void OpCodeEX9E( WORD opcode );
+    template < class QUIRKS >
     void OpCodeEXA1( WORD opcode );
 
-    // Operations involving both VX and VY registers. (DecodeOpCode8)
+    // Operations involving both VX and VY registers.
     void OpCode8XY0( WORD opcode );
+    template < class QUIRKS >
     void OpCode8XY1( WORD opcode );
+    template < class QUIRKS >
     void OpCode8XY2( WORD opcode );
+    template < class QUIRKS >
     void OpCode8XY3( WORD opcode );
     void OpCode8XY4( WORD opcode );
     void OpCode8XY5( WORD opcode );
+    template < class QUIRKS >
     void OpCode8XY6( WORD opcode );
     void OpCode8XY7( WORD opcode );
+    template < class QUIRKS >
     void OpCode8XYE( WORD opcode );
 
-    // Operations involving VX register. (DecodeOpCodeF)
+    // Operations involving VX register.
     void OpCodeFX07( WORD opcode );
     void OpCodeFX0A( WORD opcode );
     void OpCodeFX15( WORD opcode );
     void OpCodeFX18( WORD opcode );
     void OpCodeFX1E( WORD opcode );
     void OpCodeFX29( WORD opcode );
+    template < class QUIRKS >
     void OpCodeFX33( WORD opcode );
+    template < class QUIRKS >
     void OpCodeFX55( WORD opcode );
+    template < class QUIRKS >
     void OpCodeFX65( WORD opcode );
 
+    // SUPER-CHIP operations involving VX register.
+    void OpCodeFX30( WORD opcode );
+    void OpCodeFX75( WORD opcode );
+    void OpCodeFX85( WORD opcode );
+
+    // XO-CHIP long load, planes and audio.
+    void OpCodeF000( );
+    void OpCodeFN01( WORD opcode );
+    template < class QUIRKS >
+    void OpCodeF002( );
+    void OpCodeFX3A( WORD opcode );
+
     // Other operations
     void OpCode1KKK( WORD opcode );
     void OpCode2KKK( WORD opcode );
+    template < class QUIRKS >
     void OpCode3XKK( WORD opcode );
+    template < class QUIRKS >
     void OpCode4XKK( WORD opcode );
+    template < class QUIRKS >
     void OpCode5XY0( WORD opcode );
     void OpCode6XKK( WORD opcode );
     void OpCode7XKK( WORD opcode );
+    template < class QUIRKS >
     void OpCode9XY0( WORD opcode );
     void OpCodeANNN( WORD opcode );
+    template < class QUIRKS >
     void OpCodeBNNN( WORD opcode );
     void OpCodeCXKK( WORD opcode );
     void OpCode00EE( );
-
-    // Decode OpCodes
-    void DecodeOpCode0( WORD opcode );
-    void DecodeOpCode8( WORD opcode );
-    void DecodeOpCodeE( WORD opcode );
-    void DecodeOpCodeF( WORD opcode );
 };
 
 //-------------------------------------------------------------------------------------------------
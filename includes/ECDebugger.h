@@ -0,0 +1,172 @@
+#ifndef _EIGHTCHIP_DEBUGGER_INCLUDED_
+#define _EIGHTCHIP_DEBUGGER_INCLUDED_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ECCompare.h"
+#include "ECCpu.h"
+#include "ECGlobals.h"
+#include "ECState.h"
+
+//-------------------------------------------------------------------------------------------------
+// Why the debugger stopped the CPU
+enum EightChipBreakReason
+{
+    BREAK_NONE = 0,
+    BREAK_PAUSE,      // Pause( ) from the host
+    BREAK_STEP,       // Step( ) or StepOver( ) done
+    BREAK_POINT,      // The PC reached a breakpoint
+    BREAK_READ,       // An instruction read a watched address
+    BREAK_WRITE,      // An instruction wrote a watched address
+    BREAK_CONDITION,  // A register condition became true
+    BREAK_FAULT,      // The CPU raised a new fault (see. EightChipFault)
+};
+
+//-------------------------------------------------------------------------------------------------
+// Accesses a watchpoint stops on
+enum EightChipWatchAccess
+{
+    WATCHPOINT_READ = 1 << 0,
+    WATCHPOINT_WRITE = 1 << 1,
+};
+
+//-------------------------------------------------------------------------------------------------
+// Register a condition looks at, 0x0-0xF being V0-VF
+static const int CONDITION_REGISTER_I = 16;
+
+//-------------------------------------------------------------------------------------------------
+/** Stops the CPU when reg compare value goes from false to true, so that it doesn't stop again
+ * on every instruction while it stays true.
+ */
+struct EightChipCondition
+{
+    int reg;
+    EightChipCompare compare;
+    int value;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Breakpoints, watchpoints, register conditions and stepping.
+ *
+ * Attached with EightChipCPU::SetDebugger( ), which swaps in the debug interpreter: the plain
+ * one is left as it is and costs nothing more. The CPU asks OnInstruction( ) before each
+ * instruction and reports the data accesses of instructions through OnRead( )/OnWrite( ).
+ * Once stopped, ExecuteOpCodes( ) returns right away and executes nothing until Continue( ),
+ * Step( ) or StepOver( ).
+ */
+class EightChipDebugger
+{
+public:
+    EightChipDebugger( );
+
+public:
+    void AddBreakpoint( WORD address );
+    void RemoveBreakpoint( WORD address );
+
+    // access is a combination of EightChipWatchAccess, 0 removes the watchpoint
+    void SetWatchpoint( WORD address, int access );
+
+    // Returns the index RemoveCondition( ) takes
+    int AddCondition( const EightChipCondition& condition );
+    void RemoveCondition( int index );
+    const std::vector< EightChipCondition >& GetConditions( ) const;
+
+    // Removes the breakpoints, watchpoints and conditions
+    void ClearAll( );
+
+    // Stops before the next instruction
+    void Pause( );
+
+    // Runs on until something breaks
+    void Continue( );
+
+    // Executes one instruction, StepOver( ) runs a whole subroutine when it's a call
+    void Step( );
+    void StepOver( );
+
+    bool IsStopped( ) const;
+    EightChipBreakReason GetReason( ) const;
+
+    // PC it stopped at, or the watched address for BREAK_READ/BREAK_WRITE
+    WORD GetAddress( ) const;
+
+    // Hooks of the debug interpreter. OnInstruction( ) returns true when the instruction at the
+    // PC mustn't run.
+    bool OnInstruction( const EightChipState& state );
+    void OnRead( WORD address );
+    void OnWrite( WORD address );
+
+private:
+    void Stop( EightChipBreakReason reason, WORD address );
+    bool Evaluate( const EightChipCondition& condition, const EightChipState& state ) const;
+
+private:
+    enum Mode
+    {
+        MODE_RUN = 0,
+        MODE_PAUSE,      // Stops on the next instruction whatever it is
+        MODE_STEP,
+        MODE_STEP_OVER,  // Decides between a step and running a call on the next instruction
+        MODE_RUN_CALL,   // Runs until the call returns to m_ReturnAddress
+    };
+
+    // One entry per address of the game memory
+    std::vector< BYTE > m_Breakpoints;
+    std::vector< BYTE > m_Watchpoints;
+
+    std::vector< EightChipCondition > m_Conditions;
+    std::vector< BYTE > m_ConditionsHeld;
+
+    Mode m_Mode;
+    bool m_Stopped;
+    EightChipBreakReason m_Reason;
+    WORD m_Address;
+
+    // The instruction resumed from runs even with a breakpoint on it
+    bool m_Resuming;
+
+    WORD m_ReturnAddress;
+    BYTE m_ReturnDepth;
+
+    // Faults already reported
+    int m_Faults;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ecdebug
+{
+    // One line on why and where the CPU stopped
+    std::string DescribeStop( const EightChipDebugger& debugger );
+
+    // Registers, timers and the instruction at the PC
+    void PrintRegisters( const EightChipCPU& cpu, std::ostream& out );
+
+    /**
+     * Runs one console command, returns false on quit.
+     *
+     * b ADDR / bd ADDR           add / remove a breakpoint
+     * w ADDR [r|w|rw] / wd ADDR  add / remove a watchpoint, rw by default
+     * cond REG OP VALUE / condd N
+     *                            add / remove a condition, REG being V0-VF or I and OP one of
+     *                            == != < >
+     * c, s, n                    continue, step, step over
+     * r                          registers
+     * x ADDR [N]                 dumps N bytes of memory, 16 by default
+     * l [ADDR]                   disassembles 8 instructions from ADDR, the PC by default
+     * q                          quit
+     */
+    bool RunCommand( EightChipDebugger& debugger,
+                     const EightChipCPU& cpu,
+                     const std::string& line,
+                     std::ostream& out );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
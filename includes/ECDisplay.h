@@ -0,0 +1,71 @@
+#ifndef _EIGHTCHIP_DISPLAY_INCLUDED_
+#define _EIGHTCHIP_DISPLAY_INCLUDED_
+
+#include <cstddef>
+
+#include "ECGlobals.h"
+
+//-------------------------------------------------------------------------------------------------
+/** A 128x64 bit plane, one bit per pixel.
+ * Row y is rows[y][0] (pixels 0-63) followed by rows[y][1] (pixels 64-127), the leftmost pixel of
+ * each half being its most significant bit. A whole row fits a 128-bit register, so scrolling a
+ * row sideways is a couple of shifts.
+ */
+struct EightChipPlane
+{
+    alignas( 16 ) QWORD rows[ DISPLAY_HEIGHT ][ 2 ];
+};
+
+//-------------------------------------------------------------------------------------------------
+/** RGBA pixel of each plane combination, the bytes of a pixel being R, G, B, A in memory. */
+struct EightChipPalette
+{
+    alignas( 64 ) DWORD colours[ 1 << DISPLAY_PLANES ];
+};
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ecdisplay
+{
+    void Clear( EightChipPlane& plane );
+
+    // Scrolls the content, pixels scrolled in are cleared
+    void ScrollDown( EightChipPlane& plane, int rows );
+    void ScrollUp( EightChipPlane& plane, int rows );
+    void ScrollLeft( EightChipPlane& plane, int pixels );
+    void ScrollRight( EightChipPlane& plane, int pixels );
+
+    // XORs up to 64 pixels, left aligned in bits, onto row y starting at x. With WRAP the pixels
+    // past the right and bottom edges wrap around, otherwise they're clipped.
+    // Returns true if a lit pixel was turned off.
+    template < bool WRAP >
+    bool XorRow( EightChipPlane& plane, int y, int x, QWORD bits );
+
+    bool GetPixel( const EightChipPlane& plane, int x, int y );
+
+    // Colour index of a pixel, plane n giving bit n
+    int GetColour( const EightChipPlane planes[ DISPLAY_PLANES ], int x, int y );
+
+    // 64-bits hash of every plane, to tell two frames apart
+    QWORD Hash( const EightChipPlane planes[ DISPLAY_PLANES ] );
+
+    // Two colours: any lit pixel takes the foreground, whichever planes it's lit on
+    EightChipPalette MakePalette( const BYTE background[ 3 ], const BYTE foreground[ 3 ] );
+
+    // One RGB colour per plane combination
+    EightChipPalette MakePalette( const BYTE colours[ 1 << DISPLAY_PLANES ][ 3 ] );
+
+    // Writes the display as RGBA pixels, each pixel a scale x scale block: DISPLAY_HEIGHT * scale
+    // rows of DISPLAY_WIDTH * scale pixels, the rows being pitch bytes apart
+    void Expand( const EightChipPlane planes[ DISPLAY_PLANES ],
+                 const EightChipPalette& palette,
+                 int scale,
+                 BYTE* pixels,
+                 size_t pitch );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
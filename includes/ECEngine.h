@@ -0,0 +1,101 @@
+#ifndef _EIGHTCHIP_ENGINE_INCLUDED_
+#define _EIGHTCHIP_ENGINE_INCLUDED_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ECCpu.h"
+#include "ECDebugger.h"
+#include "ECGlobals.h"
+#include "ECQuirks.h"
+#include "ECState.h"
+#include "ECTrace.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * A way of executing roms, to be checked against the others (see. eclockstep::Run).
+ * Every engine has to leave the guest in the same state after the same number of instructions,
+ * however it gets there.
+ */
+class EightChipEngine
+{
+public:
+    virtual ~EightChipEngine( )
+    {
+    }
+
+public:
+    virtual const char* GetName( ) const = 0;
+
+    // Resets the guest and loads the rom at 0x200, a seed of 0 keeps the default one
+    virtual bool Load( const BYTE* rom,
+                       size_t size,
+                       EightChipProfile profile,
+                       unsigned int seed ) = 0;
+
+    // Executes exactly count instructions
+    virtual void Run( int count ) = 0;
+
+    virtual void DecreaseTimers( ) = 0;
+    virtual void KeyDown( int key ) = 0;
+    virtual void KeyUp( int key ) = 0;
+
+    virtual const EightChipState& GetState( ) const = 0;
+    virtual void SetState( const EightChipState& state ) = 0;
+
+    // Memory pages and display planes written since the previous call (see.
+    // EightChipCPU::TakeWrites)
+    virtual void TakeWrites( QWORD pages[ MEMORY_PAGES / 64 ], int& planes ) = 0;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The interpreter, run in one of the ways the emulator and the tools run it. */
+class EightChipInterpreterEngine : public EightChipEngine
+{
+public:
+    enum Mode
+    {
+        MODE_BATCH = 0,  // ExecuteOpCodes( ), the way frames are run
+        MODE_STEP,       // ExecuteNextOpCode( ) for each instruction
+        MODE_DEBUG,      // With a debugger attached and nothing to break on
+        MODE_TRACE,      // With a tracer attached
+    };
+
+    explicit EightChipInterpreterEngine( Mode mode );
+
+public:
+    const char* GetName( ) const override;
+    bool Load( const BYTE* rom, size_t size, EightChipProfile profile, unsigned int seed ) override;
+    void Run( int count ) override;
+    void DecreaseTimers( ) override;
+    void KeyDown( int key ) override;
+    void KeyUp( int key ) override;
+    const EightChipState& GetState( ) const override;
+    void SetState( const EightChipState& state ) override;
+    void TakeWrites( QWORD pages[ MEMORY_PAGES / 64 ], int& planes ) override;
+
+private:
+    Mode m_Mode;
+
+    std::unique_ptr< EightChipCPU > m_CPU;
+    EightChipDebugger m_Debugger;
+    std::unique_ptr< EightChipTracer > m_Tracer;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ecengine
+{
+    // Names CreateEngine( ) knows
+    std::vector< std::string > GetNames( );
+
+    // "interpreter", "step", "debug" or "trace", nullptr for anything else
+    std::unique_ptr< EightChipEngine > CreateEngine( const std::string& name );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
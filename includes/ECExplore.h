@@ -0,0 +1,135 @@
+#ifndef _EIGHTCHIP_EXPLORE_INCLUDED_
+#define _EIGHTCHIP_EXPLORE_INCLUDED_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ECCompare.h"
+#include "ECGlobals.h"
+#include "ECRomImage.h"
+#include "ECSnapshot.h"
+
+//-------------------------------------------------------------------------------------------------
+enum EightChipTargetKind
+{
+    TARGET_MEMORY = 0,  // 1 or 2 bytes of the game memory, most significant byte first
+    TARGET_REGISTER,    // A register VX, address being X
+};
+
+//-------------------------------------------------------------------------------------------------
+/** A condition on the guest state, typically a score, a level or a number of lives. */
+struct EightChipExploreTarget
+{
+    EightChipTargetKind kind = TARGET_MEMORY;
+    WORD address = 0;
+    int size = 1;
+
+    EightChipCompare compare = COMPARE_EQUAL;
+    int value = 0;
+};
+
+//-------------------------------------------------------------------------------------------------
+struct EightChipExploreConfig
+{
+    // Worker threads expanding the frontier, 0 for one per core
+    int threads = 0;
+
+    int opcodesPerFrame = 10;
+
+    // Frames run with no key down before the first decision, then frames each decision holds
+    // its keys for
+    int startFrames = 0;
+    int framesPerDecision = 10;
+
+    // Decisions taken at most, and distinct states kept at most
+    int depth = 20;
+    size_t maxStates = 1000000;
+
+    // Keys held down by each choice of a decision, bit k for key k. Empty for no key and each
+    // of the 16 keys alone.
+    std::vector< WORD > choices;
+
+    // All of them must hold, checked after every frame. None explores the whole space.
+    std::vector< EightChipExploreTarget > targets;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** How one depth of the search went. */
+struct EightChipExploreLevel
+{
+    int depth = 0;
+
+    // States expanded, states they led to, how many of those were seen before, and how many
+    // were kept for the next depth
+    size_t frontier = 0;
+    size_t children = 0;
+    size_t duplicates = 0;
+    size_t states = 0;
+
+    // Memory held by the snapshots of the level's new states
+    size_t bytes = 0;
+
+    double milliseconds = 0.0;
+};
+
+//-------------------------------------------------------------------------------------------------
+struct EightChipExploreResult
+{
+    bool reached = false;
+
+    // Keys held at each decision from the start to the target, and the frames it took, the
+    // start frames included
+    std::vector< WORD > path;
+    int frames = 0;
+
+    // State the target was reached in
+    EightChipSnapshot snapshot;
+
+    // Distinct states seen, the start state included
+    size_t states = 0;
+
+    // "target", "exhausted" when no new state is left, "depth" or "states" when a limit is hit
+    const char* stop = "exhausted";
+
+    std::vector< EightChipExploreLevel > levels;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Breadth first search of the states a rom can reach through its input.
+ *
+ * From the start state every choice is taken in turn, each held for the frames of a decision, and
+ * every state reached that wasn't seen before is expanded the same way at the next depth. States
+ * are told apart by the hash of their snapshot (see. EightChipSnapshot): two paths leading to the
+ * same memory, registers and screen are explored once. The frontier of a depth is split between
+ * the workers, each stepping its own CPU from snapshot to snapshot.
+ *
+ * The result doesn't depend on the number of threads: the states new to a depth are kept in the
+ * order of their parents and choices, so the first path found is the one with the fewest
+ * decisions and, among those, the earliest choices.
+ */
+namespace ecexplore
+{
+    // False when the image can't run, a target reached right away has an empty path
+    bool Explore( const std::shared_ptr< const EightChipRomImage >& image,
+                  unsigned int seed,
+                  const EightChipExploreConfig& config,
+                  EightChipExploreResult& result );
+
+    // Keys of each choice the config stands for, its own or no key and each key alone
+    std::vector< WORD > GetChoices( const EightChipExploreConfig& config );
+
+    bool IsReached( const EightChipState& state,
+                    const std::vector< EightChipExploreTarget >& targets );
+
+    // Reads "ADDR[:SIZE]OP VALUE" or "VX OP VALUE", OP being one of = != < <= > >=, as in
+    // "0x2F0:2>=100" or "V3=0"
+    bool ParseTarget( const std::string& text, EightChipExploreTarget& target );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -2,15 +2,46 @@
 #define _EIGHTCHIP_GLOBALS_INCLUDED_
 
 #include <map>
+#include <string>
 
 //-------------------------------------------------------------------------------------------------
 // We need variables of sizes 8-bits / 16-bits (word) which are given by the following typedefs
 using BYTE = unsigned char;       // 1 byte  (0 - 255)
 using WORD = unsigned short int;  // 2 bytes (0 - 65535)
+using DWORD = unsigned int;        // 4 bytes, an RGBA pixel
+using QWORD = unsigned long long; // 8 bytes, a display row is made of two
 
 //-------------------------------------------------------------------------------------------------
-// Memory of 0xFFF bytes.
-static const int ROMSIZE = 0xFFF;
+// Memory of 64KB, the whole XO-CHIP address space.
+static const int ROMSIZE = 0x10000;
+
+// Pages the memory is tracked in, an incremental reset only copies those written to (see.
+// EightChipRomImage)
+static const int MEMORY_PAGE_SIZE = 0x100;
+static const int MEMORY_PAGES = ROMSIZE / MEMORY_PAGE_SIZE;
+
+//-------------------------------------------------------------------------------------------------
+// Subroutine nesting supported by the stack
+static const int STACK_DEPTH = 16;
+
+//-------------------------------------------------------------------------------------------------
+// Native display resolution, the SUPER-CHIP high resolution mode.
+// In low resolution (64x32) every pixel covers 2x2 display pixels.
+static const int DISPLAY_WIDTH = 128;
+static const int DISPLAY_HEIGHT = 64;
+
+// XO-CHIP bit planes, composited into 16 colours
+static const int DISPLAY_PLANES = 4;
+
+//-------------------------------------------------------------------------------------------------
+// Fonts: 4x5 digits (FX29) then SUPER-CHIP 8x10 digits (FX30)
+static const int FONT_ADDRESS = 0x000;
+static const int BIG_FONT_ADDRESS = 0x050;
+
+//-------------------------------------------------------------------------------------------------
+// XO-CHIP audio: a 128 bits pattern played at 4000 * 2 ^ ( ( pitch - 64 ) / 48 ) bits per second
+static const int AUDIO_PATTERN_SIZE = 16;
+static const int AUDIO_DEFAULT_PITCH = 64;
 
 //-------------------------------------------------------------------------------------------------
 // Settings map
@@ -20,8 +51,47 @@ using SETTINGS_MAP = std::map< std::string, std::string >;
 // Rom name shouldn't be hard coded...
 static const std::string ROM_NAME = "RomFile";
 
+// Quirk profile of the rom, guessed from its extension when missing (see. ecquirks)
+static const std::string ROM_PROFILE = "Profile";
+
+// Name of the shared memory segment the frames are exported to, no export when missing
+static const std::string SHARED_MEMORY = "SharedMemory";
+
+// Prints an input to present latency histogram on exit when set to 1
+static const std::string LATENCY_REPORT = "LatencyReport";
+
+// Number of slices a frame's opcodes are split in, input is sampled before and the screen
+// presented after each of them
+static const std::string INPUT_SLICES = "InputSlices";
+
+// Backend putting the frames on screen: null, renderer (the default) or opengl
+static const std::string PRESENTER = "Presenter";
+
+// How the display is scaled to the window: fit (the default) or integer multiples only
+static const std::string SCALING = "Scaling";
+
+// Share of the previous frame kept where pixels went dark, from 0 (none) to 1, against flicker
+static const std::string PERSISTENCE = "Persistence";
+
+// Attaches the debugger when set to 1: F5 pauses, commands are then read from the console
+static const std::string DEBUGGER = "Debugger";
+
+// Traces every instruction into a ring, written to that file on a fault, on F9 and on exit
+static const std::string TRACE_FILE = "Trace";
+
+// How long instructions take: flat (the default, OpcodesPerSecond of them whatever they are) or
+// vip, the cycles each took on the COSMAC VIP, DXYN waiting for the next frame (see. ectiming)
+static const std::string TIMING = "Timing";
+
+// Sound volume, from 0 (silent) to 100 (the default)
+static const std::string VOLUME = "Volume";
+
+// Frames the screen is run ahead of the emulation, from 0 (the default) to 8 (see.
+// EightChipRunAhead)
+static const std::string RUN_AHEAD = "RunAhead";
+
 //-------------------------------------------------------------------------------------------------
-// Window properties
+// Window properties, the size is the one the window opens with before any resize
 static const char* WINDOW_CAPTION = "EightChip Emulator";
 static const int WINDOW_HEIGHT = 640;
 static const int WINDOW_WIDTH = 1280;
@@ -39,6 +109,13 @@ static const int WINDOW_WIDTH = 1280;
 #define ERR07 "Error opening settings file."
 #define ERR08 "Malformed settings file."
 #define ERR09 "No settings found in settings file."
+#define ERR10 "Error opening the audio device, sound is disabled."
+#define ERR11 "Unknown Profile in settings file, expected eightchip, chip8, schip or xochip."
+#define ERR12 "Error creating the shared memory segment, frames are not exported."
+#define ERR13 "Unknown Presenter in settings file, expected null, renderer or opengl."
+#define ERR14 "Error initialising the presenter"
+#define ERR15 "Error writing the trace file."
+#define ERR16 "Unknown Timing in settings file, expected flat or vip."
 
 //-------------------------------------------------------------------------------------------------
 
@@ -0,0 +1,168 @@
+#ifndef _EIGHTCHIP_HOST_INCLUDED_
+#define _EIGHTCHIP_HOST_INCLUDED_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ECCpu.h"
+#include "ECGlobals.h"
+#include "ECRomImage.h"
+#include "ECShared.h"
+
+//-------------------------------------------------------------------------------------------------
+struct EightChipHostConfig
+{
+    // Worker threads running the sessions, 0 for one per core
+    int threads = 0;
+
+    // Instructions each session runs per frame, and frames per second
+    int opcodesPerFrame = 1000;
+    int frameRate = 60;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** What the workers did since the host started, summed over all of them. */
+struct EightChipHostStats
+{
+    // Frames run, and frames skipped because the session was parked
+    unsigned long long frames = 0;
+    unsigned long long parked = 0;
+
+    // Frames that started more than a frame period after their deadline
+    unsigned long long missed = 0;
+
+    // Frames a worker took from another worker's queue
+    unsigned long long steals = 0;
+
+    // How late frames started after their deadline
+    double meanLateness = 0.0;
+    double maxLateness = 0.0;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Serves many interactive sessions from a small pool of worker threads.
+ *
+ * Each session is a CPU reset to a shared rom image, with a deadline every frame period. A
+ * worker runs one frame of a session at a time, the earliest due in its own queue, or in another
+ * worker's queue when none of its own is due and that one is half a period late: the sessions of
+ * a worker falling behind are picked up by an idle one, and stay with it. A session that can't
+ * change until a key is pressed is parked: it halted, or waits in FX0A with no key down and its
+ * timers stopped. Its frames then cost nothing until input comes.
+ *
+ * Input comes from SetKeys( ), or from the session's shared memory segment, where its frames are
+ * published as the emulator does (see. EightChipSharedMemory).
+ */
+class EightChipHost
+{
+public:
+    explicit EightChipHost( const EightChipHostConfig& config );
+    ~EightChipHost( );
+
+public:
+    // Starts and stops the workers, sessions can be opened and closed either way
+    void Start( );
+    void Stop( );
+
+    // Opens a session on the image, publishing into the shared memory segment of that name when
+    // given. Returns the session's id, or -1 when the segment can't be created.
+    int OpenSession( const std::shared_ptr< const EightChipRomImage >& image,
+                     unsigned int seed,
+                     const std::string& shared_name );
+    void CloseSession( int session );
+
+    // Keys held down by the session's user, bit k for key k
+    void SetKeys( int session, WORD keys );
+
+    int GetSessions( ) const;
+    int GetThreads( ) const;
+
+    EightChipHostStats GetStats( ) const;
+
+private:
+    typedef std::chrono::steady_clock CLOCK;
+
+    struct Session
+    {
+        int id;
+        std::unique_ptr< EightChipCPU > cpu;
+        EightChipSharedMemory shared;
+
+        CLOCK::time_point deadline;
+
+        // Keys set by SetKeys( ), applied by the worker before the next frame
+        std::atomic< unsigned int > keys;
+        unsigned int applied;
+
+        std::atomic< bool > closing;
+    };
+
+    // Sessions of a worker, a heap on the earliest deadline
+    struct Queue
+    {
+        std::mutex mutex;
+        std::vector< Session* > sessions;
+    };
+
+    // Written by a single worker, read by GetStats( )
+    struct Counters
+    {
+        std::atomic< unsigned long long > frames;
+        std::atomic< unsigned long long > parked;
+        std::atomic< unsigned long long > missed;
+        std::atomic< unsigned long long > steals;
+        std::atomic< unsigned long long > latenessSum;
+        std::atomic< unsigned long long > latenessMax;
+    };
+
+private:
+    void WorkerLoop( int worker );
+
+    // Takes a due session from the worker's own queue, or a session half a period late from
+    // another worker's when none of its own is due, nullptr when none is. next is set to the
+    // earliest time one of them is.
+    Session* TakeSession( int worker, CLOCK::time_point now, CLOCK::time_point& next );
+
+    void Push( int worker, Session* session );
+    void RunFrame( int worker, Session* session );
+    void Release( Session* session );
+
+    // Orders the queues' heaps, the earliest deadline on top
+    static bool IsLater( const Session* first, const Session* second );
+
+    // Nothing changes in the session until a key is pressed
+    static bool IsParked( const EightChipCPU& cpu );
+
+private:
+    EightChipHostConfig m_Config;
+    CLOCK::duration m_Period;
+
+    std::vector< std::unique_ptr< Queue > > m_Queues;
+    std::vector< std::unique_ptr< Counters > > m_Counters;
+
+    // Open sessions by id, guarded by m_Mutex
+    mutable std::mutex m_Mutex;
+    std::map< int, Session* > m_Sessions;
+    int m_NextId;
+    int m_NextQueue;
+
+    // Idle workers sleep until the earliest deadline, or until m_Generation changes: a session
+    // was opened or the host is stopping
+    std::condition_variable m_Wake;
+    std::vector< std::thread > m_Workers;
+    std::atomic< unsigned int > m_Generation;
+    std::atomic< bool > m_Stopping;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,73 @@
+#ifndef _EIGHTCHIP_LATENCY_INCLUDED_
+#define _EIGHTCHIP_LATENCY_INCLUDED_
+
+#include <string>
+#include <vector>
+
+#include "ECGlobals.h"
+
+//-------------------------------------------------------------------------------------------------
+// Latencies are counted in buckets of LATENCY_BUCKET_US, the last bucket takes everything above
+static const int LATENCY_BUCKET_US = 1000;
+static const int LATENCY_BUCKETS = 64;
+
+//-------------------------------------------------------------------------------------------------
+class EightChipLatencyHistogram
+{
+public:
+    EightChipLatencyHistogram( );
+
+public:
+    void Record( unsigned long long microseconds );
+
+    unsigned int GetCount( ) const;
+
+    // Upper bound of the bucket holding the given percentile (0-100), in microseconds
+    unsigned long long GetPercentile( double percentile ) const;
+
+    // Percentiles, mean, max, and one line per non empty bucket
+    std::string Report( ) const;
+
+private:
+    unsigned int m_Buckets[ LATENCY_BUCKETS ];
+    unsigned int m_Count;
+    unsigned long long m_Total;
+    unsigned long long m_Max;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Follows input events to the first present that can show their effect: an input is only in
+ * the machine once an instruction slice ran after it, and only visible once the screen drawn
+ * after that slice is presented. Times are in microseconds on any monotonic clock.
+ */
+class EightChipLatencyTracker
+{
+public:
+    EightChipLatencyTracker( );
+
+public:
+    // An input event reached the emulator
+    void OnInput( unsigned long long time );
+
+    // The CPU ran an instruction slice, the inputs received so far were seen by it
+    void OnSlice( );
+
+    // A frame was presented
+    void OnPresent( unsigned long long time );
+
+    const EightChipLatencyHistogram& GetHistogram( ) const;
+
+private:
+    EightChipLatencyHistogram m_Histogram;
+
+    // Inputs the CPU hasn't run with yet, and inputs waiting to be presented
+    std::vector< unsigned long long > m_Pending;
+    std::vector< unsigned long long > m_Executed;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
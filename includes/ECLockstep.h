@@ -0,0 +1,110 @@
+#ifndef _EIGHTCHIP_LOCKSTEP_INCLUDED_
+#define _EIGHTCHIP_LOCKSTEP_INCLUDED_
+
+#include <string>
+#include <vector>
+
+#include "ECEngine.h"
+#include "ECGlobals.h"
+#include "ECState.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Hash of a whole guest state, kept up to date from one instruction to the next.
+ *
+ * The registers, timers and the rest of the small fields are hashed again on every Update( ).
+ * The memory and the display are hashed by 64 bytes lines summed together. Only the memory pages
+ * and display planes the engine wrote since the previous update are looked at, and of those only
+ * the lines that differ from the copy kept of them are hashed again, their old hash being taken
+ * out of the sum. Padding bytes of the state are never looked at.
+ */
+class EightChipStateHash
+{
+public:
+    EightChipStateHash( );
+
+public:
+    // Hashes the whole state
+    void Reset( const EightChipState& state );
+
+    // Brings the hash up to date with the state, which has moved on since the previous call
+    // writing only the memory pages and display planes given (see. EightChipEngine::TakeWrites)
+    QWORD Update( const EightChipState& state, const QWORD pages[ MEMORY_PAGES / 64 ], int planes );
+
+    QWORD GetValue( ) const;
+
+private:
+    void UpdateLines( const BYTE* data, size_t size, size_t offset );
+
+private:
+    // Memory then display, as last hashed
+    std::vector< BYTE > m_Shadow;
+
+    QWORD m_Lines;
+    QWORD m_Value;
+};
+
+//-------------------------------------------------------------------------------------------------
+// Key pressed or released at the start of a frame
+struct EightChipKeyEvent
+{
+    int frame;
+    BYTE key;
+    bool down;
+};
+
+//-------------------------------------------------------------------------------------------------
+struct EightChipLockstepConfig
+{
+    EightChipProfile profile = PROFILE_EIGHTCHIP;
+    unsigned int seed = 0;
+
+    int frames = 600;
+    int opcodesPerFrame = 10;
+
+    // Instructions the engines run between two comparisons. Once the hashes differ, both engines
+    // go back to the last state they agreed on and are compared after every instruction.
+    int block = 1;
+
+    // Sorted by frame
+    std::vector< EightChipKeyEvent > input;
+};
+
+//-------------------------------------------------------------------------------------------------
+struct EightChipLockstepResult
+{
+    bool diverged = false;
+
+    // Instructions both engines executed alike, the first divergent one is the next
+    unsigned long long instructions = 0;
+
+    // Address of the divergent instruction and what it left different
+    WORD programCounter = 0;
+    std::string diff;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+namespace eclockstep
+{
+    // Runs both engines side by side on the rom and the input, until they part or run out of
+    // frames. False if an engine can't load the rom.
+    bool Run( EightChipEngine& first,
+              EightChipEngine& second,
+              const BYTE* rom,
+              size_t size,
+              const EightChipLockstepConfig& config,
+              EightChipLockstepResult& result );
+
+    // Every field that differs between the two states, one per line
+    std::string DiffStates( const EightChipState& first, const EightChipState& second );
+
+    // Random key presses and releases over the frames, the same for the same seed
+    std::vector< EightChipKeyEvent > RandomInput( unsigned int seed, int frames );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
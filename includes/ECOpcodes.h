@@ -0,0 +1,137 @@
+#ifndef _EIGHTCHIP_OPCODES_INCLUDED_
+#define _EIGHTCHIP_OPCODES_INCLUDED_
+
+#include <string>
+
+#include "ECGlobals.h"
+#include "ECQuirks.h"
+
+//-------------------------------------------------------------------------------------------------
+// Every instruction the CPU decodes, in the order of the OpCode handlers of EightChipCPU
+enum EightChipOpcodeId
+{
+    OP_INVALID = 0,
+    OP_00E0,
+    OP_00EE,
+    OP_1NNN,
+    OP_2NNN,
+    OP_3XKK,
+    OP_4XKK,
+    OP_5XY0,
+    OP_6XKK,
+    OP_7XKK,
+    OP_8XY0,
+    OP_8XY1,
+    OP_8XY2,
+    OP_8XY3,
+    OP_8XY4,
+    OP_8XY5,
+    OP_8XY6,
+    OP_8XY7,
+    OP_8XYE,
+    OP_9XY0,
+    OP_ANNN,
+    OP_BNNN,
+    OP_CXKK,
+    OP_DXYN,
+    OP_EX9E,
+    OP_EXA1,
+    OP_FX07,
+    OP_FX0A,
+    OP_FX15,
+    OP_FX18,
+    OP_FX1E,
+    OP_FX29,
+    OP_FX33,
+    OP_FX55,
+    OP_FX65,
+
+    // SUPER-CHIP
+    OP_00CN,
+    OP_00FB,
+    OP_00FC,
+    OP_00FD,
+    OP_00FE,
+    OP_00FF,
+    OP_FX30,
+    OP_FX75,
+    OP_FX85,
+
+    // XO-CHIP
+    OP_00DN,
+    OP_5XY2,
+    OP_5XY3,
+    OP_F000,
+    OP_FN01,
+    OP_F002,
+    OP_FX3A,
+
+    OP_COUNT
+};
+
+//-------------------------------------------------------------------------------------------------
+// How an instruction affects control flow and memory
+enum EightChipOpcodeFlags
+{
+    OPF_NONE = 0,
+    OPF_JUMP = 1 << 0,           // Unconditional jump to NNN
+    OPF_CALL = 1 << 1,           // Subroutine call to NNN
+    OPF_RETURN = 1 << 2,         // Return from subroutine
+    OPF_SKIP = 1 << 3,           // Conditionally skips the next instruction
+    OPF_COMPUTED_JUMP = 1 << 4,  // Jump to a target only known at runtime
+    OPF_READS_MEMORY = 1 << 5,   // Reads memory at I
+    OPF_WRITES_MEMORY = 1 << 6,  // Writes memory at I
+    OPF_SETS_I = 1 << 7,         // Loads I with a constant
+    OPF_MODIFIES_I = 1 << 8,     // Changes I to a value only known at runtime
+    OPF_EXIT = 1 << 9,           // Stops the program
+    OPF_LONG = 1 << 10,          // Followed by a 16-bits operand, 4 bytes long
+};
+
+//-------------------------------------------------------------------------------------------------
+struct EightChipOpcodeInfo
+{
+    // Assembly syntax, as in the comments of the OpCode handlers: "LD Vx, byte"
+    const char* syntax;
+
+    // see. EightChipOpcodeFlags
+    int flags;
+};
+
+//-------------------------------------------------------------------------------------------------
+// Instruction of every opcode, as an EightChipOpcodeId
+struct EightChipDecodeTable
+{
+    BYTE ids[ 0x10000 ];
+};
+
+static_assert( OP_COUNT <= 0x100, "Opcode ids must fit the decode table" );
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ecops
+{
+    // Built at compile time, the CPU and the tools decode through the same table. It holds the
+    // instructions of every profile, see. IsSupported.
+    extern const EightChipDecodeTable DECODE_TABLE;
+
+    // Is the instruction one of the profile's, SUPER-CHIP and XO-CHIP ones trap elsewhere
+    bool IsSupported( EightChipOpcodeId id, EightChipProfile profile );
+
+    // OP_INVALID for anything the profile traps on
+    EightChipOpcodeId Identify( WORD opcode, EightChipProfile profile );
+
+    const EightChipOpcodeInfo& GetInfo( EightChipOpcodeId id );
+
+    // Size in bytes of the instruction starting with opcode
+    int GetLength( WORD opcode, EightChipProfile profile );
+
+    // "LD VA, 0x02", operand is the word following a long instruction. Names the instruction
+    // whichever profile has it.
+    std::string Disassemble( WORD opcode, WORD operand = 0 );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
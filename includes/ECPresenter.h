@@ -0,0 +1,144 @@
+#ifndef _EIGHTCHIP_PRESENTER_INCLUDED_
+#define _EIGHTCHIP_PRESENTER_INCLUDED_
+
+#include <memory>
+#include <string>
+
+#include <SDL.h>
+
+#include "ECCpu.h"
+#include "ECGlobals.h"
+
+//-------------------------------------------------------------------------------------------------
+struct EightChipPresenterConfig
+{
+    // Scales the display by whole multiples only, leaving borders rather than uneven pixels
+    bool integerScaling = false;
+
+    // Share of the previous frame kept where pixels went dark, 0 for none (see. PERSISTENCE)
+    float persistence = 0.0f;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Puts the display of the CPU on screen. The backend is picked at runtime from the settings
+ * (see. ecgfx::CreatePresenter), from drawing nothing at all to a core OpenGL context.
+ */
+class EightChipPresenter
+{
+public:
+    virtual ~EightChipPresenter( )
+    {
+    }
+
+public:
+    // False when the presenter draws nowhere and no window should be created
+    virtual bool NeedsWindow( ) const = 0;
+
+    // Flags for SDL_CreateWindow, and anything to set before the window is created
+    virtual Uint32 PrepareWindow( ) = 0;
+
+    // Creates the resources of the backend for the window, which may be nullptr
+    virtual bool Initialise( SDL_Window* window ) = 0;
+
+    virtual void Present( const EightChipCPU& cpu ) = 0;
+
+    virtual const char* GetName( ) const = 0;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Draws nothing: benchmarks and headless servers. */
+class EightChipNullPresenter : public EightChipPresenter
+{
+public:
+    bool NeedsWindow( ) const override;
+    Uint32 PrepareWindow( ) override;
+    bool Initialise( SDL_Window* window ) override;
+    void Present( const EightChipCPU& cpu ) override;
+    const char* GetName( ) const override;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** SDL_Renderer with a streaming texture, SDL picks the fastest API of the platform. */
+class EightChipRendererPresenter : public EightChipPresenter
+{
+public:
+    explicit EightChipRendererPresenter( const EightChipPresenterConfig& config );
+    ~EightChipRendererPresenter( );
+
+public:
+    bool NeedsWindow( ) const override;
+    Uint32 PrepareWindow( ) override;
+    bool Initialise( SDL_Window* window ) override;
+    void Present( const EightChipCPU& cpu ) override;
+    const char* GetName( ) const override;
+
+private:
+    EightChipPresenterConfig m_Config;
+
+    SDL_Renderer* m_Renderer;
+    SDL_Texture* m_Texture;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * OpenGL 3.3 core. The display is uploaded to a texture of its native size, a first pass blends
+ * it with the previous frame into a persistence texture of the same size, a second pass scales
+ * that to the window. Both passes are a single triangle, nothing is left for the CPU to do.
+ */
+class EightChipGLPresenter : public EightChipPresenter
+{
+public:
+    explicit EightChipGLPresenter( const EightChipPresenterConfig& config );
+    ~EightChipGLPresenter( );
+
+public:
+    bool NeedsWindow( ) const override;
+    Uint32 PrepareWindow( ) override;
+    bool Initialise( SDL_Window* window ) override;
+    void Present( const EightChipCPU& cpu ) override;
+    const char* GetName( ) const override;
+
+private:
+    EightChipPresenterConfig m_Config;
+
+    SDL_Window* m_Window;
+    SDL_GLContext m_Context;
+
+    unsigned int m_PersistProgram;
+    unsigned int m_ScaleProgram;
+    unsigned int m_VertexArray;
+    unsigned int m_Texture;
+
+    // Persistence textures, written and read in turn: m_Current holds the latest frame
+    unsigned int m_History[ 2 ];
+    unsigned int m_Framebuffers[ 2 ];
+    int m_Current;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ecgfx
+{
+    // "null", "renderer" or "opengl", nullptr for anything else
+    std::unique_ptr< EightChipPresenter > CreatePresenter( const std::string& name,
+                                                           const EightChipPresenterConfig& config );
+
+    // Composites the planes through the palette into RGBA pixels, see. ecdisplay::Expand
+    void ExpandPalette( const EightChipCPU& cpu, int scale, BYTE* pixels, size_t pitch );
+
+    // Writes the display to a BMP file, each pixel a scale x scale block
+    bool SaveScreenshot( const EightChipCPU& cpu, const std::string& filename, int scale );
+
+    // RGB of a plane combination, 0 being the background
+    const BYTE* GetPaletteColour( int colour );
+
+    // Largest area of the display's aspect ratio centred in a width x height output
+    SDL_Rect FitDisplay( int width, int height, bool integer_scaling );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
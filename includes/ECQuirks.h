@@ -0,0 +1,127 @@
+#ifndef _EIGHTCHIP_QUIRKS_INCLUDED_
+#define _EIGHTCHIP_QUIRKS_INCLUDED_
+
+#include <string>
+
+//-------------------------------------------------------------------------------------------------
+// Behaviours that differ between CHIP-8 variants, each profile picks one combination
+enum EightChipProfile
+{
+    PROFILE_EIGHTCHIP = 0,  // What this emulator always did
+    PROFILE_CHIP8,          // Original COSMAC VIP interpreter
+    PROFILE_SUPERCHIP,      // SUPER-CHIP 1.1 on the HP48
+    PROFILE_XOCHIP,         // XO-CHIP (Octo)
+
+    PROFILE_COUNT
+};
+
+//-------------------------------------------------------------------------------------------------
+// Instrumentation compiled into an interpreter variant, the plain variant has none
+enum EightChipHooks
+{
+    HOOKS_NONE = 0,
+    HOOKS_DEBUG = 1 << 0,  // Breakpoints, watchpoints and stepping (see. EightChipDebugger)
+    HOOKS_TRACE = 1 << 1,  // Execution trace (see. EightChipTracer)
+    HOOKS_TIMING = 1 << 2, // COSMAC VIP cycle budget and display wait (see. ectiming)
+    HOOKS_COVERAGE = 1 << 3, // Executed, read and written addresses (see. EightChipCoverage)
+
+    HOOKS_ALL = HOOKS_DEBUG | HOOKS_TRACE | HOOKS_TIMING | HOOKS_COVERAGE
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Quirk policies. The interpreter is instantiated once per policy (see
+ * EightChipCPU::RunOpCodes) so every quirk is a compile time constant.
+ *
+ * SHIFT_USES_VY          : 8XY6/8XYE shift Vy into Vx, rather than Vx in place
+ * LOAD_STORE_INCREMENTS_I: FX55/FX65 leave I past the last register
+ * JUMP_USES_VX           : BNNN jumps to XNN + Vx, rather than NNN + V0
+ * SPRITES_WRAP           : DXYN wraps pixels off the edges around, rather than clipping them
+ * LOGIC_RESETS_VF        : 8XY1/8XY2/8XY3 clear VF
+ * SUPERCHIP_OPCODES      : 00CN, 00FB-00FF, FX30, FX75 and FX85 decode, rather than trap
+ * XOCHIP_OPCODES         : 00DN, 5XY2, 5XY3, FN01, F002, FX3A and the 4 bytes long F000 NNNN
+ *                          decode, rather than trap
+ */
+namespace ecquirks
+{
+    struct EightChip
+    {
+        static constexpr bool SHIFT_USES_VY = false;
+        static constexpr bool LOAD_STORE_INCREMENTS_I = true;
+        static constexpr bool JUMP_USES_VX = false;
+        static constexpr bool SPRITES_WRAP = true;
+        static constexpr bool LOGIC_RESETS_VF = false;
+        static constexpr bool SUPERCHIP_OPCODES = true;
+        static constexpr bool XOCHIP_OPCODES = true;
+    };
+
+    struct Chip8
+    {
+        static constexpr bool SHIFT_USES_VY = true;
+        static constexpr bool LOAD_STORE_INCREMENTS_I = true;
+        static constexpr bool JUMP_USES_VX = false;
+        static constexpr bool SPRITES_WRAP = false;
+        static constexpr bool LOGIC_RESETS_VF = true;
+        static constexpr bool SUPERCHIP_OPCODES = false;
+        static constexpr bool XOCHIP_OPCODES = false;
+    };
+
+    struct SuperChip
+    {
+        static constexpr bool SHIFT_USES_VY = false;
+        static constexpr bool LOAD_STORE_INCREMENTS_I = false;
+        static constexpr bool JUMP_USES_VX = true;
+        static constexpr bool SPRITES_WRAP = false;
+        static constexpr bool LOGIC_RESETS_VF = false;
+        static constexpr bool SUPERCHIP_OPCODES = true;
+        static constexpr bool XOCHIP_OPCODES = false;
+    };
+
+    struct XoChip
+    {
+        static constexpr bool SHIFT_USES_VY = true;
+        static constexpr bool LOAD_STORE_INCREMENTS_I = true;
+        static constexpr bool JUMP_USES_VX = false;
+        static constexpr bool SPRITES_WRAP = true;
+        static constexpr bool LOGIC_RESETS_VF = false;
+        static constexpr bool SUPERCHIP_OPCODES = true;
+        static constexpr bool XOCHIP_OPCODES = true;
+    };
+
+    // The quirks of a profile with hooks compiled in, see. EightChipHooks
+    template < class QUIRKS, int HOOKS >
+    struct Hooked : QUIRKS
+    {
+    };
+
+    template < class QUIRKS >
+    struct HooksOf
+    {
+        static constexpr int value = HOOKS_NONE;
+    };
+
+    template < class QUIRKS, int HOOKS >
+    struct HooksOf< Hooked< QUIRKS, HOOKS > >
+    {
+        static constexpr int value = HOOKS;
+    };
+
+    // "eightchip", "chip8", "schip" or "xochip", false for anything else
+    bool ProfileFromName( const std::string& name, EightChipProfile& profile );
+
+    // Guesses the profile from the rom extension: .ch8, .sc8 and .xo8
+    EightChipProfile ProfileFromRomFile( const std::string& filename );
+
+    const char* GetProfileName( EightChipProfile profile );
+
+    // Constants of the profile's policy, for code that isn't instantiated per profile
+    bool LoadStoreIncrementsI( EightChipProfile profile );
+    bool HasSuperChipOpcodes( EightChipProfile profile );
+    bool HasXoChipOpcodes( EightChipProfile profile );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,24 @@
+#ifndef _EIGHTCHIP_ROM_INCLUDED_
+#define _EIGHTCHIP_ROM_INCLUDED_
+
+#include <string>
+#include <vector>
+
+#include "ECGlobals.h"
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ecrom
+{
+    // Reads a whole file, false if it can't be opened
+    bool ReadFile( const std::string& filename, std::vector< BYTE >& data );
+
+    // File name without its directories
+    std::string BaseName( const std::string& filename );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,45 @@
+#ifndef _EIGHTCHIP_ROMIMAGE_INCLUDED_
+#define _EIGHTCHIP_ROMIMAGE_INCLUDED_
+
+#include <memory>
+#include <string>
+
+#include "ECGlobals.h"
+#include "ECQuirks.h"
+#include "ECState.h"
+
+//-------------------------------------------------------------------------------------------------
+
+class EightChipCPU;
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * The state a rom starts from, fonts and rom loaded, built once and shared read-only through a
+ * std::shared_ptr by whoever resets CPUs to that rom. Each CPU still holds its own full memory,
+ * the image only makes resets incremental: a CPU reset to the image it was last reset to copies
+ * back the memory pages it wrote since (see. EightChipCPU::IncrementalReset).
+ */
+class EightChipRomImage
+{
+public:
+    EightChipRomImage( );
+    ~EightChipRomImage( );
+
+public:
+    // Loads a rom image, or a rom file, with the profile the CPUs reset to it get
+    bool Load( const BYTE* rom, size_t size, EightChipProfile profile );
+    bool Load( const std::string& rom_filename, EightChipProfile profile );
+
+    const EightChipState& GetState( ) const;
+    EightChipProfile GetProfile( ) const;
+
+private:
+    // Holds the state with its alignment, and is never run
+    std::unique_ptr< EightChipCPU > m_CPU;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,51 @@
+#ifndef _EIGHTCHIP_RUNAHEAD_INCLUDED_
+#define _EIGHTCHIP_RUNAHEAD_INCLUDED_
+
+#include "ECCpu.h"
+
+//-------------------------------------------------------------------------------------------------
+// More than that and a frame of the slower roms no longer fits in 16ms
+static const int RUN_AHEAD_MAX_FRAMES = 8;
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Run-ahead: hides the frames a game takes to react to its input.
+ * After each real frame the state is saved, the CPU runs a few frames further with the keys held
+ * now and that screen is presented, then the saved state comes back. Saving and restoring are a
+ * copy of EightChipState each, the cost is in the frames run ahead.
+ * Holds a whole EightChipState, keep it on the stack (see. EightChipCPU::operator new).
+ */
+class EightChipRunAhead
+{
+public:
+    // budget is what a frame runs: instructions, or machine cycles under the VIP timing model
+    EightChipRunAhead( int frames, int budget, bool vipTiming );
+
+public:
+    int GetFrames( ) const;
+
+    // One whole frame without a window: the timers, then the budget
+    void RunFrame( EightChipCPU& cpu ) const;
+
+    // Saves the state and runs GetFrames( ) frames ahead. The CPU stays there, to be presented,
+    // until Restore( ) puts the saved state back.
+    void RunAhead( EightChipCPU& cpu );
+    void Restore( EightChipCPU& cpu );
+
+private:
+    int m_Frames;
+    int m_Budget;
+    bool m_VipTiming;
+
+    // Detached while running ahead: nothing should stop or record frames that are thrown away
+    EightChipDebugger* m_Debugger;
+    EightChipTracer* m_Tracer;
+
+    EightChipState m_Snapshot;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
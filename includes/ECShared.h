@@ -0,0 +1,134 @@
+#ifndef _EIGHTCHIP_SHARED_INCLUDED_
+#define _EIGHTCHIP_SHARED_INCLUDED_
+
+#include <atomic>
+#include <string>
+
+#include "ECCpu.h"
+#include "ECDisplay.h"
+#include "ECGlobals.h"
+
+//-------------------------------------------------------------------------------------------------
+// Shared memory segment layout, bump the version whenever it changes
+static const unsigned int SHARED_MAGIC = 0x38434845;  // "EHC8"
+static const unsigned int SHARED_VERSION = 1;
+
+// Frames kept in the ring, a reader has that many frames of time to copy one out
+static const int SHARED_FRAME_SLOTS = 4;
+
+// Key events waiting to be picked up by the emulator
+static const int SHARED_INPUT_SLOTS = 64;
+
+static_assert( ATOMIC_INT_LOCK_FREE == 2, "Shared counters must be lock free" );
+
+//-------------------------------------------------------------------------------------------------
+/** One finished frame with the registers and timers at the time it was drawn. */
+struct EightChipSharedFrame
+{
+    // Number of the frame since the emulator started, 0 being the first one
+    unsigned long long frame;
+
+    WORD programCounter;
+    WORD addressI;
+    BYTE registers[ 16 ];
+    BYTE delayTimer;
+    BYTE soundTimer;
+    bool highResolution;
+    BYTE planeMask;
+
+    // see. EightChipState::m_Display
+    EightChipPlane display[ DISPLAY_PLANES ];
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Frame slot guarded by a sequence lock: odd while the emulator writes it, even once done.
+ * A reader copies the frame between two reads of sequence and keeps the copy if both are equal
+ * and even.
+ */
+struct EightChipSharedSlot
+{
+    std::atomic< unsigned int > sequence;
+    EightChipSharedFrame data;
+};
+
+//-------------------------------------------------------------------------------------------------
+// Key event sent to the emulator, key being 0x0-0xF
+struct EightChipSharedKey
+{
+    BYTE key;
+    BYTE down;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * The shared memory segment.
+ * Frames: frame n goes to slot n % SHARED_FRAME_SLOTS, latestFrame is the number of the last
+ * complete frame plus 1 (0 until the first one is published).
+ * Input: single producer ring, the producer writes inputHead and the emulator inputTail.
+ */
+struct EightChipSharedSegment
+{
+    unsigned int magic;
+    unsigned int version;
+
+    std::atomic< unsigned int > latestFrame;
+    EightChipSharedSlot frames[ SHARED_FRAME_SLOTS ];
+
+    std::atomic< unsigned int > inputHead;
+    std::atomic< unsigned int > inputTail;
+    EightChipSharedKey input[ SHARED_INPUT_SLOTS ];
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Publishes the frames of a running emulator in a POSIX shared memory segment, and takes key
+ * presses from it. The emulator creates the segment, external processes open it.
+ * Nothing is copied through the kernel: readers map the same pages.
+ */
+class EightChipSharedMemory
+{
+public:
+    EightChipSharedMemory( );
+    ~EightChipSharedMemory( );
+
+public:
+    // Emulator side: creates the segment, name being "/something"
+    bool Create( const std::string& name );
+
+    // Consumer side: maps a segment created by the emulator
+    bool Open( const std::string& name );
+
+    void Close( );
+    bool IsOpen( ) const;
+
+    // Emulator side: publishes the display, registers and timers of the CPU as the next frame
+    void PublishFrame( const EightChipCPU& cpu );
+
+    // Emulator side: applies the key events sent since the last call
+    void PollInput( EightChipCPU& cpu );
+
+    // Consumer side: copies the latest frame out, false if there's none yet or the emulator kept
+    // overwriting it
+    bool ReadFrame( EightChipSharedFrame& frame ) const;
+
+    // Consumer side: queues a key event, false when the ring is full
+    bool SendKey( int key, bool down );
+
+    // The mapped segment, for readers that want to follow the sequence locks themselves
+    const EightChipSharedSegment* GetSegment( ) const;
+
+private:
+    EightChipSharedSegment* m_Segment;
+
+    // Name of the segment, only set when this side created it and unlinks it on Close( )
+    std::string m_Owned;
+
+    // Frames published so far
+    unsigned long long m_FrameCount;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
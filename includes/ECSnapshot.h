@@ -0,0 +1,69 @@
+#ifndef _EIGHTCHIP_SNAPSHOT_INCLUDED_
+#define _EIGHTCHIP_SNAPSHOT_INCLUDED_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "ECDisplay.h"
+#include "ECGlobals.h"
+#include "ECRomImage.h"
+#include "ECState.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * A guest state kept as what it changed of the rom image the CPU was reset to: the registers
+ * and the rest of the small fields, the display, and the memory pages that differ from the
+ * image's. Most roms only write a page or two, so a snapshot is a few KB where the state is 64KB.
+ *
+ * Its hash only depends on the state, never on the pages written back to what they were, so two
+ * CPUs in the same state save snapshots with the same hash (see. EightChipCPU::SaveSnapshot).
+ */
+class EightChipSnapshot
+{
+    friend class EightChipCPU;
+
+public:
+    EightChipSnapshot( );
+
+public:
+    QWORD GetHash( ) const;
+
+    // Bytes held, the image aside
+    size_t GetSize( ) const;
+
+    const std::shared_ptr< const EightChipRomImage >& GetImage( ) const;
+
+private:
+    std::shared_ptr< const EightChipRomImage > m_Image;
+
+    // Everything the state holds before the memory, padding included
+    BYTE m_Fields[ offsetof( EightChipState, m_GameMemory ) ];
+    EightChipPlane m_Display[ DISPLAY_PLANES ];
+
+    // Page numbers, and their content one after the other
+    std::vector< WORD > m_Pages;
+    std::vector< BYTE > m_Memory;
+
+    QWORD m_Hash;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ecsnapshot
+{
+    // splitmix64's finaliser, every bit of the input reaches every bit of the output
+    QWORD Mix( QWORD value );
+
+    // Folds the bytes into the hash 8 at a time
+    QWORD HashBytes( QWORD hash, const void* data, size_t size );
+
+    // Registers, timers and the rest of the small fields, leaving the padding out
+    QWORD HashFields( const EightChipState& state );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+#ifndef _EIGHTCHIP_STATE_INCLUDED_
+#define _EIGHTCHIP_STATE_INCLUDED_
+
+#include <type_traits>
+
+#include "ECDisplay.h"
+#include "ECGlobals.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Everything the guest program can see or change, in one block of plain data.
+ * Nothing points outside of it and nothing is allocated, so a snapshot or a reset is a single
+ * memcpy. The fields touched by every instruction come first and share the first cache lines,
+ * the memory and the display follow.
+ */
+struct alignas( 64 ) EightChipState
+{
+    // 16-bits program counter
+    WORD m_ProgramCounter;
+
+    // 16-bits address register used to access memory
+    WORD m_AddressI;
+
+    /** 16 registers, 8-bits (BYTE) each.
+    * called V0 to VF. VF doubles as the carry flag.
+    */
+    BYTE m_Registers[ 16 ];
+
+    /** Delay Timer active whenever register DT is non-zero.
+    * This timer subtracts 1 from DT at rate of 60Hz until 0 then deactivates.
+    */
+    BYTE m_DelayTimer;
+
+    /** Sound Timer active whenever register ST is non-zero.
+    * This timer subtracts 1 from ST at rate of 60Hz.
+    * Chip-8 will buzz as long as ST is greater than 0.
+    */
+    BYTE m_SoundTimer;
+
+    /**
+    * Return addresses of the subroutine calls, m_StackPointer being the number of them.
+    * The pointer is masked on every access so it never indexes outside of the stack.
+    */
+    BYTE m_StackPointer;
+    WORD m_Stack[ STACK_DEPTH ];
+
+    BYTE m_KeyState[ 16 ];
+
+    // SUPER-CHIP 128x64 mode (00FF), otherwise the display is driven at 64x32 (00FE)
+    bool m_HighResolution;
+
+    // Set by 00FD, the program is done and spins on the exit instruction
+    bool m_Halted;
+
+    // XO-CHIP bit planes drawn to, cleared and scrolled by the display instructions (FN01)
+    BYTE m_PlaneMask;
+
+    // XO-CHIP playback pitch of the audio pattern (FX3A)
+    BYTE m_Pitch;
+
+    // Latched EightChipFault flags
+    int m_Faults;
+
+    // State of the xorshift generator used by CXKK, so runs can be replayed from a seed.
+    unsigned int m_RandomState;
+
+    /** COSMAC VIP timing model (see. EightChipCPU::ExecuteCycles): machine cycles left of the
+    * budget, negative when the last instruction overran it, and whether a DXYN waits for the
+    * next display interrupt.
+    */
+    int m_CycleBalance;
+    bool m_WaitingFrame;
+
+    // SUPER-CHIP "RPL user flags" saved and restored by FX75/FX85
+    BYTE m_RPLFlags[ 16 ];
+
+    // XO-CHIP audio pattern (F002)
+    BYTE m_AudioPattern[ AUDIO_PATTERN_SIZE ];
+
+    /** 64KB of memory, addresses are masked so any 16-bits value is a valid index.
+    *
+    * Memory Map:
+    * 0x000-0x1FF - Chip 8 interpreter (contains font set in emu)
+    * 0x000-0x04F - Used for the built in 4x5 pixel font set (0-F)
+    * 0x050-0x0EF - Used for the built in SUPER-CHIP 8x10 pixel font set (0-F)
+    * 0x200-0xFFF - Program ROM and work RAM
+    * 0x1000-0xFFFF - XO-CHIP extended memory, reached through I (F000 NNNN)
+    */
+    BYTE m_GameMemory[ ROMSIZE ];
+
+    /** Screen at the native resolution, one bit per pixel and per plane. The planes of a pixel
+    * make up its colour index, 0 being the background (see. ecdisplay::GetColour).
+    * Scaling up to the window is left to the presentation.
+    */
+    EightChipPlane m_Display[ DISPLAY_PLANES ];
+};
+
+static_assert( std::is_trivially_copyable< EightChipState >::value,
+               "EightChipState is copied with memcpy" );
+static_assert( ( ROMSIZE & ( ROMSIZE - 1 ) ) == 0, "Memory addresses are masked" );
+static_assert( ( STACK_DEPTH & ( STACK_DEPTH - 1 ) ) == 0, "The stack pointer is masked" );
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,36 @@
+#ifndef _EIGHTCHIP_TIMING_INCLUDED_
+#define _EIGHTCHIP_TIMING_INCLUDED_
+
+#include "ECGlobals.h"
+#include "ECOpcodes.h"
+#include "ECState.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * COSMAC VIP timing model.
+ * The VIP's 1802 runs at 1.7609MHz, 8 clocks a machine cycle, so 3668 machine cycles make a
+ * 60Hz frame. The 1861 display takes 8 bytes of DMA on each of its 128 lines and the interrupt
+ * routine around it updates the timers: what's left is the interpreter's.
+ */
+static const int VIP_CYCLES_PER_FRAME = 3668;
+static const int VIP_DISPLAY_CYCLES = 1024 + 44;
+static const int VIP_INTERPRETER_CYCLES = VIP_CYCLES_PER_FRAME - VIP_DISPLAY_CYCLES;
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ectiming
+{
+    /**
+     * Machine cycles the VIP interpreter takes for the instruction about to run, fetch and
+     * decode included. DXYN, FX33, FX55 and FX65 depend on their operands, the others are
+     * constant. SUPER-CHIP and XO-CHIP instructions, which the VIP never had, are given the
+     * cost of their closest CHIP-8 instruction.
+     */
+    int GetCycles( const EightChipState& state, WORD opcode, EightChipOpcodeId id );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,131 @@
+#ifndef _EIGHTCHIP_TRACE_INCLUDED_
+#define _EIGHTCHIP_TRACE_INCLUDED_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ECGlobals.h"
+#include "ECState.h"
+
+//-------------------------------------------------------------------------------------------------
+// Trace file layout, bump the version whenever it changes
+static const unsigned int TRACE_MAGIC = 0x52544345;  // "ECTR"
+static const unsigned int TRACE_VERSION = 1;
+
+// 8MB of records, a quarter of an hour of a game running 1000 instructions per second
+static const size_t TRACE_DEFAULT_RECORDS = 1 << 20;
+
+static_assert( ATOMIC_LLONG_LOCK_FREE == 2, "Trace slots must be lock free" );
+
+//-------------------------------------------------------------------------------------------------
+// What a trace record holds, each instruction is followed by the records of what it changed
+enum EightChipTraceKind
+{
+    TRACE_INSTRUCTION = 0,  // count: SP, words: PC, opcode, I, all of them before executing
+    TRACE_REGISTERS,        // count: 1 to 3 entries, words: register << 8 | new value
+    TRACE_MEMORY,           // count: 1 to 4 bytes, words: address then the bytes written there
+    TRACE_FAULT,            // words: the EightChipFault flags the instruction raised
+};
+
+//-------------------------------------------------------------------------------------------------
+/** 8 bytes, one slot of the ring. */
+struct EightChipTraceRecord
+{
+    BYTE kind;
+    BYTE count;
+    WORD words[ 3 ];
+};
+
+static_assert( sizeof( EightChipTraceRecord ) == 8, "A trace record must fit a ring slot" );
+
+//-------------------------------------------------------------------------------------------------
+/** Header of a trace file, followed by count records starting on an instruction. */
+struct EightChipTraceHeader
+{
+    unsigned int magic;
+    unsigned int version;
+
+    // Records in the file, and records written since the tracer started of which they're the last
+    unsigned long long count;
+    unsigned long long total;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Records every instruction of a CPU, with the registers and memory it changed, into a ring
+ * holding the latest records (see. EightChipCPU::SetTracer).
+ *
+ * The CPU thread is the only writer: a record is stored to its slot, then the head is moved
+ * past it. Snapshot( ) and Flush( ) can be called from any thread without stopping the CPU,
+ * they keep the records the writer can't have overwritten while they were copied.
+ */
+class EightChipTracer
+{
+public:
+    // records is rounded up to a power of 2
+    explicit EightChipTracer( size_t records = TRACE_DEFAULT_RECORDS );
+
+public:
+    // Flushes the ring to the file whenever an instruction raises a new fault, empty for never
+    void SetFaultFile( const std::string& filename );
+
+    // Latest records, starting on an instruction
+    void Snapshot( std::vector< EightChipTraceRecord >& records ) const;
+
+    // Writes the latest records to a trace file (see. EightChipTraceHeader), count receiving how
+    // many when given
+    bool Flush( const std::string& filename, size_t* count = nullptr ) const;
+
+    // Records written since the tracer was created
+    unsigned long long GetTotal( ) const;
+
+    // Hooks of the trace interpreter, around each instruction and for each byte it writes
+    void OnInstruction( const EightChipState& state, WORD opcode );
+    void OnWrite( WORD address, BYTE value );
+    void OnInstructionDone( const EightChipState& state );
+
+private:
+    void Push( const EightChipTraceRecord& record );
+    void PushMemory( );
+
+private:
+    std::unique_ptr< std::atomic< unsigned long long >[] > m_Slots;
+    size_t m_Mask;
+
+    // Records written, the next one goes to m_Head & m_Mask
+    std::atomic< unsigned long long > m_Head;
+
+    // Registers before the current instruction
+    BYTE m_Registers[ 16 ];
+
+    // Consecutive bytes written by the current instruction not pushed yet
+    EightChipTraceRecord m_Memory;
+
+    int m_Faults;
+    std::string m_FaultFile;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+namespace ectrace
+{
+    // Reads a trace file written by EightChipTracer::Flush( )
+    bool Load( const std::string& filename,
+               std::vector< EightChipTraceRecord >& records,
+               EightChipTraceHeader& header );
+
+    /**
+     * One line for the instruction at index, with what it changed:
+     * 0x0210  22D4  CALL 0x2D4  I=02EA SP=0  V0=0C VF=01 [02F0]=01 02 03 !faults=1
+     * index is moved to the next instruction.
+     */
+    std::string Describe( const std::vector< EightChipTraceRecord >& records, size_t& index );
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
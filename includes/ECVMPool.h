@@ -0,0 +1,59 @@
+#ifndef _EIGHTCHIP_VMPOOL_INCLUDED_
+#define _EIGHTCHIP_VMPOOL_INCLUDED_
+
+#include <memory>
+#include <vector>
+
+#include "ECCpu.h"
+#include "ECGlobals.h"
+#include "ECRomImage.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * A fixed set of CPUs that are reset from a template instead of going through CPUReset( ) and
+ * reading the rom again. The template is a rom image the pool can share with others, and a
+ * reset only copies back the memory pages the guest wrote to (see.
+ * EightChipCPU::IncrementalReset).
+ */
+class EightChipVMPool
+{
+public:
+    explicit EightChipVMPool( int capacity );
+
+public:
+    // Builds the template from a rom image, or from a rom file
+    bool SetTemplate( const BYTE* rom, size_t size );
+    bool SetTemplate( const std::string& rom_filename );
+
+    // Uses an image already built, which may be shared with other pools
+    void SetTemplate( const std::shared_ptr< const EightChipRomImage >& image );
+    const std::shared_ptr< const EightChipRomImage >& GetTemplate( ) const;
+
+    // Hands out a CPU freshly reset to the template, nullptr when the pool is exhausted
+    EightChipCPU* Acquire( );
+
+    // Gives a CPU back to the pool
+    void Release( EightChipCPU* cpu );
+
+    // Resets a CPU to the template without giving it back
+    void Reset( EightChipCPU* cpu ) const;
+
+    int GetCapacity( ) const;
+
+private:
+    // State every CPU of the pool is reset to
+    std::shared_ptr< const EightChipRomImage > m_Template;
+
+    // The CPUs themselves, allocated one by one to get their alignment (see.
+    // EightChipCPU::operator new) and never reallocated once the pool is built
+    std::vector< std::unique_ptr< EightChipCPU > > m_Machines;
+
+    // CPUs currently available
+    std::vector< EightChipCPU* > m_Free;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,142 @@
+#ifndef _EIGHTCHIP_VECENV_INCLUDED_
+#define _EIGHTCHIP_VECENV_INCLUDED_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ECCpu.h"
+#include "ECGlobals.h"
+#include "ECVMPool.h"
+
+//-------------------------------------------------------------------------------------------------
+// Observations are the 64x32 low resolution screen, one QWORD per row and per plane
+static const int OBSERVATION_WIDTH = 64;
+static const int OBSERVATION_HEIGHT = 32;
+
+//-------------------------------------------------------------------------------------------------
+enum EightChipWatchKind
+{
+    WATCH_REWARD = 0,  // Rewards the change of the value over a step, times scale
+    WATCH_DONE,        // Ends the episode once the value equals value
+};
+
+//-------------------------------------------------------------------------------------------------
+/** A value in the game memory the environment looks at after each step, typically a score or a
+ * number of lives.
+ */
+struct EightChipWatch
+{
+    EightChipWatchKind kind;
+    WORD address;
+
+    // 1 or 2 bytes, most significant byte first like the CHIP-8 does
+    int size;
+
+    float scale;
+    int value;
+};
+
+//-------------------------------------------------------------------------------------------------
+struct EightChipEnvConfig
+{
+    int instances = 1;
+
+    // Worker threads stepping the instances, 0 for one per core
+    int threads = 0;
+
+    int opcodesPerFrame = 10;
+
+    // Planes copied into the observations, starting from plane 0
+    int observationPlanes = 1;
+
+    EightChipProfile profile = PROFILE_EIGHTCHIP;
+
+    std::vector< EightChipWatch > watches;
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * N copies of a rom stepped together, for agents that learn by playing.
+ *
+ * Step( ) takes one action per instance, the keys held down as a 16 bits mask (bit k for key k),
+ * runs the given number of frames and writes into buffers owned by the caller:
+ *
+ * observations: instances x observationPlanes x OBSERVATION_HEIGHT QWORDs, leftmost pixel in the
+ *               most significant bit (see. GetObservationSize)
+ * rewards     : instances floats, from the WATCH_REWARD watches
+ * dones       : instances bytes, 1 when the episode ended during the step
+ *
+ * An instance that ended its episode starts a new one on the next Step( ), seeded from the seed
+ * given to Reset( ). Nothing is allocated once the environment is built.
+ */
+class EightChipVecEnv
+{
+public:
+    explicit EightChipVecEnv( const EightChipEnvConfig& config );
+    ~EightChipVecEnv( );
+
+public:
+    bool LoadRom( const BYTE* rom, size_t size );
+    bool LoadRom( const std::string& rom_filename );
+
+    // Starts a new episode on every instance, observations may be nullptr
+    void Reset( unsigned int seed, QWORD* observations );
+
+    void Step( const WORD* actions, int frames, QWORD* observations, float* rewards, BYTE* dones );
+
+    int GetInstances( ) const;
+
+    // QWORDs written per instance into the observations
+    int GetObservationSize( ) const;
+
+private:
+    // Work of Reset( )/Step( ) on the instances [ begin, end [
+    void ResetRange( int begin, int end );
+    void StepRange( int begin, int end );
+
+    void ResetInstance( int index );
+    void Observe( int index );
+    int ReadWatch( const EightChipCPU* cpu, const EightChipWatch& watch ) const;
+
+    // Splits the instances between the workers and the calling thread, returns once all are done
+    void RunParallel( void ( EightChipVecEnv::*work )( int begin, int end ) );
+    void WorkerLoop( int worker );
+
+private:
+    EightChipEnvConfig m_Config;
+
+    EightChipVMPool m_Pool;
+    std::vector< EightChipCPU* > m_Machines;
+
+    // Per instance: episodes started, previous watch values, whether the episode ended
+    std::vector< unsigned int > m_Episodes;
+    std::vector< int > m_Watched;
+    std::vector< BYTE > m_Done;
+
+    unsigned int m_Seed;
+
+    // Arguments of the step being run, read by the workers
+    const WORD* m_Actions;
+    int m_Frames;
+    QWORD* m_Observations;
+    float* m_Rewards;
+    BYTE* m_Dones;
+
+    // Workers wait for m_Generation to change, run their share, then count down m_Pending
+    std::vector< std::thread > m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkReady;
+    std::condition_variable m_WorkDone;
+    void ( EightChipVecEnv::*m_Work )( int begin, int end );
+    unsigned int m_Generation;
+    int m_Pending;
+    bool m_Stopping;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
+
+//-------------------------------------------------------------------------------------------------
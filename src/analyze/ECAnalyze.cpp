@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ECAnalysis.h"
+#include "ECRom.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * eight_chip_analyze: static analysis of a rom followed by a short headless profiling run.
+ *
+ * usage: eight_chip_analyze ROMFILE [--frames N] [--opcodes-per-frame N] [--top N] [--no-disasm]
+ *                           [--profile eightchip|chip8|schip|xochip]
+ *
+ * The profiling run guesses the quirk profile from the rom extension unless --profile is given.
+ */
+namespace
+{
+    struct AnalyzeOptions
+    {
+        std::string rom;
+        int frames = 600;
+        int opcodesPerFrame = 10;
+        int top = 10;
+        bool disassemble = true;
+        bool hasProfile = false;
+        EightChipProfile profile = PROFILE_EIGHTCHIP;
+    };
+
+    bool
+    ParseArguments( int argc, char* argv[ ], AnalyzeOptions& options )
+    {
+        for ( int i = 1; i < argc; i++ )
+        {
+            bool hasValue = i + 1 < argc;
+
+            if ( strcmp( argv[ i ], "--frames" ) == 0 && hasValue )
+                options.frames = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--opcodes-per-frame" ) == 0 && hasValue )
+                options.opcodesPerFrame = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--top" ) == 0 && hasValue )
+                options.top = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--no-disasm" ) == 0 )
+                options.disassemble = false;
+            else if ( strcmp( argv[ i ], "--profile" ) == 0 && hasValue )
+            {
+                if ( !ecquirks::ProfileFromName( argv[ ++i ], options.profile ) )
+                    return false;
+
+                options.hasProfile = true;
+            }
+            else if ( argv[ i ][ 0 ] != '-' && options.rom.empty( ) )
+                options.rom = argv[ i ];
+            else
+                return false;
+        }
+
+        if ( options.rom.empty( ) )
+            return false;
+
+        if ( !options.hasProfile )
+            options.profile = ecquirks::ProfileFromRomFile( options.rom );
+
+        return true;
+    }
+
+    void
+    PrintBlock( const EightChipAnalysis& analysis, const EightChipBlock& block, bool disassemble )
+    {
+        printf( "0x%03X-0x%03X %2d instr", block.start, block.last, block.length );
+
+        if ( !block.successors.empty( ) )
+        {
+            printf( "  ->" );
+            for ( WORD successor : block.successors )
+                printf( " 0x%03X", successor );
+        }
+
+        if ( block.terminator == OP_BNNN )
+            printf( "  -> computed" );
+        if ( block.terminator == OP_INVALID )
+            printf( "  -> illegal opcode" );
+
+        printf( "\n" );
+
+        if ( !disassemble )
+            return;
+
+        int address = block.start;
+
+        while ( address < block.end )
+        {
+            int offset = address - 0x200;
+            WORD opcode = ( analysis.rom[ offset ] << 8 ) | analysis.rom[ offset + 1 ];
+            WORD operand = 0;
+
+            int length = ecops::GetLength( opcode, analysis.profile );
+
+            if ( length == 4 && offset + 3 < static_cast< int >( analysis.rom.size( ) ) )
+                operand = ( analysis.rom[ offset + 2 ] << 8 ) | analysis.rom[ offset + 3 ];
+
+            printf( "    0x%03X  %04X  %s\n",
+                    address,
+                    opcode,
+                    ecops::Disassemble( opcode, operand ).c_str( ) );
+
+            address += length;
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+int
+main( int argc, char* argv[ ] )
+{
+    AnalyzeOptions options;
+
+    if ( !ParseArguments( argc, argv, options ) )
+    {
+        fprintf( stderr,
+                 "usage: %s ROMFILE [--frames N] [--opcodes-per-frame N] [--top N] [--no-disasm]\n"
+                 "       [--profile eightchip|chip8|schip|xochip]\n",
+                 argv[ 0 ] );
+        return 1;
+    }
+
+    std::vector< BYTE > rom;
+
+    if ( !ecrom::ReadFile( options.rom, rom ) )
+    {
+        fprintf( stderr, ERR03 "\n" );
+        return 1;
+    }
+
+    EightChipAnalysis analysis;
+    ecanalysis::Analyse( rom.data( ), rom.size( ), options.profile, analysis );
+
+    if ( options.frames > 0 )
+        ecanalysis::Profile( options.frames, options.opcodesPerFrame, options.profile, analysis );
+
+    printf( "; %s: %d bytes, %d blocks\n\n",
+            options.rom.c_str( ),
+            static_cast< int >( rom.size( ) ),
+            static_cast< int >( analysis.blocks.size( ) ) );
+
+    printf( "; Blocks\n" );
+    for ( const auto& it : analysis.blocks )
+        PrintBlock( analysis, it.second, options.disassemble );
+
+    printf( "\n; Call graph\n" );
+    for ( const auto& it : analysis.calls )
+    {
+        printf( "0x%03X ->", it.first );
+        for ( WORD callee : it.second )
+            printf( " 0x%03X", callee );
+        printf( "\n" );
+    }
+
+    printf( "\n; Computed jumps (BNNN)\n" );
+    for ( WORD address : analysis.computedJumps )
+        printf( "0x%03X\n", address );
+
+    printf( "\n; Self-modifying writes\n" );
+    for ( WORD address : analysis.selfModifyingWrites )
+        printf( "0x%03X  writes into code\n", address );
+    for ( WORD address : analysis.unknownWrites )
+        printf( "0x%03X  writes at an unknown I\n", address );
+
+    printf( "\n; Data regions\n" );
+    for ( const auto& region : analysis.dataRegions )
+    {
+        printf( "0x%03X-0x%03X %4d bytes",
+                region.first,
+                region.second - 1,
+                region.second - region.first );
+
+        auto ref = analysis.dataReferences.lower_bound( region.first );
+        if ( ref != analysis.dataReferences.end( ) && *ref < region.second )
+            printf( "  referenced by ANNN" );
+
+        printf( "\n" );
+    }
+
+    if ( options.frames <= 0 )
+        return 0;
+
+    printf( "\n; Hot blocks (%d frames, %d opcodes per frame, %s quirks)\n", options.frames,
+            options.opcodesPerFrame, ecquirks::GetProfileName( options.profile ) );
+
+    std::vector< const EightChipBlock* > hot;
+    unsigned long long total = 0;
+
+    for ( const auto& it : analysis.blocks )
+    {
+        total += it.second.instructions;
+
+        if ( it.second.instructions > 0 )
+            hot.push_back( &it.second );
+    }
+
+    for ( const auto& it : analysis.unknownExecutions )
+        total += it.second;
+
+    std::sort( hot.begin( ), hot.end( ), []( const EightChipBlock* a, const EightChipBlock* b ) {
+        return a->instructions > b->instructions;
+    } );
+
+    if ( static_cast< int >( hot.size( ) ) > options.top )
+        hot.resize( options.top );
+
+    for ( const EightChipBlock* block : hot )
+    {
+        printf( "0x%03X-0x%03X %10llu entries %10llu instr  %5.1f%%\n", block->start, block->last,
+                block->executions, block->instructions, 100.0 * block->instructions / total );
+    }
+
+    for ( const auto& it : analysis.unknownExecutions )
+        printf( "0x%03X  executed %llu times, not found statically\n", it.first, it.second );
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,393 @@
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "ECAnalysis.h"
+#include "ECRom.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * eight_chip_aot: translates a rom into C++, to be built with the core into a native binary.
+ *
+ * usage: eight_chip_aot ROMFILE OUTPUT.cpp [--name NAME] [--profile eightchip|chip8|schip|xochip]
+ *
+ * Each basic block found by ecanalysis::Analyse becomes a function (see. EightChipAotBlock). The
+ * instructions that don't depend on the profile's quirks are written out as C++, the others call
+ * the interpreter's handler for that opcode. Jumps and skips set the PC and return, the runner
+ * then dispatches to the next block or interprets what wasn't found statically. A block checks
+ * its code is still that of the rom before running, and again after each write to memory.
+ * The binary's main( ) is ecaot::Main. The rom's profile comes from its extension unless
+ * --profile is given.
+ */
+namespace
+{
+    // Indexed by EightChipProfile
+    const char* PROFILE_NAMES[] = {
+        "PROFILE_EIGHTCHIP", "PROFILE_CHIP8", "PROFILE_SUPERCHIP", "PROFILE_XOCHIP"
+    };
+
+    struct AotOptions
+    {
+        std::string rom;
+        std::string output;
+        std::string name;
+        bool hasProfile = false;
+        EightChipProfile profile = PROFILE_EIGHTCHIP;
+    };
+
+    //---------------------------------------------------------------------------------------------
+    bool
+    ParseArguments( int argc, char* argv[ ], AotOptions& options )
+    {
+        for ( int i = 1; i < argc; i++ )
+        {
+            bool hasValue = i + 1 < argc;
+
+            if ( strcmp( argv[ i ], "--name" ) == 0 && hasValue )
+                options.name = argv[ ++i ];
+            else if ( strcmp( argv[ i ], "--profile" ) == 0 && hasValue )
+            {
+                if ( !ecquirks::ProfileFromName( argv[ ++i ], options.profile ) )
+                    return false;
+
+                options.hasProfile = true;
+            }
+            else if ( argv[ i ][ 0 ] != '-' && options.rom.empty( ) )
+                options.rom = argv[ i ];
+            else if ( argv[ i ][ 0 ] != '-' && options.output.empty( ) )
+                options.output = argv[ i ];
+            else
+                return false;
+        }
+
+        if ( options.rom.empty( ) || options.output.empty( ) )
+            return false;
+
+        if ( !options.hasProfile )
+            options.profile = ecquirks::ProfileFromRomFile( options.rom );
+
+        if ( options.name.empty( ) )
+        {
+            size_t slash = options.rom.find_last_of( "/\\" );
+            options.name = ( slash == std::string::npos ) ? options.rom
+                                                          : options.rom.substr( slash + 1 );
+        }
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    std::string
+    Format( const char* format, ... )
+    {
+        char text[ 256 ];
+
+        va_list args;
+        va_start( args, format );
+        vsnprintf( text, sizeof( text ), format, args );
+        va_end( args );
+
+        return text;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    /** C++ for the instructions that are the same under every profile, empty for the others. */
+    std::string
+    TranslateInstruction( WORD opcode, EightChipOpcodeId id )
+    {
+        int x = ( opcode & 0x0F00 ) >> 8;
+        int y = ( opcode & 0x00F0 ) >> 4;
+        int kk = opcode & 0x00FF;
+
+        switch ( id )
+        {
+        case OP_6XKK:
+            return Format( "    V[ 0x%X ] = 0x%02X;\n", x, kk );
+        case OP_7XKK:
+            return Format( "    V[ 0x%X ] += 0x%02X;\n", x, kk );
+        case OP_8XY0:
+            return Format( "    V[ 0x%X ] = V[ 0x%X ];\n", x, y );
+
+        // VF is set first, as the handlers do, it may be Vx or Vy
+        case OP_8XY4:
+            return Format( "    V[ 0xF ] = 0;\n"
+                           "    if ( V[ 0x%X ] + V[ 0x%X ] > 0xFF )\n"
+                           "        V[ 0xF ] = 1;\n"
+                           "    V[ 0x%X ] = V[ 0x%X ] + V[ 0x%X ];\n",
+                           x, y, x, x, y );
+        case OP_8XY5:
+            return Format( "    V[ 0xF ] = 1;\n"
+                           "    if ( V[ 0x%X ] < V[ 0x%X ] )\n"
+                           "        V[ 0xF ] = 0;\n"
+                           "    V[ 0x%X ] = V[ 0x%X ] - V[ 0x%X ];\n",
+                           x, y, x, x, y );
+        case OP_8XY7:
+            return Format( "    V[ 0xF ] = 1;\n"
+                           "    if ( V[ 0x%X ] > V[ 0x%X ] )\n"
+                           "        V[ 0xF ] = 0;\n"
+                           "    V[ 0x%X ] = V[ 0x%X ] - V[ 0x%X ];\n",
+                           x, y, x, y, x );
+
+        case OP_ANNN:
+            return Format( "    s.m_AddressI = 0x%03X;\n", opcode & 0x0FFF );
+        case OP_FX07:
+            return Format( "    V[ 0x%X ] = s.m_DelayTimer;\n", x );
+        case OP_FX15:
+            return Format( "    s.m_DelayTimer = V[ 0x%X ];\n", x );
+        case OP_FX18:
+            return Format( "    s.m_SoundTimer = V[ 0x%X ];\n", x );
+        case OP_FX1E:
+            return Format( "    s.m_AddressI += V[ 0x%X ];\n", x );
+        case OP_FX29:
+            return Format( "    s.m_AddressI = FONT_ADDRESS + ( V[ 0x%X ] & 0xF ) * 5;\n", x );
+        default:
+            return "";
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    /** Condition under which a skip is taken, empty for what isn't a skip. */
+    std::string
+    TranslateSkip( WORD opcode, EightChipOpcodeId id )
+    {
+        int x = ( opcode & 0x0F00 ) >> 8;
+        int y = ( opcode & 0x00F0 ) >> 4;
+        int kk = opcode & 0x00FF;
+
+        switch ( id )
+        {
+        case OP_3XKK:
+            return Format( "V[ 0x%X ] == 0x%02X", x, kk );
+        case OP_4XKK:
+            return Format( "V[ 0x%X ] != 0x%02X", x, kk );
+        case OP_5XY0:
+            return Format( "V[ 0x%X ] == V[ 0x%X ]", x, y );
+        case OP_9XY0:
+            return Format( "V[ 0x%X ] != V[ 0x%X ]", x, y );
+        case OP_EX9E:
+            return Format( "s.m_KeyState[ V[ 0x%X ] & 0xF ] == 1", x );
+        case OP_EXA1:
+            return Format( "s.m_KeyState[ V[ 0x%X ] & 0xF ] == 0", x );
+        default:
+            return "";
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    std::string
+    TranslateBlock( const EightChipAnalysis& analysis, const EightChipBlock& block )
+    {
+        std::string body;
+        int count = 0;
+        bool returned = false;
+
+        for ( int address = block.start; address < block.end; )
+        {
+            int offset = address - 0x200;
+            WORD opcode = ( analysis.rom[ offset ] << 8 ) | analysis.rom[ offset + 1 ];
+            WORD operand = 0;
+            EightChipOpcodeId id = ecops::Identify( opcode, analysis.profile );
+            int flags = ecops::GetInfo( id ).flags;
+            int length = ecops::GetLength( opcode, analysis.profile );
+            int next = address + length;
+
+            if ( length == 4 && offset + 3 < static_cast< int >( analysis.rom.size( ) ) )
+                operand = ( analysis.rom[ offset + 2 ] << 8 ) | analysis.rom[ offset + 3 ];
+
+            count++;
+
+            body += Format( "\n    // 0x%03X  %04X  %s\n",
+                            address,
+                            opcode,
+                            ecops::Disassemble( opcode, operand ).c_str( ) );
+
+            std::string code = TranslateInstruction( opcode, id );
+            std::string skip = TranslateSkip( opcode, id );
+
+            if ( id == OP_1NNN )
+            {
+                body += Format( "    s.m_ProgramCounter = 0x%03X;\n    return %d;\n",
+                                opcode & 0x0FFF,
+                                count );
+                returned = true;
+            }
+            else if ( !skip.empty( ) )
+            {
+                body += Format( "    s.m_ProgramCounter = 0x%03X;\n"
+                                "    if ( %s )\n"
+                                "        aot.SkipNext( );\n"
+                                "    return %d;\n",
+                                address + 2, skip.c_str( ), count );
+                returned = true;
+            }
+            else if ( !code.empty( ) )
+            {
+                body += code;
+            }
+            else
+            {
+                // The handler reads the operand of F000 NNNN after the PC and moves past it
+                body += Format( "    s.m_ProgramCounter = 0x%03X;\n    aot.Execute( 0x%04X );\n",
+                                address + 2,
+                                opcode );
+
+                if ( next >= block.end )
+                {
+                    // Calls, returns, BNNN and the like leave the PC where they go
+                    body += Format( "    return %d;\n", count );
+                    returned = true;
+                }
+                else if ( id == OP_FX0A )
+                {
+                    // Stays on itself while no key is pressed
+                    body += Format( "    if ( s.m_ProgramCounter != 0x%03X )\n        return %d;\n",
+                                    next,
+                                    count );
+                }
+                else if ( flags & OPF_WRITES_MEMORY )
+                {
+                    body += Format( "    if ( !aot.IsIntact( 0x%03X, 0x%03X ) )\n"
+                                    "        return %d;\n",
+                                    next,
+                                    block.end,
+                                    count );
+                }
+            }
+
+            address = next;
+        }
+
+        if ( !returned )
+            body += Format( "\n    s.m_ProgramCounter = 0x%03X;\n    return %d;\n",
+                            block.end,
+                            count );
+
+        std::string res =
+            Format( "int\nBlock%04X( EightChipAotRunner& aot, int budget )\n{\n", block.start );
+
+        res += Format( "    if ( budget < %d || !aot.IsIntact( 0x%03X, 0x%03X ) )\n"
+                       "        return 0;\n\n",
+                       count,
+                       block.start,
+                       block.end );
+        res += "    EightChipState& s = aot.GetState( );\n";
+
+        if ( body.find( "V[" ) != std::string::npos )
+            res += "    BYTE* V = s.m_Registers;\n";
+
+        return res + body + "}\n";
+    }
+
+    //---------------------------------------------------------------------------------------------
+    bool
+    WriteProgram( const AotOptions& options, const EightChipAnalysis& analysis )
+    {
+        FILE* out = fopen( options.output.c_str( ), "w" );
+
+        if ( out == nullptr )
+            return false;
+
+        const char* separator = "//-----------------------------------------------"
+                                "--------------------------------------------------\n";
+
+        fprintf( out,
+                 "// Generated by eight_chip_aot from %s, don't edit\n\n",
+                 options.rom.c_str( ) );
+        fprintf( out, "#include \"ECAot.h\"\n\n%s", separator );
+
+        // Rom bytes the blocks compare the memory against
+        fprintf( out, "static const BYTE ROM[] = {" );
+
+        for ( size_t i = 0; i < analysis.rom.size( ); i++ )
+            fprintf( out, "%s0x%02X,", ( i % 16 == 0 ) ? "\n    " : " ", analysis.rom[ i ] );
+
+        fprintf( out, "\n};\n\n%snamespace\n{\n", separator );
+
+        for ( const auto& it : analysis.blocks )
+        {
+            if ( it.second.start < 0x200 || it.second.end > 0x200 + analysis.rom.size( ) )
+                continue;
+
+            fprintf( out, "\n%s\n", TranslateBlock( analysis, it.second ).c_str( ) );
+        }
+
+        fprintf( out, "};\n\n%s", separator );
+        fprintf( out, "static const EightChipAotEntry BLOCKS[] = {\n" );
+
+        size_t count = 0;
+
+        for ( const auto& it : analysis.blocks )
+        {
+            if ( it.second.start < 0x200 || it.second.end > 0x200 + analysis.rom.size( ) )
+                continue;
+
+            fprintf( out, "    { 0x%03X, &Block%04X },\n", it.first, it.first );
+            count++;
+        }
+
+        fprintf( out, "};\n\n" );
+        fprintf( out,
+                 "static const EightChipAotProgram PROGRAM = "
+                 "{ \"%s\", %s, ROM, sizeof( ROM ), BLOCKS, %zu };\n\n",
+                 options.name.c_str( ),
+                 PROFILE_NAMES[ options.profile ],
+                 count );
+        fprintf( out,
+                 "%sint\nmain( int argc, char* argv[ ] )\n{\n"
+                 "    return ecaot::Main( PROGRAM, argc, argv );\n}\n\n%s",
+                 separator,
+                 separator );
+
+        return fclose( out ) == 0;
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+int
+main( int argc, char* argv[ ] )
+{
+    AotOptions options;
+
+    if ( !ParseArguments( argc, argv, options ) )
+    {
+        fprintf( stderr,
+                 "usage: %s ROMFILE OUTPUT.cpp [--name NAME]\n"
+                 "       [--profile eightchip|chip8|schip|xochip]\n",
+                 argv[ 0 ] );
+        return 1;
+    }
+
+    std::vector< BYTE > rom;
+
+    if ( !ecrom::ReadFile( options.rom, rom ) )
+    {
+        fprintf( stderr, "%s: %s\n", options.rom.c_str( ), ERR03 );
+        return 1;
+    }
+
+    EightChipAnalysis analysis;
+    ecanalysis::Analyse( rom.data( ), rom.size( ), options.profile, analysis );
+
+    if ( analysis.blocks.empty( ) )
+    {
+        fprintf( stderr, "%s: no code found\n", options.rom.c_str( ) );
+        return 1;
+    }
+
+    if ( !WriteProgram( options, analysis ) )
+    {
+        fprintf( stderr, "%s: can't write the translation\n", options.output.c_str( ) );
+        return 1;
+    }
+
+    printf( "%s: %zu blocks translated into %s\n",
+            options.rom.c_str( ),
+            analysis.blocks.size( ),
+            options.output.c_str( ) );
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -1,11 +1,15 @@
+#include <ctime>
+
 #include "ECApp.h"
 
 //-------------------------------------------------------------------------------------------------
 EightChipApp::EightChipApp( )
 {
     statusRunning = true;
+    main_window = nullptr;
 
     eightchip_cpu = EightChipCPU::GetInstance( );
+    eightchip_cpu->SetRandomSeed( static_cast< unsigned int >( time( nullptr ) ) );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -20,20 +24,27 @@ EightChipApp::Initialise( )
         return false;
     }
 
-    if ( !ecgfx::InitGraphics( this->main_window ) )
+    this->presenter = ecgfx::LoadPresenter( this->settings );
+
+    if ( this->presenter == nullptr )
     {
-        ecsyst::LogError( ERR04 );
         delete this->eightchip_cpu;
 
         return false;
     }
 
+    if ( !ecgfx::InitGraphics( this->main_window, this->presenter.get( ) ) )
+    {
+        ecsyst::LogError( ERR04 );
+        Shutdown( );
+
+        return false;
+    }
+
     if ( !ecemulate::LoadRom( this->eightchip_cpu, this->settings ) )
     {
         ecsyst::LogError( ERR03 );
-        SDL_Quit( );
-
-        delete this->eightchip_cpu;
+        Shutdown( );
 
         return false;
     }
@@ -65,7 +76,8 @@ EightChipApp::Run( )
 void
 EightChipApp::Update( )
 {
-    ecemulate::EmulateCycle( this->eightchip_cpu, this->settings, this->statusRunning, this->main_window );
+    ecemulate::EmulateCycle( this->eightchip_cpu, this->settings, this->statusRunning,
+                             this->presenter.get( ) );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -73,6 +85,13 @@ void
 EightChipApp::Shutdown( )
 {
     delete this->eightchip_cpu;
+
+    // The presenter's resources belong to the window, which goes before SDL itself
+    this->presenter.reset( );
+
+    if ( this->main_window != nullptr )
+        SDL_DestroyWindow( this->main_window );
+
     SDL_Quit( );
 }
 
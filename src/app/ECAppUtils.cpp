@@ -1,4 +1,34 @@
+#include <algorithm>
+#include <iostream>
+
 #include "ECApp.h"
+#include "ECAudio.h"
+#include "ECDebugger.h"
+#include "ECRunAhead.h"
+#include "ECTiming.h"
+#include "ECTrace.h"
+
+//-------------------------------------------------------------------------------------------------
+// F12 saves the screen, 4x its native size
+static const std::string SCREENSHOT_FILE = "screenshot.bmp";
+static const int SCREENSHOT_SCALE = 4;
+
+//-------------------------------------------------------------------------------------------------
+// Audio output
+static const int AUDIO_SAMPLE_RATE = 44100;
+static const short AUDIO_AMPLITUDE = 8000;
+
+//-------------------------------------------------------------------------------------------------
+// Monotonic time for the slices and the latency measurements, SDL's ticks are only milliseconds
+static unsigned long long
+GetMicroseconds( )
+{
+    unsigned long long counter = SDL_GetPerformanceCounter( );
+    unsigned long long frequency = SDL_GetPerformanceFrequency( );
+
+    // Split so a nanosecond counter doesn't overflow once multiplied
+    return counter / frequency * 1000000ULL + counter % frequency * 1000000ULL / frequency;
+}
 
 //-------------------------------------------------------------------------------------------------
 /**
@@ -85,105 +115,92 @@ ecemulate::LoadRom( EightChipCPU* cpu, const SETTINGS_MAP& settings )
 
     ecsyst::LogError( "INFO: Loading " + (*it).second + " .. ");
 
-    // Load the rom into memory
-    res = cpu->InitRom( ( *it ).second );
-
-    return res;
-}
-//-------------------------------------------------------------------------------------------------
-void
-ecgfx::DrawGraphics( EightChipCPU* cpu, SDL_Window* window )
-{
-    // Create an OpenGL context associated with the window
-    SDL_GLContext glcontext = SDL_GL_CreateContext( window );
-
-    // Clear the color and depth buffers to ensure that the previous frame
-    // is not drawn on top of the current one
-    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-
-    // Load the identity matrix to reset the current matrix
-    glLoadIdentity( );
-
-    // Set the raster position to the top-left corner of the window
-    glRasterPos2i( -1, 1 );
+    // The quirks the rom expects, an explicit profile wins over the extension
+    EightChipProfile profile = ecquirks::ProfileFromRomFile( ( *it ).second );
 
-    // Set the pixel zoom to 1
-    glPixelZoom( 1, -1 );
+    SETTINGS_MAP::const_iterator profile_it = settings.find( ROM_PROFILE );
 
-    // Draw the pixel data stored in the m_ScreenPixels member of the EightChipCPU object
-    // on the window
-    glDrawPixels( WINDOW_WIDTH, WINDOW_HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, cpu->m_ScreenPixels );
+    if ( settings.end( ) != profile_it
+         && !ecquirks::ProfileFromName( profile_it->second, profile ) )
+    {
+        ecsyst::LogError( ERR11 );
+        return res;
+    }
 
-    // Swap the window's back buffer with the front buffer to make the
-    // drawn graphics visible on the screen
-    SDL_GL_SwapWindow( window );
+    cpu->SetProfile( profile );
 
-    // Flush the OpenGL pipeline
-    glFlush( );
+    // Load the rom into memory
+    res = cpu->InitRom( ( *it ).second );
 
-    // Delete the OpenGL context associated with the window to free up
-    // any resources associated with the context
-    SDL_GL_DeleteContext( glcontext );
+    return res;
 }
 //-------------------------------------------------------------------------------------------------
-void
-ecgfx::InitOpenGL( SDL_Window* window )
+std::unique_ptr< EightChipPresenter >
+ecgfx::LoadPresenter( const SETTINGS_MAP& settings )
 {
-    // Create an OpenGL context associated with the window
-    SDL_GLContext glcontext = SDL_GL_CreateContext( window );
+    EightChipPresenterConfig config;
 
-    // Set the viewport to the size of the window
-    glViewport( 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT );
+    SETTINGS_MAP::const_iterator scaling_it = settings.find( SCALING );
 
-    // Set the projection matrix
-    glMatrixMode( GL_MODELVIEW );
-    glLoadIdentity( );
-    glOrtho( 0, WINDOW_WIDTH, WINDOW_HEIGHT, 0, -1.0, 1.0 );
+    if ( settings.end( ) != scaling_it )
+        config.integerScaling = scaling_it->second == "integer";
 
-    // Clear the screen to black
-    glClearColor( 0, 0, 0, 1.0 );
-    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+    SETTINGS_MAP::const_iterator persistence_it = settings.find( PERSISTENCE );
 
-    // Set the shading model
-    glShadeModel( GL_FLAT );
+    if ( settings.end( ) != persistence_it )
+        config.persistence = static_cast< float >( atof( persistence_it->second.c_str( ) ) );
 
-    // Swap buffers to display the scene
-    SDL_GL_SwapWindow( window );
+    SETTINGS_MAP::const_iterator it = settings.find( PRESENTER );
 
-    // Enable texturing
-    glEnable( GL_TEXTURE_2D );
+    std::unique_ptr< EightChipPresenter > presenter
+        = ecgfx::CreatePresenter( ( settings.end( ) != it ) ? it->second : "renderer", config );
 
-    // Disable depth testing, culling, dithering, and blending
-    glDisable( GL_DEPTH_TEST );
-    glDisable( GL_CULL_FACE );
-    glDisable( GL_DITHER );
-    glDisable( GL_BLEND );
+    if ( presenter == nullptr )
+        ecsyst::LogError( ERR13 );
 
-    // Delete the OpenGL context
-    SDL_GL_DeleteContext( glcontext );
+    return presenter;
 }
 
 //-------------------------------------------------------------------------------------------------
 bool
-ecgfx::InitGraphics( SDL_Window* window )
+ecgfx::InitGraphics( SDL_Window*& window, EightChipPresenter* presenter )
 {
+    window = nullptr;
+
+    // Only the subsystems in use, the null presenter has no need for video
+    Uint32 subsystems = SDL_INIT_TIMER | SDL_INIT_EVENTS | SDL_INIT_AUDIO;
+
+    if ( presenter->NeedsWindow( ) )
+        subsystems |= SDL_INIT_VIDEO;
+
     // Initialise the SDL library
-    if ( SDL_Init( SDL_INIT_EVERYTHING ) < 0 )
+    if ( SDL_Init( subsystems ) < 0 )
     {
         ecsyst::LogError( ERR05 );
         return false;
     }
 
-    // Create a window
-    window =  SDL_CreateWindow( WINDOW_CAPTION, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_OPENGL );
-    if ( window == nullptr )
+    if ( presenter->NeedsWindow( ) )
     {
-        ecsyst::LogError( ERR06 );
-        return false;
+        // Create a window, the presenters scale the display to whatever size it's given
+        Uint32 flags = presenter->PrepareWindow( ) | SDL_WINDOW_RESIZABLE;
+
+        window = SDL_CreateWindow( WINDOW_CAPTION, SDL_WINDOWPOS_UNDEFINED,
+                                   SDL_WINDOWPOS_UNDEFINED, WINDOW_WIDTH, WINDOW_HEIGHT, flags );
+        if ( window == nullptr )
+        {
+            ecsyst::LogError( ERR06 );
+            return false;
+        }
     }
 
-    // Initialise OpenGL
-    InitOpenGL( window );
+    // Set up the backend once, frames are only drawn afterwards
+    if ( !presenter->Initialise( window ) )
+    {
+        ecsyst::LogError( std::string( ERR14 ) + " " + presenter->GetName( ) + ": "
+                          + SDL_GetError( ) );
+        return false;
+    }
 
     return true;
 }
@@ -318,33 +335,184 @@ ecemulate::SetupInput( EightChipCPU* cpu, SDL_Event event )
     }
 }
 //-------------------------------------------------------------------------------------------------
+/** Opens the audio output, a device of 0 means the emulator runs silent. */
+SDL_AudioDeviceID
+ecemulate::InitAudio( )
+{
+    SDL_AudioSpec spec;
+    memset( &spec, 0, sizeof( spec ) );
+
+    spec.freq = AUDIO_SAMPLE_RATE;
+    spec.format = AUDIO_S16SYS;
+    spec.channels = 1;
+    spec.samples = 512;
+
+    SDL_AudioDeviceID device = SDL_OpenAudioDevice( NULL, 0, &spec, NULL, 0 );
+
+    if ( device == 0 )
+    {
+        ecsyst::LogError( ERR10 );
+        return 0;
+    }
+
+    SDL_PauseAudioDevice( device, 0 );
+
+    return device;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Queues one frame of sound: the audio pattern while the sound timer runs, silence otherwise.
+ * The pattern is mixed into the frame at the volume (0 - 32767).
+ */
 void
-ecemulate::EmulateCycle( EightChipCPU* cpu, const SETTINGS_MAP& settings, bool& status, SDL_Window* window )
+ecemulate::PlayAudio( EightChipCPU* cpu, SDL_AudioDeviceID device, short volume )
+{
+    const int samples = AUDIO_SAMPLE_RATE / 60;
+
+    static short buffer[ samples ];
+    static short pattern[ samples ];
+    static AUDIO_PHASE phase = 0;
+
+    if ( device == 0 )
+        return;
+
+    // Don't let the queue drift more than a few frames behind the emulation
+    if ( SDL_GetQueuedAudioSize( device ) > 3 * sizeof( buffer ) )
+        return;
+
+    memset( buffer, 0, sizeof( buffer ) );
+
+    if ( cpu->GetSoundTimer( ) > 0 )
+    {
+        ecaudio::RenderPattern( cpu->GetAudioPattern( ), cpu->GetPitch( ), AUDIO_SAMPLE_RATE,
+                                AUDIO_AMPLITUDE, phase, pattern, samples );
+        ecaudio::Mix( pattern, volume, buffer, samples );
+    }
+    else
+    {
+        phase = 0;
+    }
+
+    SDL_QueueAudio( device, buffer, sizeof( buffer ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+ecemulate::EmulateCycle( EightChipCPU* cpu,
+                         const SETTINGS_MAP& settings,
+                         bool& status,
+                         EightChipPresenter* presenter )
 {
     status = true;
 
+    // The VIP timing model runs a budget of machine cycles a frame rather than of instructions
+    bool vipTiming = false;
+
+    SETTINGS_MAP::const_iterator timing_it = settings.find( TIMING );
+
+    if ( settings.end( ) != timing_it && timing_it->second != "flat" )
+    {
+        if ( timing_it->second != "vip" )
+        {
+            ecsyst::LogError( ERR16 );
+            status = false;
+            return;
+        }
+
+        vipTiming = true;
+    }
+
     SETTINGS_MAP::const_iterator it = settings.find( "OpcodesPerSecond" );
 
     // Check whether the rom settings are indeed in file settings.
-    if ( settings.end( ) == it )
+    if ( settings.end( ) == it && !vipTiming )
     {
         ecsyst::LogError( ERR00 );
+        status = false;
         return;
     }
 
     int frameskip = 60;
 
     // number of OpCodes to execute per second
-    int numopcodes = atoi( ( *it ).second.c_str( ) );
+    int numopcodes = vipTiming ? 0 : atoi( ( *it ).second.c_str( ) );
+
+    // number of OpCodes to execute per frame, or of machine cycles
+    int numframe = vipTiming ? VIP_INTERPRETER_CYCLES : numopcodes / frameskip;
+
+    // Input is sampled, and the screen presented, around each slice of a frame. More slices
+    // get the effect of an input on screen sooner.
+    int slices = 1;
+
+    SETTINGS_MAP::const_iterator slices_it = settings.find( INPUT_SLICES );
 
-    // number of OpCodes to execute per frame
-    int numframe = numopcodes / frameskip;
+    if ( settings.end( ) != slices_it )
+    {
+        slices = atoi( slices_it->second.c_str( ) );
+        slices = std::max( 1, std::min( slices, std::max( 1, numframe ) ) );
+    }
+
+    // Frames run ahead of the emulation before each present, to hide the game's own reaction time
+    int aheadFrames = 0;
+
+    SETTINGS_MAP::const_iterator ahead_it = settings.find( RUN_AHEAD );
+
+    if ( settings.end( ) != ahead_it )
+        aheadFrames = atoi( ahead_it->second.c_str( ) );
+
+    EightChipRunAhead runAhead( aheadFrames, numframe, vipTiming );
 
     SDL_Event event;
-    float interval = 1000;
-    interval /= frameskip;
+    unsigned long long interval = 1000000ULL / ( frameskip * slices );
+
+    unsigned long long time = GetMicroseconds( );
+    int slice = 0;
+
+    // Time from a key event to the first present showing its effect
+    SETTINGS_MAP::const_iterator latency_it = settings.find( LATENCY_REPORT );
+    bool measureLatency = settings.end( ) != latency_it && atoi( latency_it->second.c_str( ) ) != 0;
+
+    EightChipLatencyTracker latency;
 
-    unsigned int time = SDL_GetTicks( );
+    SDL_AudioDeviceID audio = InitAudio( );
+
+    // Percent of the full volume, scaled to the mixer's gain
+    int volumePercent = 100;
+
+    SETTINGS_MAP::const_iterator volume_it = settings.find( VOLUME );
+
+    if ( settings.end( ) != volume_it )
+        volumePercent = std::max( 0, std::min( atoi( volume_it->second.c_str( ) ), 100 ) );
+
+    short volume = static_cast< short >( volumePercent * 32767 / 100 );
+
+    // Frames and input shared with external processes (see. EightChipSharedMemory)
+    EightChipSharedMemory shared;
+
+    SETTINGS_MAP::const_iterator shared_it = settings.find( SHARED_MEMORY );
+
+    if ( settings.end( ) != shared_it && !shared.Create( shared_it->second ) )
+        ecsyst::LogError( ERR12 );
+
+    // Breakpoints and stepping from the console, the CPU only pays for them when attached
+    EightChipDebugger debugger;
+
+    SETTINGS_MAP::const_iterator debugger_it = settings.find( DEBUGGER );
+
+    if ( settings.end( ) != debugger_it && atoi( debugger_it->second.c_str( ) ) != 0 )
+        cpu->SetDebugger( &debugger );
+
+    // The latest instructions, for when something goes wrong
+    std::unique_ptr< EightChipTracer > tracer;
+
+    SETTINGS_MAP::const_iterator trace_it = settings.find( TRACE_FILE );
+
+    if ( settings.end( ) != trace_it )
+    {
+        tracer.reset( new EightChipTracer( ) );
+        tracer->SetFaultFile( trace_it->second );
+        cpu->SetTracer( tracer.get( ) );
+    }
 
     while ( status )
     {
@@ -352,23 +520,117 @@ ecemulate::EmulateCycle( EightChipCPU* cpu, const SETTINGS_MAP& settings, bool&
         {
             ecemulate::SetupInput( cpu, event );
 
+            if ( measureLatency && ( event.type == SDL_KEYDOWN || event.type == SDL_KEYUP ) )
+                latency.OnInput( GetMicroseconds( ) );
+
+            if ( event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F12 )
+            {
+                if ( ecgfx::SaveScreenshot( *cpu, SCREENSHOT_FILE, SCREENSHOT_SCALE ) )
+                    ecsyst::LogError( "INFO: Saved " + SCREENSHOT_FILE );
+            }
+
+            if ( event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F5 )
+                debugger.Pause( );
+
+            if ( event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F9 && tracer )
+            {
+                if ( tracer->Flush( trace_it->second ) )
+                    ecsyst::LogError( "INFO: Saved " + trace_it->second );
+                else
+                    ecsyst::LogError( ERR15 );
+            }
+
             if ( event.type == SDL_QUIT )
             {
                 status = false;
             }
         }
 
-        unsigned int currentTime = SDL_GetTicks( );
+        shared.PollInput( *cpu );
 
-        if ( ( time + interval ) < currentTime )
+        if ( debugger.IsStopped( ) )
         {
-            cpu->DecreaseTimers( );
-            for ( int i = 0; i < numframe; i++ )
-                cpu->ExecuteNextOpCode( );
+            // The window stays as it is while the console waits for commands
+            presenter->Present( *cpu );
+            std::cout << ecdebug::DescribeStop( debugger ) << "\n";
+            ecdebug::PrintRegisters( *cpu, std::cout );
+
+            std::string line;
+
+            while ( status && debugger.IsStopped( ) )
+            {
+                std::cout << "> " << std::flush;
+
+                if ( !std::getline( std::cin, line )
+                     || !ecdebug::RunCommand( debugger, *cpu, line, std::cout ) )
+                    status = false;
+            }
 
-            time = currentTime;
-            ecgfx::DrawGraphics( cpu, window );
+            time = GetMicroseconds( );
         }
+
+        unsigned long long currentTime = GetMicroseconds( );
+
+        if ( ( time + interval ) <= currentTime )
+        {
+            // The timers run at 60Hz whatever the number of slices
+            if ( slice == 0 )
+                cpu->DecreaseTimers( );
+
+            int budget = numframe * ( slice + 1 ) / slices - numframe * slice / slices;
+
+            if ( vipTiming )
+                cpu->ExecuteCycles( budget );
+            else
+                cpu->ExecuteOpCodes( budget );
+
+            latency.OnSlice( );
+
+            // Slices keep to their own schedule, the time it took to get here doesn't shift the
+            // next one. A stall of more than a frame is dropped rather than caught up with.
+            time += interval;
+
+            if ( currentTime - time > interval * slices )
+                time = currentTime;
+
+            // The screen comes from frames ahead, everything else from the real one
+            bool runningAhead = runAhead.GetFrames( ) > 0 && !debugger.IsStopped( );
+
+            if ( runningAhead )
+                runAhead.RunAhead( *cpu );
+
+            presenter->Present( *cpu );
+
+            if ( runningAhead )
+                runAhead.Restore( *cpu );
+
+            if ( measureLatency )
+                latency.OnPresent( GetMicroseconds( ) );
+
+            if ( slice == slices - 1 )
+            {
+                shared.PublishFrame( *cpu );
+                PlayAudio( cpu, audio, volume );
+            }
+
+            slice = ( slice + 1 ) % slices;
+        }
+    }
+
+    if ( measureLatency )
+        ecsyst::LogError( latency.GetHistogram( ).Report( ) );
+
+    if ( audio != 0 )
+        SDL_CloseAudioDevice( audio );
+
+    cpu->SetDebugger( nullptr );
+
+    if ( tracer )
+    {
+        cpu->SetTracer( nullptr );
+
+        if ( !tracer->Flush( trace_it->second ) )
+            ecsyst::LogError( ERR15 );
     }
 }
 
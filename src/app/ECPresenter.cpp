@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <vector>
+
+#include "ECDisplay.h"
+#include "ECPresenter.h"
+
+//-------------------------------------------------------------------------------------------------
+// Colour of each plane combination: lit pixels of the first plane are drawn black on a white
+// background, the other entries are only reached by XO-CHIP games drawing on several planes.
+static const BYTE PALETTE[ 1 << DISPLAY_PLANES ][ 3 ] = {
+    { 0xFF, 0xFF, 0xFF }, { 0x00, 0x00, 0x00 }, { 0x80, 0x80, 0x80 }, { 0x40, 0x40, 0x40 },
+    { 0xC0, 0x00, 0x00 }, { 0x00, 0xC0, 0x00 }, { 0x00, 0x00, 0xC0 }, { 0xC0, 0xC0, 0x00 },
+    { 0xC0, 0x00, 0xC0 }, { 0x00, 0xC0, 0xC0 }, { 0xFF, 0x80, 0x00 }, { 0x80, 0x40, 0x00 },
+    { 0xFF, 0x80, 0x80 }, { 0x80, 0xFF, 0x80 }, { 0x80, 0x80, 0xFF }, { 0xC0, 0xC0, 0xC0 },
+};
+
+//-------------------------------------------------------------------------------------------------
+static const EightChipPalette&
+GetPalette( )
+{
+    static const EightChipPalette palette = ecdisplay::MakePalette( PALETTE );
+
+    return palette;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+ecgfx::ExpandPalette( const EightChipCPU& cpu, int scale, BYTE* pixels, size_t pitch )
+{
+    ecdisplay::Expand( cpu.m_Display, GetPalette( ), scale, pixels, pitch );
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecgfx::SaveScreenshot( const EightChipCPU& cpu, const std::string& filename, int scale )
+{
+    const int width = DISPLAY_WIDTH * scale;
+    const int height = DISPLAY_HEIGHT * scale;
+
+    std::vector< BYTE > pixels( static_cast< size_t >( width ) * height * 4 );
+
+    ExpandPalette( cpu, scale, pixels.data( ), width * 4 );
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom( pixels.data( ), width, height, 32,
+                                                               width * 4, SDL_PIXELFORMAT_RGBA32 );
+    if ( surface == nullptr )
+        return false;
+
+    bool saved = SDL_SaveBMP( surface, filename.c_str( ) ) == 0;
+    SDL_FreeSurface( surface );
+
+    return saved;
+}
+
+//-------------------------------------------------------------------------------------------------
+const BYTE*
+ecgfx::GetPaletteColour( int colour )
+{
+    return PALETTE[ colour & ( ( 1 << DISPLAY_PLANES ) - 1 ) ];
+}
+
+//-------------------------------------------------------------------------------------------------
+SDL_Rect
+ecgfx::FitDisplay( int width, int height, bool integer_scaling )
+{
+    float scale = std::min( static_cast< float >( width ) / DISPLAY_WIDTH,
+                            static_cast< float >( height ) / DISPLAY_HEIGHT );
+
+    // Below 1x there's no whole multiple left, the display is shrunk like with fit
+    if ( integer_scaling && scale >= 1.0f )
+        scale = static_cast< float >( static_cast< int >( scale ) );
+
+    SDL_Rect rect;
+    rect.w = static_cast< int >( DISPLAY_WIDTH * scale );
+    rect.h = static_cast< int >( DISPLAY_HEIGHT * scale );
+    rect.x = ( width - rect.w ) / 2;
+    rect.y = ( height - rect.h ) / 2;
+
+    return rect;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::unique_ptr< EightChipPresenter >
+ecgfx::CreatePresenter( const std::string& name, const EightChipPresenterConfig& config )
+{
+    std::string lower = name;
+    std::transform( lower.begin( ), lower.end( ), lower.begin( ), ::tolower );
+
+    if ( lower == "null" )
+        return std::unique_ptr< EightChipPresenter >( new EightChipNullPresenter( ) );
+
+    if ( lower == "renderer" )
+        return std::unique_ptr< EightChipPresenter >( new EightChipRendererPresenter( config ) );
+
+    if ( lower == "opengl" )
+        return std::unique_ptr< EightChipPresenter >( new EightChipGLPresenter( config ) );
+
+    return nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipNullPresenter::NeedsWindow( ) const
+{
+    return false;
+}
+
+Uint32
+EightChipNullPresenter::PrepareWindow( )
+{
+    return 0;
+}
+
+bool
+EightChipNullPresenter::Initialise( SDL_Window* )
+{
+    return true;
+}
+
+void
+EightChipNullPresenter::Present( const EightChipCPU& )
+{
+}
+
+const char*
+EightChipNullPresenter::GetName( ) const
+{
+    return "null";
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipRendererPresenter::EightChipRendererPresenter( const EightChipPresenterConfig& config )
+    : m_Config( config )
+    , m_Renderer( nullptr )
+    , m_Texture( nullptr )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipRendererPresenter::~EightChipRendererPresenter( )
+{
+    if ( m_Texture != nullptr )
+        SDL_DestroyTexture( m_Texture );
+
+    if ( m_Renderer != nullptr )
+        SDL_DestroyRenderer( m_Renderer );
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipRendererPresenter::NeedsWindow( ) const
+{
+    return true;
+}
+
+Uint32
+EightChipRendererPresenter::PrepareWindow( )
+{
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipRendererPresenter::Initialise( SDL_Window* window )
+{
+    // No vsync: the emulation loop paces the presents itself
+    m_Renderer = SDL_CreateRenderer( window, -1, 0 );
+
+    if ( m_Renderer == nullptr )
+        return false;
+
+    // Nearest filtering keeps the pixels sharp once scaled up to the window
+    SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "0" );
+
+    // SDL keeps the aspect ratio through resizes, with black borders
+    SDL_RenderSetLogicalSize( m_Renderer, DISPLAY_WIDTH, DISPLAY_HEIGHT );
+    SDL_RenderSetIntegerScale( m_Renderer, m_Config.integerScaling ? SDL_TRUE : SDL_FALSE );
+    SDL_SetRenderDrawColor( m_Renderer, 0x00, 0x00, 0x00, 0xFF );
+
+    m_Texture = SDL_CreateTexture( m_Renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING,
+                                   DISPLAY_WIDTH, DISPLAY_HEIGHT );
+
+    return m_Texture != nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipRendererPresenter::Present( const EightChipCPU& cpu )
+{
+    void* pixels;
+    int pitch;
+
+    // The display is expanded straight into the texture's memory
+    if ( SDL_LockTexture( m_Texture, nullptr, &pixels, &pitch ) != 0 )
+        return;
+
+    ecgfx::ExpandPalette( cpu, 1, static_cast< BYTE* >( pixels ), pitch );
+    SDL_UnlockTexture( m_Texture );
+
+    SDL_RenderClear( m_Renderer );
+    SDL_RenderCopy( m_Renderer, m_Texture, nullptr, nullptr );
+    SDL_RenderPresent( m_Renderer );
+}
+
+//-------------------------------------------------------------------------------------------------
+const char*
+EightChipRendererPresenter::GetName( ) const
+{
+    return "renderer";
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,376 @@
+#include <algorithm>
+
+#include <SDL_opengl.h>
+
+#include "ECPresenter.h"
+
+//-------------------------------------------------------------------------------------------------
+// Entry points past OpenGL 1.1 aren't exported by every platform's library, they are looked up
+// through SDL once the context exists.
+static PFNGLACTIVETEXTUREPROC glActiveTexture_;
+static PFNGLCREATESHADERPROC glCreateShader_;
+static PFNGLSHADERSOURCEPROC glShaderSource_;
+static PFNGLCOMPILESHADERPROC glCompileShader_;
+static PFNGLGETSHADERIVPROC glGetShaderiv_;
+static PFNGLDELETESHADERPROC glDeleteShader_;
+static PFNGLCREATEPROGRAMPROC glCreateProgram_;
+static PFNGLATTACHSHADERPROC glAttachShader_;
+static PFNGLLINKPROGRAMPROC glLinkProgram_;
+static PFNGLGETPROGRAMIVPROC glGetProgramiv_;
+static PFNGLUSEPROGRAMPROC glUseProgram_;
+static PFNGLDELETEPROGRAMPROC glDeleteProgram_;
+static PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocation_;
+static PFNGLUNIFORM1IPROC glUniform1i_;
+static PFNGLUNIFORM1FPROC glUniform1f_;
+static PFNGLUNIFORM3FPROC glUniform3f_;
+static PFNGLGENVERTEXARRAYSPROC glGenVertexArrays_;
+static PFNGLBINDVERTEXARRAYPROC glBindVertexArray_;
+static PFNGLDELETEVERTEXARRAYSPROC glDeleteVertexArrays_;
+static PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers_;
+static PFNGLBINDFRAMEBUFFERPROC glBindFramebuffer_;
+static PFNGLFRAMEBUFFERTEXTURE2DPROC glFramebufferTexture2D_;
+static PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus_;
+static PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffers_;
+
+//-------------------------------------------------------------------------------------------------
+template < class FUNCTION >
+static bool
+LoadFunction( FUNCTION& function, const char* name )
+{
+    function = reinterpret_cast< FUNCTION >( SDL_GL_GetProcAddress( name ) );
+
+    return function != nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+static bool
+LoadFunctions( )
+{
+    return LoadFunction( glActiveTexture_, "glActiveTexture" )
+           && LoadFunction( glCreateShader_, "glCreateShader" )
+           && LoadFunction( glShaderSource_, "glShaderSource" )
+           && LoadFunction( glCompileShader_, "glCompileShader" )
+           && LoadFunction( glGetShaderiv_, "glGetShaderiv" )
+           && LoadFunction( glDeleteShader_, "glDeleteShader" )
+           && LoadFunction( glCreateProgram_, "glCreateProgram" )
+           && LoadFunction( glAttachShader_, "glAttachShader" )
+           && LoadFunction( glLinkProgram_, "glLinkProgram" )
+           && LoadFunction( glGetProgramiv_, "glGetProgramiv" )
+           && LoadFunction( glUseProgram_, "glUseProgram" )
+           && LoadFunction( glDeleteProgram_, "glDeleteProgram" )
+           && LoadFunction( glGetUniformLocation_, "glGetUniformLocation" )
+           && LoadFunction( glUniform1i_, "glUniform1i" )
+           && LoadFunction( glUniform1f_, "glUniform1f" )
+           && LoadFunction( glUniform3f_, "glUniform3f" )
+           && LoadFunction( glGenVertexArrays_, "glGenVertexArrays" )
+           && LoadFunction( glBindVertexArray_, "glBindVertexArray" )
+           && LoadFunction( glDeleteVertexArrays_, "glDeleteVertexArrays" )
+           && LoadFunction( glGenFramebuffers_, "glGenFramebuffers" )
+           && LoadFunction( glBindFramebuffer_, "glBindFramebuffer" )
+           && LoadFunction( glFramebufferTexture2D_, "glFramebufferTexture2D" )
+           && LoadFunction( glCheckFramebufferStatus_, "glCheckFramebufferStatus" )
+           && LoadFunction( glDeleteFramebuffers_, "glDeleteFramebuffers" );
+}
+
+//-------------------------------------------------------------------------------------------------
+// Texture units the passes sample from
+static const int UNIT_DISPLAY = 0;
+static const int UNIT_HISTORY = 1;
+
+//-------------------------------------------------------------------------------------------------
+// One triangle covering the viewport, its corners come from the vertex index so that no vertex
+// buffer is needed. uv follows the textures: the first row is the top of the display.
+static const char* VERTEX_SHADER =
+    "#version 330 core\n"
+    "out vec2 uv;\n"
+    "void main( )\n"
+    "{\n"
+    "    vec2 corner = vec2( ( gl_VertexID << 1 ) & 2, gl_VertexID & 2 );\n"
+    "    uv = corner;\n"
+    "    gl_Position = vec4( corner * 2.0 - 1.0, 0.0, 1.0 );\n"
+    "}\n";
+
+// Lit pixels show up at once, pixels gone back to the background fade out over a few frames:
+// the XOR erase and redraw of a sprite no longer flashes.
+static const char* PERSIST_SHADER =
+    "#version 330 core\n"
+    "in vec2 uv;\n"
+    "out vec4 colour;\n"
+    "uniform sampler2D display;\n"
+    "uniform sampler2D history;\n"
+    "uniform vec3 background;\n"
+    "uniform float persistence;\n"
+    "void main( )\n"
+    "{\n"
+    "    vec4 now = texture( display, uv );\n"
+    "    vec4 before = texture( history, uv );\n"
+    "    bool dark = all( lessThan( abs( now.rgb - background ), vec3( 0.5 / 255.0 ) ) );\n"
+    "    colour = dark ? mix( now, before, persistence ) : now;\n"
+    "}\n";
+
+// Rows go to the window top first, OpenGL starts at the bottom
+static const char* SCALE_SHADER =
+    "#version 330 core\n"
+    "in vec2 uv;\n"
+    "out vec4 colour;\n"
+    "uniform sampler2D history;\n"
+    "void main( )\n"
+    "{\n"
+    "    colour = texture( history, vec2( uv.x, 1.0 - uv.y ) );\n"
+    "}\n";
+
+//-------------------------------------------------------------------------------------------------
+static GLuint
+CompileShader( GLenum type, const char* source )
+{
+    GLuint shader = glCreateShader_( type );
+    GLint compiled = GL_FALSE;
+
+    glShaderSource_( shader, 1, &source, nullptr );
+    glCompileShader_( shader );
+    glGetShaderiv_( shader, GL_COMPILE_STATUS, &compiled );
+
+    if ( compiled != GL_TRUE )
+    {
+        glDeleteShader_( shader );
+        return 0;
+    }
+
+    return shader;
+}
+
+//-------------------------------------------------------------------------------------------------
+static GLuint
+LinkProgram( const char* fragment_source )
+{
+    GLuint vertex = CompileShader( GL_VERTEX_SHADER, VERTEX_SHADER );
+    GLuint fragment = CompileShader( GL_FRAGMENT_SHADER, fragment_source );
+    GLuint program = 0;
+
+    if ( vertex != 0 && fragment != 0 )
+    {
+        GLint linked = GL_FALSE;
+
+        program = glCreateProgram_( );
+        glAttachShader_( program, vertex );
+        glAttachShader_( program, fragment );
+        glLinkProgram_( program );
+        glGetProgramiv_( program, GL_LINK_STATUS, &linked );
+
+        if ( linked != GL_TRUE )
+        {
+            glDeleteProgram_( program );
+            program = 0;
+        }
+    }
+
+    // The program keeps what it needs from the shaders
+    if ( vertex != 0 )
+        glDeleteShader_( vertex );
+
+    if ( fragment != 0 )
+        glDeleteShader_( fragment );
+
+    return program;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A texture of the display's native size, sampled without filtering. */
+static GLuint
+CreateDisplayTexture( )
+{
+    GLuint texture;
+
+    glGenTextures( 1, &texture );
+    glBindTexture( GL_TEXTURE_2D, texture );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, DISPLAY_WIDTH, DISPLAY_HEIGHT, 0, GL_RGBA,
+                  GL_UNSIGNED_BYTE, nullptr );
+
+    return texture;
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipGLPresenter::EightChipGLPresenter( const EightChipPresenterConfig& config )
+    : m_Config( config )
+    , m_Window( nullptr )
+    , m_Context( nullptr )
+    , m_PersistProgram( 0 )
+    , m_ScaleProgram( 0 )
+    , m_VertexArray( 0 )
+    , m_Texture( 0 )
+    , m_History{ 0, 0 }
+    , m_Framebuffers{ 0, 0 }
+    , m_Current( 0 )
+{
+    m_Config.persistence = std::max( 0.0f, std::min( m_Config.persistence, 1.0f ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipGLPresenter::~EightChipGLPresenter( )
+{
+    if ( m_Context == nullptr )
+        return;
+
+    // Deleting the name 0 is ignored, whatever Initialise( ) got to is released
+    if ( glDeleteFramebuffers_ != nullptr )
+    {
+        glDeleteFramebuffers_( 2, m_Framebuffers );
+        glDeleteVertexArrays_( 1, &m_VertexArray );
+        glDeleteProgram_( m_PersistProgram );
+        glDeleteProgram_( m_ScaleProgram );
+    }
+
+    glDeleteTextures( 2, m_History );
+    glDeleteTextures( 1, &m_Texture );
+
+    SDL_GL_DeleteContext( m_Context );
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipGLPresenter::NeedsWindow( ) const
+{
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+Uint32
+EightChipGLPresenter::PrepareWindow( )
+{
+    // The attributes apply to the contexts created afterwards, forward compatible for macOS
+    SDL_GL_SetAttribute( SDL_GL_CONTEXT_MAJOR_VERSION, 3 );
+    SDL_GL_SetAttribute( SDL_GL_CONTEXT_MINOR_VERSION, 3 );
+    SDL_GL_SetAttribute( SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE );
+    SDL_GL_SetAttribute( SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG );
+    SDL_GL_SetAttribute( SDL_GL_DOUBLEBUFFER, 1 );
+
+    return SDL_WINDOW_OPENGL;
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * The context lives as long as the presenter, everything drawn is set up here once. Only core
+ * 3.3 features with 8 bits textures are used, which Mesa's software rasterisers all have.
+ */
+bool
+EightChipGLPresenter::Initialise( SDL_Window* window )
+{
+    m_Window = window;
+    m_Context = SDL_GL_CreateContext( window );
+
+    if ( m_Context == nullptr || !LoadFunctions( ) )
+        return false;
+
+    // No vsync: the emulation loop paces the presents itself
+    SDL_GL_SetSwapInterval( 0 );
+
+    m_PersistProgram = LinkProgram( PERSIST_SHADER );
+    m_ScaleProgram = LinkProgram( SCALE_SHADER );
+
+    if ( m_PersistProgram == 0 || m_ScaleProgram == 0 )
+        return false;
+
+    // A core context draws nothing without a vertex array bound, even an empty one
+    glGenVertexArrays_( 1, &m_VertexArray );
+    glBindVertexArray_( m_VertexArray );
+
+    glActiveTexture_( GL_TEXTURE0 + UNIT_DISPLAY );
+    m_Texture = CreateDisplayTexture( );
+
+    glActiveTexture_( GL_TEXTURE0 + UNIT_HISTORY );
+    glGenFramebuffers_( 2, m_Framebuffers );
+
+    for ( int i = 0; i < 2; i++ )
+    {
+        m_History[ i ] = CreateDisplayTexture( );
+
+        glBindFramebuffer_( GL_FRAMEBUFFER, m_Framebuffers[ i ] );
+        glFramebufferTexture2D_( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                                 m_History[ i ], 0 );
+
+        if ( glCheckFramebufferStatus_( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
+            return false;
+
+        // Nothing to fade from on the first frame
+        const BYTE* background = ecgfx::GetPaletteColour( 0 );
+
+        glClearColor( background[ 0 ] / 255.0f, background[ 1 ] / 255.0f,
+                      background[ 2 ] / 255.0f, 1.0f );
+        glClear( GL_COLOR_BUFFER_BIT );
+    }
+
+    glBindFramebuffer_( GL_FRAMEBUFFER, 0 );
+    glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
+
+    // The uniforms never change, they are set once per program
+    const BYTE* background = ecgfx::GetPaletteColour( 0 );
+
+    glUseProgram_( m_PersistProgram );
+    glUniform1i_( glGetUniformLocation_( m_PersistProgram, "display" ), UNIT_DISPLAY );
+    glUniform1i_( glGetUniformLocation_( m_PersistProgram, "history" ), UNIT_HISTORY );
+    glUniform3f_( glGetUniformLocation_( m_PersistProgram, "background" ),
+                  background[ 0 ] / 255.0f, background[ 1 ] / 255.0f, background[ 2 ] / 255.0f );
+    glUniform1f_( glGetUniformLocation_( m_PersistProgram, "persistence" ), m_Config.persistence );
+
+    glUseProgram_( m_ScaleProgram );
+    glUniform1i_( glGetUniformLocation_( m_ScaleProgram, "history" ), UNIT_HISTORY );
+
+    glDisable( GL_DEPTH_TEST );
+    glDisable( GL_BLEND );
+
+    return glGetError( ) == GL_NO_ERROR;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipGLPresenter::Present( const EightChipCPU& cpu )
+{
+    static BYTE pixels[ DISPLAY_HEIGHT * DISPLAY_WIDTH * 4 ];
+
+    ecgfx::ExpandPalette( cpu, 1, pixels, DISPLAY_WIDTH * 4 );
+
+    glActiveTexture_( GL_TEXTURE0 + UNIT_DISPLAY );
+    glBindTexture( GL_TEXTURE_2D, m_Texture );
+    glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, GL_RGBA,
+                     GL_UNSIGNED_BYTE, pixels );
+
+    // Blend the new frame with the previous one, at the native size
+    int previous = m_Current;
+    m_Current ^= 1;
+
+    glActiveTexture_( GL_TEXTURE0 + UNIT_HISTORY );
+    glBindTexture( GL_TEXTURE_2D, m_History[ previous ] );
+    glBindFramebuffer_( GL_FRAMEBUFFER, m_Framebuffers[ m_Current ] );
+    glViewport( 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT );
+    glUseProgram_( m_PersistProgram );
+    glDrawArrays( GL_TRIANGLES, 0, 3 );
+
+    // Scale the result to the window, the drawable is in pixels, larger than the window's size
+    // on high density screens
+    int width, height;
+    SDL_GL_GetDrawableSize( m_Window, &width, &height );
+
+    SDL_Rect area = ecgfx::FitDisplay( width, height, m_Config.integerScaling );
+
+    glBindTexture( GL_TEXTURE_2D, m_History[ m_Current ] );
+    glBindFramebuffer_( GL_FRAMEBUFFER, 0 );
+    glClear( GL_COLOR_BUFFER_BIT );
+    glViewport( area.x, area.y, area.w, area.h );
+    glUseProgram_( m_ScaleProgram );
+    glDrawArrays( GL_TRIANGLES, 0, 3 );
+
+    SDL_GL_SwapWindow( m_Window );
+}
+
+//-------------------------------------------------------------------------------------------------
+const char*
+EightChipGLPresenter::GetName( ) const
+{
+    return "opengl";
+}
+
+//-------------------------------------------------------------------------------------------------
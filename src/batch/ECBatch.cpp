@@ -0,0 +1,446 @@
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ECCoverage.h"
+#include "ECCpu.h"
+#include "ECDisplay.h"
+#include "ECQuirks.h"
+#include "ECRom.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * eight_chip_batch: runs roms headless, in parallel, and reports on each of them as JSON.
+ *
+ * usage: eight_chip_batch ROMFILE... [--batch DIR] [--frames N] [--opcodes-per-frame N]
+ *                         [--threads N] [--seed N] [--output FILE]
+ *                         [--profile eightchip|chip8|schip|xochip] [--coverage DIR]
+ *
+ * --batch adds every file of the directory. A rom runs for --frames frames unless it halts
+ * first: it exits (00FD), jumps to itself (1NNN at NNN) or raises a stack underflow or an illegal
+ * opcode. Halts are checked after each frame, so the instructions of the frame a rom halts in are
+ * counted. Each rom gets its profile from its extension unless --profile is given.
+ *
+ * --coverage runs the roms on the coverage interpreter: the report gives how many addresses each
+ * rom executed, read and wrote, and which share of the rom was executed. The bitmaps are merged
+ * into DIR/ROMNAME.cov, so they add up over runs with other seeds and frame counts.
+ */
+namespace
+{
+    const int HALT_FAULTS = FAULT_STACK_UNDERFLOW | FAULT_ILLEGAL_OPCODE;
+
+    struct RunOptions
+    {
+        std::vector< std::string > roms;
+        int frames = 3600;
+        int opcodesPerFrame = 10;
+        int threads = 0;
+        unsigned int seed = 0;
+        std::string output;
+        std::string coverage;
+        bool hasProfile = false;
+        EightChipProfile profile = PROFILE_EIGHTCHIP;
+    };
+
+    struct RunResult
+    {
+        std::string rom;
+        EightChipProfile profile = PROFILE_EIGHTCHIP;
+        bool loaded = false;
+
+        unsigned long long instructions = 0;
+        int frames = 0;
+        double milliseconds = 0.0;
+
+        // "frames" when it ran them all
+        const char* halt = "frames";
+        WORD programCounter = 0;
+        int faults = FAULT_NONE;
+        QWORD framebuffer = 0;
+
+        // With --coverage only
+        bool covered = false;
+        bool coverageSaved = false;
+        int romSize = 0;
+        int executed = 0;
+        int executedRom = 0;
+        int read = 0;
+        int written = 0;
+    };
+
+    //---------------------------------------------------------------------------------------------
+    /** Regular files only, sorted so the report comes out in the same order every time. */
+    bool
+    ListDirectory( const std::string& directory, std::vector< std::string >& files )
+    {
+        DIR* dir = opendir( directory.c_str( ) );
+
+        if ( dir == nullptr )
+            return false;
+
+        std::vector< std::string > found;
+
+        while ( dirent* entry = readdir( dir ) )
+        {
+            if ( entry->d_name[ 0 ] == '.' )
+                continue;
+
+            std::string path = directory + "/" + entry->d_name;
+            struct stat info;
+
+            if ( stat( path.c_str( ), &info ) == 0 && S_ISREG( info.st_mode ) )
+                found.push_back( path );
+        }
+
+        closedir( dir );
+
+        std::sort( found.begin( ), found.end( ) );
+        files.insert( files.end( ), found.begin( ), found.end( ) );
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    bool
+    ParseArguments( int argc, char* argv[ ], RunOptions& options )
+    {
+        for ( int i = 1; i < argc; i++ )
+        {
+            bool hasValue = i + 1 < argc;
+
+            if ( strcmp( argv[ i ], "--batch" ) == 0 && hasValue )
+            {
+                if ( !ListDirectory( argv[ ++i ], options.roms ) )
+                {
+                    fprintf( stderr, "%s: can't read the directory\n", argv[ i ] );
+                    return false;
+                }
+            }
+            else if ( strcmp( argv[ i ], "--frames" ) == 0 && hasValue )
+                options.frames = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--opcodes-per-frame" ) == 0 && hasValue )
+                options.opcodesPerFrame = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--threads" ) == 0 && hasValue )
+                options.threads = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--seed" ) == 0 && hasValue )
+                options.seed = static_cast< unsigned int >( strtoul( argv[ ++i ], nullptr, 0 ) );
+            else if ( strcmp( argv[ i ], "--output" ) == 0 && hasValue )
+                options.output = argv[ ++i ];
+            else if ( strcmp( argv[ i ], "--coverage" ) == 0 && hasValue )
+                options.coverage = argv[ ++i ];
+            else if ( strcmp( argv[ i ], "--profile" ) == 0 && hasValue )
+            {
+                if ( !ecquirks::ProfileFromName( argv[ ++i ], options.profile ) )
+                    return false;
+
+                options.hasProfile = true;
+            }
+            else if ( argv[ i ][ 0 ] != '-' )
+                options.roms.push_back( argv[ i ] );
+            else
+                return false;
+        }
+
+        return !options.roms.empty( );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    // A jump to itself never goes anywhere else, nothing but a reset gets the rom out of it
+    bool
+    IsSelfJump( const EightChipState& state )
+    {
+        WORD pc = state.m_ProgramCounter & ( ROMSIZE - 1 );
+        WORD opcode = ( state.m_GameMemory[ pc ] << 8 )
+                      | state.m_GameMemory[ ( pc + 1 ) & ( ROMSIZE - 1 ) ];
+
+        return ( opcode & 0xF000 ) == 0x1000 && ( opcode & 0x0FFF ) == pc;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    void
+    RunRom( const RunOptions& options, RunResult& result )
+    {
+        auto start = std::chrono::steady_clock::now( );
+
+        std::unique_ptr< EightChipCPU > cpu( new EightChipCPU( ) );
+        cpu->SetProfile( result.profile );
+
+        // Read here rather than by InitRom( ), the coverage report needs the rom's size
+        std::vector< BYTE > rom;
+        result.loaded = ecrom::ReadFile( result.rom, rom );
+
+        if ( rom.size( ) > ROMSIZE - 0x200 )
+            rom.resize( ROMSIZE - 0x200 );
+
+        result.loaded = result.loaded && cpu->InitRom( rom.data( ), rom.size( ) );
+
+        if ( !result.loaded )
+            return;
+
+        std::unique_ptr< EightChipCoverage > coverage;
+
+        if ( !options.coverage.empty( ) )
+        {
+            coverage.reset( new EightChipCoverage( ) );
+            cpu->SetCoverage( coverage.get( ) );
+        }
+
+        if ( options.seed != 0 )
+            cpu->SetRandomSeed( options.seed );
+
+        while ( result.frames < options.frames )
+        {
+            cpu->DecreaseTimers( );
+            cpu->ExecuteOpCodes( options.opcodesPerFrame );
+
+            result.instructions += options.opcodesPerFrame;
+            result.frames++;
+
+            if ( cpu->IsHalted( ) )
+                result.halt = "exit";
+            else if ( cpu->GetFaults( ) & FAULT_STACK_UNDERFLOW )
+                result.halt = "stack underflow";
+            else if ( cpu->GetFaults( ) & FAULT_ILLEGAL_OPCODE )
+                result.halt = "illegal opcode";
+            else if ( IsSelfJump( cpu->GetState( ) ) )
+                result.halt = "self jump";
+            else
+                continue;
+
+            break;
+        }
+
+        result.programCounter = cpu->GetProgramCounter( );
+        result.faults = cpu->GetFaults( );
+        result.framebuffer = ecdisplay::Hash( cpu->GetState( ).m_Display );
+
+        if ( coverage )
+        {
+            result.covered = true;
+            result.romSize = static_cast< int >( rom.size( ) );
+            result.executed = coverage->Count( COVERAGE_EXECUTED );
+            result.executedRom =
+                coverage->Count( COVERAGE_EXECUTED, 0x200, 0x200 + result.romSize );
+            result.read = coverage->Count( COVERAGE_READ );
+            result.written = coverage->Count( COVERAGE_WRITTEN );
+            result.coverageSaved = coverage->MergeInto( options.coverage + "/"
+                                                        + ecrom::BaseName( result.rom ) + ".cov" );
+        }
+
+        std::chrono::duration< double, std::milli > elapsed =
+            std::chrono::steady_clock::now( ) - start;
+        result.milliseconds = elapsed.count( );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    std::string
+    JsonString( const std::string& text )
+    {
+        std::string res = "\"";
+
+        for ( char c : text )
+        {
+            if ( c == '"' || c == '\\' )
+            {
+                res += '\\';
+                res += c;
+            }
+            else if ( static_cast< unsigned char >( c ) < 0x20 )
+            {
+                char escaped[ 8 ];
+                snprintf( escaped, sizeof( escaped ), "\\u%04x", c );
+                res += escaped;
+            }
+            else
+                res += c;
+        }
+
+        return res + "\"";
+    }
+
+    //---------------------------------------------------------------------------------------------
+    void
+    WriteFaults( FILE* out, int faults )
+    {
+        static const struct
+        {
+            int fault;
+            const char* name;
+        } FAULT_NAMES[] = {
+            { FAULT_STACK_UNDERFLOW, "stack underflow" },
+            { FAULT_STACK_OVERFLOW, "stack overflow" },
+            { FAULT_MEMORY_BOUNDS, "memory bounds" },
+            { FAULT_ILLEGAL_OPCODE, "illegal opcode" },
+        };
+
+        const char* separator = "";
+
+        fprintf( out, "[" );
+
+        for ( const auto& it : FAULT_NAMES )
+        {
+            if ( faults & it.fault )
+            {
+                fprintf( out, "%s\"%s\"", separator, it.name );
+                separator = ", ";
+            }
+        }
+
+        fprintf( out, "]" );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    void
+    WriteReport( FILE* out,
+                 const RunOptions& options,
+                 const std::vector< RunResult >& results,
+                 int threads,
+                 double milliseconds )
+    {
+        unsigned long long total = 0;
+
+        for ( const RunResult& result : results )
+            total += result.instructions;
+
+        fprintf( out, "{\n" );
+        fprintf( out, "  \"frames\": %d,\n", options.frames );
+        fprintf( out, "  \"opcodes_per_frame\": %d,\n", options.opcodesPerFrame );
+        fprintf( out, "  \"threads\": %d,\n", threads );
+        fprintf( out, "  \"wall_ms\": %.3f,\n", milliseconds );
+        fprintf( out, "  \"instructions\": %llu,\n", total );
+        fprintf( out,
+                 "  \"instructions_per_second\": %.0f,\n",
+                 ( milliseconds > 0.0 ) ? total * 1000.0 / milliseconds : 0.0 );
+        fprintf( out, "  \"roms\": [" );
+
+        for ( size_t i = 0; i < results.size( ); i++ )
+        {
+            const RunResult& result = results[ i ];
+
+            fprintf( out,
+                     "%s\n    {\"rom\": %s, \"profile\": \"%s\"",
+                     ( i > 0 ) ? "," : "",
+                     JsonString( result.rom ).c_str( ),
+                     ecquirks::GetProfileName( result.profile ) );
+
+            if ( !result.loaded )
+            {
+                fprintf( out, ", \"error\": \"%s\"}", ERR03 );
+                continue;
+            }
+
+            fprintf( out,
+                     ", \"instructions\": %llu, \"frames\": %d, \"wall_ms\": %.3f, "
+                     "\"halt\": \"%s\", \"pc\": \"0x%04X\", \"faults\": ",
+                     result.instructions, result.frames, result.milliseconds, result.halt,
+                     result.programCounter );
+
+            WriteFaults( out, result.faults );
+
+            fprintf( out, ", \"framebuffer\": \"%016llx\"", result.framebuffer );
+
+            // Instructions take two bytes, a rom fully executed covers about half of its addresses
+            if ( result.covered )
+            {
+                fprintf( out,
+                         ", \"coverage\": {\"executed\": %d, \"read\": %d, \"written\": %d, "
+                         "\"rom_executed\": %.4f, \"saved\": %s}",
+                         result.executed, result.read, result.written,
+                         ( result.romSize > 0 )
+                             ? static_cast< double >( result.executedRom ) / result.romSize
+                             : 0.0,
+                         result.coverageSaved ? "true" : "false" );
+            }
+
+            fprintf( out, "}" );
+        }
+
+        fprintf( out, "\n  ]\n}\n" );
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+int
+main( int argc, char* argv[ ] )
+{
+    RunOptions options;
+
+    if ( !ParseArguments( argc, argv, options ) )
+    {
+        fprintf( stderr,
+                 "usage: %s ROMFILE... [--batch DIR] [--frames N] [--opcodes-per-frame N]\n"
+                 "       [--threads N] [--seed N] [--output FILE]\n"
+                 "       [--profile eightchip|chip8|schip|xochip] [--coverage DIR]\n",
+                 argv[ 0 ] );
+        return 1;
+    }
+
+    std::vector< RunResult > results( options.roms.size( ) );
+
+    for ( size_t i = 0; i < results.size( ); i++ )
+    {
+        RunResult& result = results[ i ];
+
+        result.rom = options.roms[ i ];
+        result.profile = options.hasProfile ? options.profile
+                                            : ecquirks::ProfileFromRomFile( result.rom );
+    }
+
+    int threads = options.threads;
+
+    if ( threads <= 0 )
+        threads = std::max( 1, static_cast< int >( std::thread::hardware_concurrency( ) ) );
+
+    threads = std::min( threads, static_cast< int >( results.size( ) ) );
+
+    // Each worker takes the next rom nobody took yet
+    std::atomic< size_t > next( 0 );
+    std::vector< std::thread > workers;
+
+    auto start = std::chrono::steady_clock::now( );
+
+    for ( int i = 0; i < threads; i++ )
+    {
+        workers.emplace_back( [ & ]( ) {
+            for ( size_t rom = next++; rom < results.size( ); rom = next++ )
+                RunRom( options, results[ rom ] );
+        } );
+    }
+
+    for ( std::thread& worker : workers )
+        worker.join( );
+
+    std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now( ) - start;
+
+    FILE* out = stdout;
+
+    if ( !options.output.empty( ) )
+    {
+        out = fopen( options.output.c_str( ), "w" );
+
+        if ( out == nullptr )
+        {
+            fprintf( stderr, "%s: can't write the report\n", options.output.c_str( ) );
+            return 1;
+        }
+    }
+
+    WriteReport( out, options, results, threads, elapsed.count( ) );
+
+    if ( out != stdout )
+        fclose( out );
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
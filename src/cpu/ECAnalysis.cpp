@@ -0,0 +1,424 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "ECAnalysis.h"
+
+//-------------------------------------------------------------------------------------------------
+/** Fetches the opcode at an address of the rom image, false when it's outside of the rom. */
+static bool
+FetchOpCode( const EightChipAnalysis& analysis, int address, WORD& opcode )
+{
+    int offset = address - 0x200;
+
+    if ( offset < 0 || offset + 1 >= static_cast< int >( analysis.rom.size( ) ) )
+        return false;
+
+    opcode = ( analysis.rom[ offset ] << 8 ) | analysis.rom[ offset + 1 ];
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Size of the instruction at an address, 2 when outside of the rom. */
+static int
+GetLength( const EightChipAnalysis& analysis, int address )
+{
+    WORD opcode;
+
+    if ( !FetchOpCode( analysis, address, opcode ) )
+        return 2;
+
+    return ecops::GetLength( opcode, analysis.profile );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Where a skip lands when taken: past the next instruction, which can be a long one. */
+static int
+GetSkipTarget( const EightChipAnalysis& analysis, int address )
+{
+    return address + 2 + GetLength( analysis, address + 2 );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Does an instruction end a basic block. */
+static bool
+IsTerminator( EightChipOpcodeId id )
+{
+    const int flow = OPF_JUMP | OPF_CALL | OPF_RETURN | OPF_SKIP | OPF_COMPUTED_JUMP | OPF_EXIT;
+
+    return id == OP_INVALID || ( ecops::GetInfo( id ).flags & flow ) != 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Walks every path from 0x200, following jumps, calls and both sides of skips. Computed jumps
+ * (BNNN) and illegal opcodes end a path: whatever they lead to is left as data.
+ */
+static void
+FindInstructions( EightChipAnalysis& res, std::set< WORD >& leaders, std::set< WORD >& entries )
+{
+    std::vector< WORD > worklist;
+
+    worklist.push_back( 0x200 );
+    leaders.insert( 0x200 );
+    entries.insert( 0x200 );
+
+    while ( !worklist.empty( ) )
+    {
+        int address = worklist.back( );
+        worklist.pop_back( );
+
+        WORD opcode;
+
+        while ( FetchOpCode( res, address, opcode ) && res.codeMap[ address ] != CODE_INSTRUCTION )
+        {
+            EightChipOpcodeId id = ecops::Identify( opcode, res.profile );
+            int flags = ecops::GetInfo( id ).flags;
+            int length = ecops::GetLength( opcode, res.profile );
+            WORD target = opcode & 0x0FFF;
+
+            res.codeMap[ address ] = CODE_INSTRUCTION;
+            for ( int i = 1; i < length && address + i < ROMSIZE; i++ )
+                res.codeMap[ address + i ] = CODE_OPERAND;
+
+            // F000 NNNN loads the word that follows it
+            if ( flags & OPF_LONG )
+                FetchOpCode( res, address + 2, target );
+
+            if ( flags & OPF_SETS_I )
+                res.dataReferences.insert( target );
+
+            if ( flags & OPF_COMPUTED_JUMP )
+                res.computedJumps.push_back( address );
+
+            if ( flags & ( OPF_JUMP | OPF_CALL ) )
+            {
+                leaders.insert( target );
+                worklist.push_back( target );
+
+                if ( flags & OPF_CALL )
+                    entries.insert( target );
+            }
+
+            if ( flags & ( OPF_CALL | OPF_SKIP ) )
+            {
+                leaders.insert( address + 2 );
+                worklist.push_back( address + 2 );
+            }
+
+            if ( flags & OPF_SKIP )
+            {
+                leaders.insert( GetSkipTarget( res, address ) );
+                worklist.push_back( GetSkipTarget( res, address ) );
+            }
+
+            if ( IsTerminator( id ) )
+                break;
+
+            address += length;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Cuts the instructions into blocks at every leader and after every terminator. */
+static void
+BuildBlocks( EightChipAnalysis& res, const std::set< WORD >& leaders )
+{
+    for ( size_t address = 0; address < res.codeMap.size( ); address++ )
+    {
+        if ( res.codeMap[ address ] != CODE_INSTRUCTION )
+            continue;
+
+        // Only start blocks at leaders and where a previous block stopped
+        if ( ecanalysis::FindBlock( res, address ) != nullptr && leaders.count( address ) == 0 )
+            continue;
+
+        EightChipBlock block;
+        block.start = address;
+        block.length = 0;
+        block.executions = 0;
+        block.instructions = 0;
+
+        int current = address;
+        WORD opcode = 0;
+
+        while ( true )
+        {
+            FetchOpCode( res, current, opcode );
+            block.terminator = ecops::Identify( opcode, res.profile );
+            block.last = current;
+            block.length++;
+
+            int next = current + ecops::GetLength( opcode, res.profile );
+            bool stop = IsTerminator( block.terminator );
+
+            if ( !stop
+                 && ( next >= static_cast< int >( res.codeMap.size( ) )
+                      || res.codeMap[ next ] != CODE_INSTRUCTION || leaders.count( next ) != 0 ) )
+            {
+                // Falls through into another block
+                block.successors.push_back( next );
+                stop = true;
+            }
+
+            current = next;
+
+            if ( stop )
+                break;
+        }
+
+        block.end = current;
+
+        int flags = ecops::GetInfo( block.terminator ).flags;
+
+        if ( flags & OPF_JUMP )
+            block.successors.push_back( opcode & 0x0FFF );
+        if ( flags & ( OPF_CALL | OPF_SKIP ) )
+            block.successors.push_back( block.end );
+        if ( flags & OPF_SKIP )
+            block.successors.push_back( GetSkipTarget( res, block.last ) );
+
+        res.blocks[ block.start ] = block;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Collects the subroutines each entry point calls, without following the calls themselves. */
+static void
+BuildCallGraph( EightChipAnalysis& res, const std::set< WORD >& entries )
+{
+    for ( WORD entry : entries )
+    {
+        std::set< WORD >& callees = res.calls[ entry ];
+        std::set< WORD > visited;
+        std::vector< WORD > worklist( 1, entry );
+
+        while ( !worklist.empty( ) )
+        {
+            WORD address = worklist.back( );
+            worklist.pop_back( );
+
+            auto it = res.blocks.find( address );
+            if ( it == res.blocks.end( ) || !visited.insert( address ).second )
+                continue;
+
+            const EightChipBlock& block = it->second;
+
+            if ( block.terminator == OP_2NNN )
+            {
+                WORD opcode;
+
+                if ( FetchOpCode( res, block.last, opcode ) )
+                    callees.insert( opcode & 0x0FFF );
+            }
+
+            worklist.insert( worklist.end( ), block.successors.begin( ), block.successors.end( ) );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Follows I through each block: ANNN makes it known, FX55/FX65 move it by a known amount unless
+ * the profile leaves it in place, and anything else that changes it loses track. Writes at a
+ * known I landing on code are self-modifying.
+ */
+static void
+FindSelfModifyingWrites( EightChipAnalysis& res )
+{
+    bool incrementsI = ecquirks::LoadStoreIncrementsI( res.profile );
+
+    for ( const auto& it : res.blocks )
+    {
+        const EightChipBlock& block = it.second;
+        bool known = false;
+        int addressI = 0;
+
+        for ( int address = block.start; address < block.end; address += GetLength( res, address ) )
+        {
+            WORD opcode;
+
+            if ( !FetchOpCode( res, address, opcode ) )
+                break;
+
+            EightChipOpcodeId id = ecops::Identify( opcode, res.profile );
+            int flags = ecops::GetInfo( id ).flags;
+            int Vx = ( opcode & 0x0F00 ) >> 8;
+
+            if ( flags & OPF_WRITES_MEMORY )
+            {
+                if ( !known )
+                {
+                    res.unknownWrites.push_back( address );
+                }
+                else
+                {
+                    int Vy = ( opcode & 0x00F0 ) >> 4;
+                    int length = Vx + 1;
+
+                    if ( id == OP_FX33 )
+                        length = 3;
+                    else if ( id == OP_5XY2 )
+                        length = abs( Vy - Vx ) + 1;
+
+                    for ( int i = 0; i < length; i++ )
+                    {
+                        if ( ecanalysis::IsCode( res, addressI + i ) )
+                        {
+                            res.selfModifyingWrites.push_back( address );
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if ( flags & OPF_SETS_I )
+            {
+                WORD target = opcode & 0x0FFF;
+
+                if ( flags & OPF_LONG )
+                    FetchOpCode( res, address + 2, target );
+
+                known = true;
+                addressI = target;
+            }
+            else if ( id == OP_FX55 || id == OP_FX65 )
+            {
+                // SUPER-CHIP leaves I where it was
+                if ( incrementsI )
+                    addressI += Vx + 1;
+            }
+            else if ( flags & OPF_MODIFIES_I )
+            {
+                known = false;
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+static void
+FindDataRegions( EightChipAnalysis& res )
+{
+    int end = 0x200 + static_cast< int >( res.rom.size( ) );
+    int start = -1;
+
+    for ( int address = 0x200; address <= end; address++ )
+    {
+        bool data = address < end && res.codeMap[ address ] == CODE_NONE;
+
+        if ( data && start < 0 )
+            start = address;
+
+        if ( !data && start >= 0 )
+        {
+            res.dataRegions.push_back( std::make_pair( start, address ) );
+            start = -1;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+ecanalysis::Analyse( const BYTE* rom,
+                     size_t size,
+                     EightChipProfile profile,
+                     EightChipAnalysis& res )
+{
+    size = std::min< size_t >( size, ROMSIZE - 0x200 );
+
+    res = EightChipAnalysis( );
+    res.rom.assign( rom, rom + size );
+    res.profile = profile;
+    res.codeMap.assign( ROMSIZE, CODE_NONE );
+
+    std::set< WORD > leaders;
+    std::set< WORD > entries;
+
+    FindInstructions( res, leaders, entries );
+    BuildBlocks( res, leaders );
+    BuildCallGraph( res, entries );
+    FindSelfModifyingWrites( res );
+    FindDataRegions( res );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Counts how often each address is executed, then folds the counts into the blocks. */
+void
+ecanalysis::Profile( int frames,
+                     int opcodes_per_frame,
+                     EightChipProfile profile,
+                     EightChipAnalysis& res )
+{
+    EightChipCPU cpu;
+    cpu.SetProfile( profile );
+    cpu.InitRom( res.rom.data( ), res.rom.size( ) );
+
+    std::vector< unsigned long long > counts( ROMSIZE, 0 );
+
+    for ( int frame = 0; frame < frames; frame++ )
+    {
+        cpu.DecreaseTimers( );
+
+        for ( int i = 0; i < opcodes_per_frame; i++ )
+        {
+            WORD pc = cpu.GetProgramCounter( );
+
+            if ( pc < ROMSIZE )
+                counts[ pc ]++;
+
+            cpu.ExecuteNextOpCode( );
+        }
+
+        if ( cpu.GetFaults( ) & ( FAULT_ILLEGAL_OPCODE | FAULT_MEMORY_BOUNDS ) )
+            break;
+    }
+
+    for ( auto& it : res.blocks )
+    {
+        EightChipBlock& block = it.second;
+        block.executions = counts[ block.start ];
+
+        for ( int address = block.start; address < block.end; address += GetLength( res, address ) )
+            block.instructions += counts[ address ];
+    }
+
+    for ( size_t address = 0; address < counts.size( ); address++ )
+    {
+        if ( counts[ address ] > 0 && res.codeMap[ address ] != CODE_INSTRUCTION )
+            res.unknownExecutions[ address ] = counts[ address ];
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+const EightChipBlock*
+ecanalysis::FindBlock( const EightChipAnalysis& analysis, WORD address )
+{
+    auto it = analysis.blocks.upper_bound( address );
+
+    if ( it == analysis.blocks.begin( ) )
+        return nullptr;
+
+    --it;
+
+    if ( address >= it->second.end )
+        return nullptr;
+
+    return &it->second;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecanalysis::IsInstruction( const EightChipAnalysis& analysis, WORD address )
+{
+    return address < analysis.codeMap.size( ) && analysis.codeMap[ address ] == CODE_INSTRUCTION;
+}
+
+bool
+ecanalysis::IsCode( const EightChipAnalysis& analysis, WORD address )
+{
+    return address < analysis.codeMap.size( ) && analysis.codeMap[ address ] != CODE_NONE;
+}
+
+//-------------------------------------------------------------------------------------------------
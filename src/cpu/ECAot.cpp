@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ECAot.h"
+#include "ECDisplay.h"
+#include "ECLockstep.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipAotRunner::EightChipAotRunner( const EightChipAotProgram& program, EightChipCPU& cpu )
+    : m_Program( program )
+    , m_CPU( cpu )
+    , m_State( cpu )
+    , m_Blocks( ROMSIZE, nullptr )
+    , m_Translated( 0 )
+    , m_Interpreted( 0 )
+{
+    for ( size_t i = 0; i < m_Program.count; i++ )
+        m_Blocks[ m_Program.blocks[ i ].address ] = m_Program.blocks[ i ].block;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipAotRunner::Load( )
+{
+    m_CPU.SetProfile( m_Program.profile );
+
+    return m_CPU.InitRom( m_Program.rom, m_Program.size );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A block that can't run gives way to the interpreter for a single instruction, the next one
+ * may well start a block again.
+ */
+void
+EightChipAotRunner::Run( int count )
+{
+    while ( count > 0 )
+    {
+        EightChipAotBlock block = m_Blocks[ m_State.m_ProgramCounter ];
+        int ran = ( block != nullptr ) ? block( *this, count ) : 0;
+
+        if ( ran > 0 )
+        {
+            m_Translated += ran;
+        }
+        else
+        {
+            m_CPU.ExecuteNextOpCode( );
+            m_Interpreted++;
+            ran = 1;
+        }
+
+        count -= ran;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+unsigned long long
+EightChipAotRunner::GetTranslated( ) const
+{
+    return m_Translated;
+}
+
+unsigned long long
+EightChipAotRunner::GetInterpreted( ) const
+{
+    return m_Interpreted;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipAotRunner::IsIntact( WORD start, WORD end ) const
+{
+    return memcmp( &m_State.m_GameMemory[ start ], &m_Program.rom[ start - 0x200 ], end - start )
+           == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The same as EightChipCPU::SkipNextInstruction, the blocks inline their skips. */
+void
+EightChipAotRunner::SkipNext( )
+{
+    WORD pc = m_State.m_ProgramCounter;
+    bool isLong = ecquirks::HasXoChipOpcodes( m_Program.profile )
+                  && m_State.m_GameMemory[ pc ] == 0xF0
+                  && m_State.m_GameMemory[ ( pc + 1 ) & ( ROMSIZE - 1 ) ] == 0x00;
+
+    m_State.m_ProgramCounter += isLong ? 4 : 2;
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipAotEngine::EightChipAotEngine( const EightChipAotProgram& program )
+    : m_CPU( new EightChipCPU( ) )
+    , m_Runner( program, *m_CPU )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+const char*
+EightChipAotEngine::GetName( ) const
+{
+    return "aot";
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipAotEngine::Load( const BYTE* rom,
+                          size_t size,
+                          EightChipProfile profile,
+                          unsigned int seed )
+{
+    if ( !m_Runner.Load( ) || m_CPU->GetProfile( ) != profile )
+        return false;
+
+    // Anything else would run the blocks on the wrong code
+    size_t compared = std::min< size_t >( size, ROMSIZE - 0x200 );
+
+    if ( memcmp( &m_CPU->GetState( ).m_GameMemory[ 0x200 ], rom, compared ) != 0 )
+        return false;
+
+    if ( seed != 0 )
+        m_CPU->SetRandomSeed( seed );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipAotEngine::Run( int count )
+{
+    m_Runner.Run( count );
+}
+
+void
+EightChipAotEngine::DecreaseTimers( )
+{
+    m_CPU->DecreaseTimers( );
+}
+
+void
+EightChipAotEngine::KeyDown( int key )
+{
+    m_CPU->KeyDown( key );
+}
+
+void
+EightChipAotEngine::KeyUp( int key )
+{
+    m_CPU->KeyUp( key );
+}
+
+//-------------------------------------------------------------------------------------------------
+const EightChipState&
+EightChipAotEngine::GetState( ) const
+{
+    return m_CPU->GetState( );
+}
+
+void
+EightChipAotEngine::SetState( const EightChipState& state )
+{
+    m_CPU->SetState( state );
+}
+
+void
+EightChipAotEngine::TakeWrites( QWORD pages[ MEMORY_PAGES / 64 ], int& planes )
+{
+    m_CPU->TakeWrites( pages, planes );
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+ecaot::Main( const EightChipAotProgram& program, int argc, char* argv[ ] )
+{
+    int frames = 600;
+    int opcodesPerFrame = 1000;
+    unsigned int seed = 0;
+    bool verify = false;
+
+    for ( int i = 1; i < argc; i++ )
+    {
+        bool hasValue = i + 1 < argc;
+
+        if ( strcmp( argv[ i ], "--frames" ) == 0 && hasValue )
+            frames = atoi( argv[ ++i ] );
+        else if ( strcmp( argv[ i ], "--opcodes-per-frame" ) == 0 && hasValue )
+            opcodesPerFrame = atoi( argv[ ++i ] );
+        else if ( strcmp( argv[ i ], "--seed" ) == 0 && hasValue )
+            seed = static_cast< unsigned int >( strtoul( argv[ ++i ], nullptr, 0 ) );
+        else if ( strcmp( argv[ i ], "--verify" ) == 0 )
+            verify = true;
+        else
+        {
+            fprintf( stderr,
+                     "usage: %s [--frames N] [--opcodes-per-frame N] [--seed N] [--verify]\n",
+                     argv[ 0 ] );
+            return 1;
+        }
+    }
+
+    if ( verify )
+    {
+        EightChipInterpreterEngine interpreter( EightChipInterpreterEngine::MODE_BATCH );
+        EightChipAotEngine aot( program );
+
+        EightChipLockstepConfig config;
+        config.profile = program.profile;
+        config.seed = seed;
+        config.frames = frames;
+        config.opcodesPerFrame = opcodesPerFrame;
+        config.block = opcodesPerFrame;
+        config.input = eclockstep::RandomInput( 1, frames );
+
+        EightChipLockstepResult result;
+
+        if ( !eclockstep::Run( interpreter, aot, program.rom, program.size, config, result ) )
+        {
+            printf( "%s: %s\n", program.name, ERR03 );
+            return 1;
+        }
+
+        if ( !result.diverged )
+        {
+            printf( "%s: %llu instructions alike\n", program.name, result.instructions );
+            return 0;
+        }
+
+        printf( "%s: interpreter and aot part after %llu instructions, at 0x%04X\n%s", program.name,
+                result.instructions, result.programCounter, result.diff.c_str( ) );
+        return 2;
+    }
+
+    std::unique_ptr< EightChipCPU > cpu( new EightChipCPU( ) );
+    EightChipAotRunner runner( program, *cpu );
+
+    if ( !runner.Load( ) )
+    {
+        printf( "%s: %s\n", program.name, ERR03 );
+        return 1;
+    }
+
+    if ( seed != 0 )
+        cpu->SetRandomSeed( seed );
+
+    auto start = std::chrono::steady_clock::now( );
+
+    for ( int frame = 0; frame < frames; frame++ )
+    {
+        cpu->DecreaseTimers( );
+        runner.Run( opcodesPerFrame );
+    }
+
+    std::chrono::duration< double > elapsed = std::chrono::steady_clock::now( ) - start;
+    unsigned long long total = runner.GetTranslated( ) + runner.GetInterpreted( );
+
+    printf( "%s: %llu instructions, %.1f%% translated, %.1f Mops/s, pc 0x%04X, "
+            "framebuffer %016llx\n",
+            program.name,
+            total,
+            ( total > 0 ) ? runner.GetTranslated( ) * 100.0 / total : 0.0,
+            ( elapsed.count( ) > 0.0 ) ? total / elapsed.count( ) / 1e6 : 0.0,
+            cpu->GetProgramCounter( ),
+            ecdisplay::Hash( cpu->GetState( ).m_Display ) );
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,93 @@
+#include <cmath>
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#define EIGHTCHIP_SSE2
+#endif
+
+#include "ECAudio.h"
+
+//-------------------------------------------------------------------------------------------------
+double
+ecaudio::GetPlaybackRate( BYTE pitch )
+{
+    return 4000.0 * pow( 2.0, ( pitch - 64 ) / 48.0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * The pattern is first expanded into one level per bit, then every output sample picks the level
+ * of the bit its phase falls in. The loop has no branch and no dependency between samples other
+ * than the phase, which is computed from the sample index.
+ */
+void
+ecaudio::RenderPattern( const BYTE pattern[ AUDIO_PATTERN_SIZE ],
+                        BYTE pitch,
+                        int sample_rate,
+                        short amplitude,
+                        AUDIO_PHASE& phase,
+                        short* out,
+                        int count )
+{
+    short levels[ AUDIO_PATTERN_SIZE * 8 ];
+
+    for ( int bit = 0; bit < AUDIO_PATTERN_SIZE * 8; bit++ )
+    {
+        bool set = ( pattern[ bit >> 3 ] >> ( 7 - ( bit & 7 ) ) ) & 1;
+        levels[ bit ] = set ? amplitude : -amplitude;
+    }
+
+    // Phase increment per output sample, in 1/2^25 of a bit
+    AUDIO_PHASE step =
+        static_cast< AUDIO_PHASE >( GetPlaybackRate( pitch ) / sample_rate * ( 1 << 25 ) );
+    AUDIO_PHASE start = phase;
+
+    for ( int i = 0; i < count; i++ )
+        out[ i ] = levels[ ( start + step * static_cast< AUDIO_PHASE >( i ) ) >> 25 ];
+
+    phase = start + step * static_cast< AUDIO_PHASE >( count );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** With SSE2, 8 samples at a time: a fixed point multiply then a saturating add. The products are
+ * widened to 32 bits before the shift, so the SIMD and the scalar samples agree bit for bit.
+ */
+void
+ecaudio::Mix( const short* source, short volume, short* out, int count )
+{
+    int i = 0;
+
+#ifdef EIGHTCHIP_SSE2
+    const __m128i gain = _mm_set1_epi16( volume );
+
+    for ( ; i + 8 <= count; i += 8 )
+    {
+        __m128i samples = _mm_loadu_si128( reinterpret_cast< const __m128i* >( source + i ) );
+        __m128i mixed = _mm_loadu_si128( reinterpret_cast< const __m128i* >( out + i ) );
+
+        // ( sample * volume ) >> 15, the low and high halves of the products interleaved
+        __m128i low = _mm_mullo_epi16( samples, gain );
+        __m128i high = _mm_mulhi_epi16( samples, gain );
+        __m128i first = _mm_srai_epi32( _mm_unpacklo_epi16( low, high ), 15 );
+        __m128i second = _mm_srai_epi32( _mm_unpackhi_epi16( low, high ), 15 );
+
+        mixed = _mm_adds_epi16( mixed, _mm_packs_epi32( first, second ) );
+
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( out + i ), mixed );
+    }
+#endif
+
+    for ( ; i < count; i++ )
+    {
+        int mixed = out[ i ] + ( ( source[ i ] * volume ) >> 15 );
+
+        if ( mixed > 32767 )
+            mixed = 32767;
+        if ( mixed < -32768 )
+            mixed = -32768;
+
+        out[ i ] = static_cast< short >( mixed );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
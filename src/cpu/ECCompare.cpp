@@ -0,0 +1,26 @@
+#include "ECCompare.h"
+
+//-------------------------------------------------------------------------------------------------
+bool
+eccompare::Holds( int value, EightChipCompare compare, int constant )
+{
+    switch ( compare )
+    {
+    case COMPARE_EQUAL:
+        return value == constant;
+    case COMPARE_NOT_EQUAL:
+        return value != constant;
+    case COMPARE_LESS:
+        return value < constant;
+    case COMPARE_LESS_EQUAL:
+        return value <= constant;
+    case COMPARE_GREATER:
+        return value > constant;
+    case COMPARE_GREATER_EQUAL:
+        return value >= constant;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
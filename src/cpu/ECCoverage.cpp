@@ -0,0 +1,137 @@
+#include <cstdio>
+#include <cstring>
+
+#include "ECCoverage.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipCoverage::EightChipCoverage( )
+{
+    Clear( );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipCoverage::Clear( )
+{
+    memset( m_Bits, 0, sizeof( m_Bits ) );
+    m_Runs = 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipCoverage::Merge( const EightChipCoverage& other )
+{
+    for ( int kind = 0; kind < COVERAGE_KINDS; kind++ )
+    {
+        for ( int i = 0; i < ROMSIZE / 64; i++ )
+            m_Bits[ kind ][ i ] |= other.m_Bits[ kind ][ i ];
+    }
+
+    m_Runs += other.m_Runs;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipCoverage::Save( const std::string& filename ) const
+{
+    EightChipCoverageHeader header;
+    header.magic = COVERAGE_MAGIC;
+    header.version = COVERAGE_VERSION;
+    header.runs = m_Runs;
+
+    FILE* file = fopen( filename.c_str( ), "wb" );
+
+    if ( file == nullptr )
+        return false;
+
+    bool written = fwrite( &header, sizeof( header ), 1, file ) == 1
+                   && fwrite( m_Bits, sizeof( m_Bits ), 1, file ) == 1;
+
+    return ( fclose( file ) == 0 ) && written;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Left cleared when the file can't be read or isn't a coverage file. */
+bool
+EightChipCoverage::Load( const std::string& filename )
+{
+    Clear( );
+
+    FILE* file = fopen( filename.c_str( ), "rb" );
+
+    if ( file == nullptr )
+        return false;
+
+    EightChipCoverageHeader header;
+
+    bool read = fread( &header, sizeof( header ), 1, file ) == 1
+                && header.magic == COVERAGE_MAGIC && header.version == COVERAGE_VERSION
+                && fread( m_Bits, sizeof( m_Bits ), 1, file ) == 1;
+
+    fclose( file );
+
+    if ( !read )
+    {
+        Clear( );
+        return false;
+    }
+
+    m_Runs = header.runs;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A file that doesn't exist yet starts empty, one that isn't a coverage file is refused. */
+bool
+EightChipCoverage::MergeInto( const std::string& filename ) const
+{
+    EightChipCoverage merged;
+
+    if ( !merged.Load( filename ) )
+    {
+        FILE* file = fopen( filename.c_str( ), "rb" );
+
+        if ( file != nullptr )
+        {
+            fclose( file );
+            return false;
+        }
+
+        merged = *this;
+    }
+    else
+    {
+        merged.Merge( *this );
+    }
+
+    return merged.Save( filename );
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipCoverage::IsCovered( EightChipCoverageKind kind, WORD address ) const
+{
+    return ( m_Bits[ kind ][ address / 64 ] >> ( address % 64 ) ) & 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+EightChipCoverage::Count( EightChipCoverageKind kind, int start, int end ) const
+{
+    int count = 0;
+
+    for ( int address = start; address < end; address++ )
+        count += IsCovered( kind, static_cast< WORD >( address ) );
+
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+unsigned long long
+EightChipCoverage::GetRuns( ) const
+{
+    return m_Runs;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -1,8 +1,78 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "ECCoverage.h"
 #include "ECCpu.h"
+#include "ECDebugger.h"
+#include "ECRom.h"
+#include "ECRomImage.h"
+#include "ECSnapshot.h"
+#include "ECTiming.h"
+#include "ECTrace.h"
 
 //-------------------------------------------------------------------------------------------------
 EightChipCPU* EightChipCPU::m_Instance = nullptr;
 
+//-------------------------------------------------------------------------------------------------
+// 4x5 hexadecimal digits, drawn by pointing I at them with FX29
+static const BYTE FONT[ 16 * 5 ] = {
+    0xF0, 0x90, 0x90, 0x90, 0xF0,  // 0
+    0x20, 0x60, 0x20, 0x20, 0x70,  // 1
+    0xF0, 0x10, 0xF0, 0x80, 0xF0,  // 2
+    0xF0, 0x10, 0xF0, 0x10, 0xF0,  // 3
+    0x90, 0x90, 0xF0, 0x10, 0x10,  // 4
+    0xF0, 0x80, 0xF0, 0x10, 0xF0,  // 5
+    0xF0, 0x80, 0xF0, 0x90, 0xF0,  // 6
+    0xF0, 0x10, 0x20, 0x40, 0x40,  // 7
+    0xF0, 0x90, 0xF0, 0x90, 0xF0,  // 8
+    0xF0, 0x90, 0xF0, 0x10, 0xF0,  // 9
+    0xF0, 0x90, 0xF0, 0x90, 0x90,  // A
+    0xE0, 0x90, 0xE0, 0x90, 0xE0,  // B
+    0xF0, 0x80, 0x80, 0x80, 0xF0,  // C
+    0xE0, 0x90, 0x90, 0x90, 0xE0,  // D
+    0xF0, 0x80, 0xF0, 0x80, 0xF0,  // E
+    0xF0, 0x80, 0xF0, 0x80, 0x80,  // F
+};
+
+//-------------------------------------------------------------------------------------------------
+// SUPER-CHIP 8x10 hexadecimal digits, drawn by pointing I at them with FX30
+static const BYTE BIG_FONT[ 16 * 10 ] = {
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF,  // 0
+    0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF,  // 1
+    0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,  // 2
+    0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,  // 3
+    0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03,  // 4
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,  // 5
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,  // 6
+    0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18,  // 7
+    0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,  // 8
+    0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,  // 9
+    0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3,  // A
+    0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC,  // B
+    0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C,  // C
+    0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC,  // D
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,  // E
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0,  // F
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Spreads the 8 bits of a byte over 16 bits, each bit doubled: a low resolution sprite row. */
+static QWORD
+DoubleBits( BYTE bits )
+{
+    QWORD res = 0;
+
+    for ( int i = 0; i < 8; i++ )
+    {
+        if ( bits & ( 1 << i ) )
+            res |= 3ULL << ( 2 * i );
+    }
+
+    return res;
+}
+
 //-------------------------------------------------------------------------------------------------
 EightChipCPU*
 EightChipCPU::GetInstance( )
@@ -15,7 +85,17 @@ EightChipCPU::GetInstance( )
 
 //-------------------------------------------------------------------------------------------------
 EightChipCPU::EightChipCPU( )
+    : m_Hooks( HOOKS_NONE )
+    , m_Debugger( nullptr )
+    , m_Tracer( nullptr )
+    , m_Coverage( nullptr )
 {
+    m_Faults = FAULT_NONE;
+    m_RandomState = 0x2545F491;
+
+    SetProfile( PROFILE_EIGHTCHIP );
+    CPUReset( );
+    OpCode00E0( );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -23,10 +103,56 @@ EightChipCPU::~EightChipCPU( )
 {
 }
 
+//-------------------------------------------------------------------------------------------------
+/** Over-allocates, and keeps the address malloc returned right before the aligned block. */
+void*
+EightChipCPU::operator new( size_t size )
+{
+    const size_t alignment = alignof( EightChipCPU );
+
+    BYTE* raw = static_cast< BYTE* >( malloc( size + alignment + sizeof( void* ) ) );
+
+    if ( raw == nullptr )
+        throw std::bad_alloc( );
+
+    uintptr_t aligned = reinterpret_cast< uintptr_t >( raw + sizeof( void* ) );
+    aligned = ( aligned + alignment - 1 ) & ~static_cast< uintptr_t >( alignment - 1 );
+
+    reinterpret_cast< void** >( aligned )[ -1 ] = raw;
+
+    return reinterpret_cast< void* >( aligned );
+}
+
+void
+EightChipCPU::operator delete( void* ptr )
+{
+    if ( ptr != nullptr )
+        free( static_cast< void** >( ptr )[ -1 ] );
+}
+
 //-------------------------------------------------------------------------------------------------
 /** Initializes the Rom into memory to be loaded. */
 bool
 EightChipCPU::InitRom( const std::string& rom_filename )
+{
+    // Load the game
+    std::vector< BYTE > rom;
+
+    // Check if the rom exists
+    if ( !ecrom::ReadFile( rom_filename, rom ) )
+        return false;
+
+    // Anything that wouldn't fit past 0x200 is ignored
+    if ( rom.size( ) > ROMSIZE - 0x200 )
+        rom.resize( ROMSIZE - 0x200 );
+
+    return InitRom( rom.data( ), rom.size( ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Initializes an in-memory Rom image. */
+bool
+EightChipCPU::InitRom( const BYTE* rom, size_t size )
 {
     // Reset CPU
     CPUReset( );
@@ -34,21 +160,285 @@ EightChipCPU::InitRom( const std::string& rom_filename )
     // CLS: Clear screen
     OpCode00E0( );
 
-    // Load the game
-    FILE* rom;
-    rom = fopen( rom_filename.c_str( ), "rb" );
+    // Copies the rom starting 0x200
+    return PatchMemory( 0x200, rom, size );
+}
 
-    // Check if the rom exists
-    if ( rom == NULL )
+//-------------------------------------------------------------------------------------------------
+/** Copies a block of bytes into the game memory, refuses blocks that don't fit. */
+bool
+EightChipCPU::PatchMemory( WORD address, const BYTE* data, size_t size )
+{
+    if ( address + size > sizeof( m_GameMemory ) )
         return false;
 
-    // Reads the rom starting 0x200
-    fread( &m_GameMemory[ 0x200 ], ROMSIZE, 1, rom );
-    fclose( rom );
+    if ( size == 0 )
+        return true;
+
+    memcpy( &m_GameMemory[ address ], data, size );
+    MarkDirty( address, size );
 
     return true;
 }
 
+//-------------------------------------------------------------------------------------------------
+/** The rest of the memory still holds the image, the state around it is small. */
+void
+EightChipCPU::IncrementalReset( const std::shared_ptr< const EightChipRomImage >& image )
+{
+    const EightChipState& state = image->GetState( );
+
+    if ( m_Image != image )
+    {
+        SetState( state );
+        m_Image = image;
+    }
+    else
+    {
+        memcpy( static_cast< EightChipState* >( this ),
+                &state,
+                offsetof( EightChipState, m_GameMemory ) );
+        memcpy( m_Display, state.m_Display, sizeof( m_Display ) );
+
+        for ( int word = 0; word < MEMORY_PAGES / 64; word++ )
+        {
+            QWORD pages = m_DirtyPages[ word ];
+
+            for ( int page = word * 64; pages != 0; page++, pages >>= 1 )
+            {
+                if ( pages & 1 )
+                {
+                    int address = page * MEMORY_PAGE_SIZE;
+                    memcpy( &m_GameMemory[ address ],
+                            &state.m_GameMemory[ address ],
+                            MEMORY_PAGE_SIZE );
+                }
+            }
+        }
+    }
+
+    memset( m_DirtyPages, 0, sizeof( m_DirtyPages ) );
+    MarkAllWritten( );
+
+    SetProfile( image->GetProfile( ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+EightChipCPU::GetFaults( ) const
+{
+    return m_Faults;
+}
+
+void
+EightChipCPU::ClearFaults( )
+{
+    m_Faults = FAULT_NONE;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipCPU::SetRandomSeed( unsigned int seed )
+{
+    // xorshift gets stuck on a zero state
+    m_RandomState = ( seed != 0 ) ? seed : 0x2545F491;
+}
+
+//-------------------------------------------------------------------------------------------------
+const EightChipState&
+EightChipCPU::GetState( ) const
+{
+    return *this;
+}
+
+/** The state is plain data, restoring it is a single copy. The memory no longer holds a known
+ * image though.
+ */
+void
+EightChipCPU::SetState( const EightChipState& state )
+{
+    memcpy( static_cast< EightChipState* >( this ), &state, sizeof( EightChipState ) );
+
+    m_Image.reset( );
+    MarkAllWritten( );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Only the pages written since the reset are compared with the image, and only those that differ
+ * are kept and hashed.
+ */
+bool
+EightChipCPU::SaveSnapshot( EightChipSnapshot& snapshot ) const
+{
+    if ( !m_Image )
+        return false;
+
+    const EightChipState& image = m_Image->GetState( );
+
+    snapshot.m_Image = m_Image;
+    memcpy( snapshot.m_Fields,
+            static_cast< const EightChipState* >( this ),
+            sizeof( snapshot.m_Fields ) );
+    memcpy( snapshot.m_Display, m_Display, sizeof( m_Display ) );
+
+    snapshot.m_Pages.clear( );
+    snapshot.m_Memory.clear( );
+
+    QWORD hash =
+        ecsnapshot::HashBytes( ecsnapshot::HashFields( *this ), m_Display, sizeof( m_Display ) );
+
+    for ( int word = 0; word < MEMORY_PAGES / 64; word++ )
+    {
+        QWORD pages = m_DirtyPages[ word ];
+
+        for ( int page = word * 64; pages != 0; page++, pages >>= 1 )
+        {
+            int address = page * MEMORY_PAGE_SIZE;
+
+            if ( !( pages & 1 )
+                 || memcmp( &m_GameMemory[ address ],
+                            &image.m_GameMemory[ address ],
+                            MEMORY_PAGE_SIZE ) == 0 )
+                continue;
+
+            snapshot.m_Pages.push_back( static_cast< WORD >( page ) );
+            snapshot.m_Memory.insert( snapshot.m_Memory.end( ),
+                                      &m_GameMemory[ address ],
+                                      &m_GameMemory[ address + MEMORY_PAGE_SIZE ] );
+
+            hash = ecsnapshot::HashBytes( ecsnapshot::Mix( hash ^ page ),
+                                          &m_GameMemory[ address ],
+                                          MEMORY_PAGE_SIZE );
+        }
+    }
+
+    snapshot.m_Hash = ecsnapshot::Mix( hash );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** An empty snapshot, never saved, leaves the CPU as it is. */
+void
+EightChipCPU::LoadSnapshot( const EightChipSnapshot& snapshot )
+{
+    if ( !snapshot.m_Image )
+        return;
+
+    IncrementalReset( snapshot.m_Image );
+
+    memcpy( static_cast< EightChipState* >( this ),
+            snapshot.m_Fields,
+            sizeof( snapshot.m_Fields ) );
+    memcpy( m_Display, snapshot.m_Display, sizeof( m_Display ) );
+
+    for ( size_t i = 0; i < snapshot.m_Pages.size( ); i++ )
+    {
+        int address = snapshot.m_Pages[ i ] * MEMORY_PAGE_SIZE;
+
+        memcpy( &m_GameMemory[ address ],
+                &snapshot.m_Memory[ i * MEMORY_PAGE_SIZE ],
+                MEMORY_PAGE_SIZE );
+        MarkDirty( address, MEMORY_PAGE_SIZE );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipCPU::TakeWrites( QWORD pages[ MEMORY_PAGES / 64 ], int& planes )
+{
+    memcpy( pages, m_WrittenPages, sizeof( m_WrittenPages ) );
+    planes = m_WrittenPlanes;
+
+    memset( m_WrittenPages, 0, sizeof( m_WrittenPages ) );
+    m_WrittenPlanes = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+WORD
+EightChipCPU::GetProgramCounter( ) const
+{
+    return m_ProgramCounter;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipCPU::IsHighResolution( ) const
+{
+    return m_HighResolution;
+}
+
+bool
+EightChipCPU::IsHalted( ) const
+{
+    return m_Halted;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** FX0A steps the PC back onto itself while no key is down. */
+bool
+EightChipCPU::IsWaitingForKey( ) const
+{
+    WORD pc = m_ProgramCounter & ( ROMSIZE - 1 );
+
+    if ( ( m_GameMemory[ pc ] & 0xF0 ) != 0xF0
+         || m_GameMemory[ ( pc + 1 ) & ( ROMSIZE - 1 ) ] != 0x0A )
+        return false;
+
+    for ( int key = 0; key < 16; key++ )
+    {
+        if ( m_KeyState[ key ] )
+            return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+BYTE
+EightChipCPU::GetSoundTimer( ) const
+{
+    return m_SoundTimer;
+}
+
+const BYTE*
+EightChipCPU::GetAudioPattern( ) const
+{
+    return m_AudioPattern;
+}
+
+BYTE
+EightChipCPU::GetPitch( ) const
+{
+    return m_Pitch;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** XO-CHIP's F000 NNNN is the only instruction spanning 4 bytes, skips step over all of it. Other
+ * profiles trap on F000, it is skipped as 2 bytes like any other.
+ */
+template < class QUIRKS >
+void
+EightChipCPU::SkipNextInstruction( )
+{
+    bool isLong = QUIRKS::XOCHIP_OPCODES && ReadMemory( m_ProgramCounter ) == 0xF0
+                  && ReadMemory( m_ProgramCounter + 1 ) == 0x00;
+
+    m_ProgramCounter += isLong ? 4 : 2;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** xorshift32: cheap, and unlike rand( ) its whole state lives in the CPU. */
+BYTE
+EightChipCPU::NextRandom( )
+{
+    m_RandomState ^= m_RandomState << 13;
+    m_RandomState ^= m_RandomState >> 17;
+    m_RandomState ^= m_RandomState << 5;
+
+    return m_RandomState >> 24;
+}
+
 //-------------------------------------------------------------------------------------------------
 /** Decreases the timers. */
 void
@@ -57,11 +447,12 @@ EightChipCPU::DecreaseTimers( )
     if ( m_DelayTimer > 0 )
         m_DelayTimer--;
 
+    // The host plays the audio pattern while the sound timer runs (see. GetSoundTimer)
     if ( m_SoundTimer > 0 )
-    {
         m_SoundTimer--;
-        PlayBeep( );
-    }
+
+    // The display interrupt a DXYN waits for under the timing model
+    m_WaitingFrame = false;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -78,17 +469,6 @@ EightChipCPU::KeyUp( int key )
     m_KeyState[ key ] = 0;
 }
 
-//-------------------------------------------------------------------------------------------------
-
-void
-EightChipCPU::PlayBeep( )
-{
-// This part could be replaced later by using OpenAL or SDL_mixer
-#ifdef _WIN32
-    Beep( 440, 300 );
-#endif
-}
-
 //-------------------------------------------------------------------------------------------------
 /** The game is loaded into memory 0x200, since the interval 0 - 1FFF is reserved for the
  * interpreter.
@@ -110,6 +490,118 @@ EightChipCPU::CPUReset( )
     // Initialise timers
     m_DelayTimer = 0;
     m_SoundTimer = 0;
+
+    // Nothing to return to, nothing went wrong yet
+    m_StackPointer = 0;
+    memset( m_Stack, 0, sizeof( m_Stack ) );
+    m_Faults = FAULT_NONE;
+
+    // Nothing owed to the cycle budget
+    m_CycleBalance = 0;
+    m_WaitingFrame = false;
+
+    // The interpreter area holds the fonts
+    memcpy( &m_GameMemory[ FONT_ADDRESS ], FONT, sizeof( FONT ) );
+    memcpy( &m_GameMemory[ BIG_FONT_ADDRESS ], BIG_FONT, sizeof( BIG_FONT ) );
+
+    // Not an image, the next incremental reset copies the whole state
+    m_Image.reset( );
+    memset( m_DirtyPages, 0, sizeof( m_DirtyPages ) );
+    MarkAllWritten( );
+
+    // SUPER-CHIP state
+    memset( m_RPLFlags, 0, sizeof( m_RPLFlags ) );
+    m_HighResolution = false;
+    m_Halted = false;
+
+    // XO-CHIP state: drawing on the first plane, and a 500Hz square wave
+    // as the default buzzer
+    m_PlaneMask = 0x1;
+    memset( m_Display, 0, sizeof( m_Display ) );
+    memset( m_AudioPattern, 0xF0, sizeof( m_AudioPattern ) );
+    m_Pitch = AUDIO_DEFAULT_PITCH;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Reads from the game memory. The address is masked rather than checked, the fault is recorded
+ * without a branch.
+ */
+BYTE
+EightChipCPU::ReadMemory( int address )
+{
+    m_Faults |= ( ( address & ~( ROMSIZE - 1 ) ) != 0 ) * FAULT_MEMORY_BOUNDS;
+
+    return m_GameMemory[ address & ( ROMSIZE - 1 ) ];
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Writes to the game memory, see. ReadMemory. */
+void
+EightChipCPU::WriteMemory( int address, BYTE value )
+{
+    m_Faults |= ( ( address & ~( ROMSIZE - 1 ) ) != 0 ) * FAULT_MEMORY_BOUNDS;
+
+    int page = ( address & ( ROMSIZE - 1 ) ) / MEMORY_PAGE_SIZE;
+
+    m_GameMemory[ address & ( ROMSIZE - 1 ) ] = value;
+    m_DirtyPages[ page / 64 ] |= 1ULL << ( page % 64 );
+    m_WrittenPages[ page / 64 ] |= 1ULL << ( page % 64 );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipCPU::MarkDirty( int address, size_t size )
+{
+    if ( size == 0 )
+        return;
+
+    int last = static_cast< int >( ( address + size - 1 ) / MEMORY_PAGE_SIZE );
+
+    for ( int page = address / MEMORY_PAGE_SIZE; page <= last; page++ )
+    {
+        m_DirtyPages[ page / 64 ] |= 1ULL << ( page % 64 );
+        m_WrittenPages[ page / 64 ] |= 1ULL << ( page % 64 );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipCPU::MarkAllWritten( )
+{
+    memset( m_WrittenPages, 0xFF, sizeof( m_WrittenPages ) );
+    m_WrittenPlanes = ( 1 << DISPLAY_PLANES ) - 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The plain interpreter compiles the hook away and is left with ReadMemory. */
+template < class QUIRKS >
+BYTE
+EightChipCPU::ReadData( int address )
+{
+    if ( ecquirks::HooksOf< QUIRKS >::value & HOOKS_DEBUG )
+        m_Debugger->OnRead( static_cast< WORD >( address & ( ROMSIZE - 1 ) ) );
+
+    if ( ecquirks::HooksOf< QUIRKS >::value & HOOKS_COVERAGE )
+        m_Coverage->OnRead( static_cast< WORD >( address & ( ROMSIZE - 1 ) ) );
+
+    return ReadMemory( address );
+}
+
+//-------------------------------------------------------------------------------------------------
+template < class QUIRKS >
+void
+EightChipCPU::WriteData( int address, BYTE value )
+{
+    if ( ecquirks::HooksOf< QUIRKS >::value & HOOKS_DEBUG )
+        m_Debugger->OnWrite( static_cast< WORD >( address & ( ROMSIZE - 1 ) ) );
+
+    if ( ecquirks::HooksOf< QUIRKS >::value & HOOKS_TRACE )
+        m_Tracer->OnWrite( static_cast< WORD >( address & ( ROMSIZE - 1 ) ), value );
+
+    if ( ecquirks::HooksOf< QUIRKS >::value & HOOKS_COVERAGE )
+        m_Coverage->OnWrite( static_cast< WORD >( address & ( ROMSIZE - 1 ) ) );
+
+    WriteMemory( address, value );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -121,7 +613,7 @@ EightChipCPU::GetKeyPressed( )
     int key = -1;
 
     //  skim through the keypad
-    for ( int i = 0; i < 10; i++ )
+    for ( int i = 0; i < 16; i++ )
     {
         // checks if key is pressed, if true, return its value.
         if ( m_KeyState[ i ] > 0 )
@@ -156,13 +648,13 @@ EightChipCPU::GetNextOpCode( )
     WORD res = 0;
 
     // Retrieve the current byte
-    res = m_GameMemory[ m_ProgramCounter ];
+    res = ReadMemory( m_ProgramCounter );
 
     // Shift the first byte by 8 to the MSB,
     // and get the other byte on the LSB side.
     //	res = (res << 8) | m_GameMemory[m_ProgramCounter + 1];
     res <<= 8;
-    res |= m_GameMemory[ m_ProgramCounter + 1 ];
+    res |= ReadMemory( m_ProgramCounter + 1 );
 
     // Move 2 bytes ahead (OpCode size) to the next 'instruction'.
     m_ProgramCounter += 2;
@@ -186,14 +678,13 @@ EightChipCPU::GetNextOpCode( )
 void
 EightChipCPU::OpCode00E0( )
 {
-    for ( int x = 0; x < WINDOW_WIDTH; x++ )
+    m_WrittenPlanes |= m_PlaneMask;
+
+    // Only the selected planes are cleared
+    for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
     {
-        for ( int y = 0; y < WINDOW_HEIGHT; y++ )
-        {
-            m_ScreenPixels[ y ][ x ][ 0 ] = 0xFF;  // R
-            m_ScreenPixels[ y ][ x ][ 1 ] = 0xFF;  // G
-            m_ScreenPixels[ y ][ x ][ 2 ] = 0xFF;  // B
-        }
+        if ( m_PlaneMask & ( 1 << plane ) )
+            ecdisplay::Clear( m_Display[ plane ] );
     }
 }
 
@@ -203,23 +694,27 @@ EightChipCPU::OpCode00E0( )
 void
 EightChipCPU::OpCode00EE( )
 {
+    // Returning with nothing on the stack is a guest bug, execution carries on.
+    if ( m_StackPointer == 0 )
+    {
+        m_Faults |= FAULT_STACK_UNDERFLOW;
+        return;
+    }
+
     // The interpreter sets the program counter to the address
-    // at the top of the stack. An element is subtracted implicitly from stack.
-    m_ProgramCounter = m_Stack.back( );
-    m_Stack.pop_back( );
+    // at the top of the stack, then subtracts 1 from the stack pointer.
+    m_StackPointer--;
+    m_ProgramCounter = m_Stack[ m_StackPointer & ( STACK_DEPTH - 1 ) ];
 }
 
 //-------------------------------------------------------------------------------------------------
 // DRW Vx, Vy, nibble
 // Display n-byte sprite starting at memory location I
 // at (Vx, Vy), set VF = collision
+template < class QUIRKS >
 void
 EightChipCPU::OpCodeDXYN( WORD opcode )
 {
-    // We will be scaling the window up 10 times.
-    // ie. 64x32px to 1280x640px
-    const int SCALE = 20;
-
     // Masks off the Vx and Vy registers
     int Vx = opcode & 0x0F00;
     Vx = Vx >> 8;
@@ -227,66 +722,189 @@ EightChipCPU::OpCodeDXYN( WORD opcode )
     int Vy = opcode & 0x00F0;
     Vy = Vy >> 4;
 
-    // Calculate coordinates based on Vx, Vy
-    // while taking account of scaling
-    int spriteX = m_Registers[ Vx ] * SCALE;
-    int spriteY = m_Registers[ Vy ] * SCALE;
+    // Calculate coordinates based on Vx, Vy. In low resolution each
+    // pixel is 2x2 display pixels. The starting position always wraps.
+    int scale = m_HighResolution ? 1 : 2;
+    int spriteX = ( m_Registers[ Vx ] * scale ) & ( DISPLAY_WIDTH - 1 );
+    int spriteY = ( m_Registers[ Vy ] * scale ) & ( DISPLAY_HEIGHT - 1 );
     int spriteHeight = ( opcode & 0x000F );
 
+    // SUPER-CHIP: DXY0 draws a 16x16 sprite, two bytes per row.
+    int spriteBytes = 1;
+    if ( spriteHeight == 0 )
+    {
+        spriteHeight = 16;
+        spriteBytes = 2;
+    }
+
     // Set collisions to 0
     m_Registers[ 0xF ] = 0x00;
 
-    for ( int y_line = 0; y_line < spriteHeight; y_line++ )
+    // XO-CHIP: each selected plane gets its own sprite, stored one after
+    // the other from I.
+    int address = m_AddressI;
+    m_WrittenPlanes |= m_PlaneMask;
+
+    for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+    {
+        if ( m_PlaneMask & ( 1 << plane ) )
+        {
+            DrawSprite< QUIRKS >(
+                m_Display[ plane ], address, spriteX, spriteY, spriteHeight, spriteBytes );
+            address += spriteHeight * spriteBytes;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Draws the sprite stored at address onto one plane, see. OpCodeDXYN. */
+template < class QUIRKS >
+void
+EightChipCPU::DrawSprite( EightChipPlane& plane,
+                          int address,
+                          int spriteX,
+                          int spriteY,
+                          int spriteHeight,
+                          int spriteBytes )
+{
+    int scale = m_HighResolution ? 1 : 2;
+
+    for ( int y_line = 0; y_line < spriteHeight; y_line++, address += spriteBytes )
     {
         // The interpreter reads n bytes from memory starting
         // the address stored in I.
-        BYTE pixel = ( m_GameMemory[ m_AddressI + y_line ] );
+        QWORD pixels = ReadData< QUIRKS >( address );
 
-        int x_line = 0;
-        int x_line_inv = 7;
+        if ( spriteBytes == 2 )
+            pixels = ( pixels << 8 ) | ReadData< QUIRKS >( address + 1 );
 
-        for ( x_line = 0; x_line < 8; x_line++, x_line_inv-- )
+        // Low resolution rows are stretched to twice their width
+        int width = 8 * spriteBytes;
+        if ( scale == 2 )
         {
-            // These bytes are then displayed as sprites on screen
-            // at coordinates (Vx, Vy).
-            int mask = 1 << x_line_inv;
-            if ( pixel & mask )
-            {
-                // initialize coordinates and colours
-                int x = ( x_line * SCALE ) + spriteX;
-                int y = ( y_line * SCALE ) + spriteY;
-                int colour = 0x00;  // black
-
-                // If this causes any pixels to be erased, VF is set to 1
-                // Otherwise it is set to 0.
-                if ( m_ScreenPixels[ y ][ x ][ 0 ] == 0 )
-                {
-                    colour = 0xFF;  // white
-                    m_Registers[ 0xF ] = 1;
-                }
+            pixels = ( DoubleBits( pixels >> 8 ) << 16 ) | DoubleBits( pixels & 0xFF );
+            width *= 2;
+        }
 
-                // If the sprite is positioned so part of it is outside the
-                // coordinates of the display, it wraps around  to opposite
-                // direction of the screen.
-                // Sprites are XOR'd onto existing screen,
-                // (see. 8XY3 for XOR)
-                for ( int i = 0; i < SCALE; i++ )
-                {
-                    for ( int j = 0; j < SCALE; j++ )
-                    {
-                        m_ScreenPixels[ y + i ][ x + j ][ 0 ] = colour;  // R
-                        m_ScreenPixels[ y + i ][ x + j ][ 1 ] = colour;  // G
-                        m_ScreenPixels[ y + i ][ x + j ][ 2 ] = colour;  // B
-                    }
-                }
-            }
+        // These bytes are then displayed as sprites on screen at
+        // coordinates (Vx, Vy). If the sprite is positioned so part of it is
+        // outside the coordinates of the display, it either wraps around to opposite
+        // direction of the screen or is clipped (see. SPRITES_WRAP).
+        // Sprites are XOR'd onto existing screen, (see. 8XY3 for XOR)
+        pixels <<= 64 - width;
+
+        bool collision = false;
+        for ( int i = 0; i < scale; i++ )
+        {
+            collision |= ecdisplay::XorRow< QUIRKS::SPRITES_WRAP >(
+                plane, spriteY + y_line * scale + i, spriteX, pixels );
         }
+
+        // If this causes any pixels to be erased, VF is set to 1, otherwise
+        // it is set to 0. In high resolution VF counts the colliding rows.
+        if ( collision )
+            m_Registers[ 0xF ] = m_HighResolution ? m_Registers[ 0xF ] + 1 : 1;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// SCD nibble
+// Scroll display n lines down
+void
+EightChipCPU::OpCode00CN( WORD opcode )
+{
+    int rows = opcode & 0x000F;
+    m_WrittenPlanes |= m_PlaneMask;
+
+    // Low resolution lines are two display rows high
+    for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+    {
+        if ( m_PlaneMask & ( 1 << plane ) )
+            ecdisplay::ScrollDown( m_Display[ plane ], m_HighResolution ? rows : rows * 2 );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// SCU nibble
+// Scroll display n lines up
+void
+EightChipCPU::OpCode00DN( WORD opcode )
+{
+    int rows = opcode & 0x000F;
+    m_WrittenPlanes |= m_PlaneMask;
+
+    // Low resolution lines are two display rows high
+    for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+    {
+        if ( m_PlaneMask & ( 1 << plane ) )
+            ecdisplay::ScrollUp( m_Display[ plane ], m_HighResolution ? rows : rows * 2 );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// SCR
+// Scroll display 4 pixels right
+void
+EightChipCPU::OpCode00FB( )
+{
+    m_WrittenPlanes |= m_PlaneMask;
+
+    for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+    {
+        if ( m_PlaneMask & ( 1 << plane ) )
+            ecdisplay::ScrollRight( m_Display[ plane ], m_HighResolution ? 4 : 8 );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// SCL
+// Scroll display 4 pixels left
+void
+EightChipCPU::OpCode00FC( )
+{
+    m_WrittenPlanes |= m_PlaneMask;
+
+    for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+    {
+        if ( m_PlaneMask & ( 1 << plane ) )
+            ecdisplay::ScrollLeft( m_Display[ plane ], m_HighResolution ? 4 : 8 );
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+// EXIT
+// Exit the interpreter
+void
+EightChipCPU::OpCode00FD( )
+{
+    // There's nothing to exit to: the program counter stays on this
+    // instruction and the host can check IsHalted( ).
+    m_Halted = true;
+    m_ProgramCounter -= 2;
+}
+
+//-------------------------------------------------------------------------------------------------
+// LOW
+// Disable extended screen mode
+void
+EightChipCPU::OpCode00FE( )
+{
+    m_HighResolution = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+// HIGH
+// Enable extended screen mode for full-screen graphics
+void
+EightChipCPU::OpCode00FF( )
+{
+    m_HighResolution = true;
+}
+
 //-------------------------------------------------------------------------------------------------
 // SKP Vx
 // Skip next instruction if key with the value of Vx is pressed.
+template < class QUIRKS >
 void
 EightChipCPU::OpCodeEX9E( WORD opcode )
 {
@@ -294,18 +912,19 @@ EightChipCPU::OpCodeEX9E( WORD opcode )
     int Vx = opcode & 0x0F00;
     Vx >>= 8;
 
-    // Checks the keyboard,
-    int keypressed = m_Registers[ Vx ];
+    // Checks the keyboard, only the low nibble names a key.
+    int keypressed = m_Registers[ Vx ] & 0xF;
 
     // and if the key corresponding to the value of Vx
     // is currently down, PC is increased by 2
     if ( m_KeyState[ keypressed ] == 1 )
-        m_ProgramCounter += 2;
+        SkipNextInstruction< QUIRKS >( );
 }
 
 //-------------------------------------------------------------------------------------------------
 // SKNP Vx
 // Skip next instruction if key with the value of Vx is pressed.
+template < class QUIRKS >
 void
 EightChipCPU::OpCodeEXA1( WORD opcode )
 {
@@ -313,13 +932,13 @@ EightChipCPU::OpCodeEXA1( WORD opcode )
     int Vx = opcode & 0x0F00;
     Vx >>= 8;
 
-    // Checks the keyboard,
-    int keypressed = m_Registers[ Vx ];
+    // Checks the keyboard, only the low nibble names a key.
+    int keypressed = m_Registers[ Vx ] & 0xF;
 
     // and if the key corresponding to the value of Vx
     // is currently in the up position, PC is incremented by 2
     if ( m_KeyState[ keypressed ] == 0 )
-        m_ProgramCounter += 2;
+        SkipNextInstruction< QUIRKS >( );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -341,6 +960,7 @@ EightChipCPU::OpCode8XY0( WORD opcode )
 //-------------------------------------------------------------------------------------------------
 // OR Vx, Vy
 // Set Vx = Vx OR Vy
+template < class QUIRKS >
 void
 EightChipCPU::OpCode8XY1( WORD opcode )
 {
@@ -353,11 +973,16 @@ EightChipCPU::OpCode8XY1( WORD opcode )
     // Performs a bitwise OR on the values of Vx and Vy,
     // then stores the result in Vx.
     m_Registers[ Vx ] = m_Registers[ Vx ] | m_Registers[ Vy ];
+
+    // The COSMAC VIP did these through its ALU, leaving VF cleared.
+    if ( QUIRKS::LOGIC_RESETS_VF )
+        m_Registers[ 0xF ] = 0;
 }
 
 //-------------------------------------------------------------------------------------------------
 // AND Vx, Vy
 // Set Vx = Vx AND Vy
+template < class QUIRKS >
 void
 EightChipCPU::OpCode8XY2( WORD opcode )
 {
@@ -369,12 +994,17 @@ EightChipCPU::OpCode8XY2( WORD opcode )
 
     // Performs a bitwise AND on the values of Vx and Vy,
     // then stores the result in Vx.
-    m_Registers[ Vx ] = m_Registers[ Vy ] & m_Registers[ Vy ];
+    m_Registers[ Vx ] = m_Registers[ Vx ] & m_Registers[ Vy ];
+
+    // The COSMAC VIP did these through its ALU, leaving VF cleared.
+    if ( QUIRKS::LOGIC_RESETS_VF )
+        m_Registers[ 0xF ] = 0;
 }
 
 //-------------------------------------------------------------------------------------------------
 // XOR Vx, Vy
 // Set Vx = Vx XOR Vy
+template < class QUIRKS >
 void
 EightChipCPU::OpCode8XY3( WORD opcode )
 {
@@ -387,6 +1017,10 @@ EightChipCPU::OpCode8XY3( WORD opcode )
     // Performs a bitwise XOR on the values of Vx and Vy,
     // then stores the result in Vx.
     m_Registers[ Vx ] = m_Registers[ Vx ] ^ m_Registers[ Vy ];
+
+    // The COSMAC VIP did these through its ALU, leaving VF cleared.
+    if ( QUIRKS::LOGIC_RESETS_VF )
+        m_Registers[ 0xF ] = 0;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -442,19 +1076,25 @@ EightChipCPU::OpCode8XY5( WORD opcode )
 //-------------------------------------------------------------------------------------------------
 // SHR Vx {, Vy}
 // Set Vx = Vx SHR 1
+template < class QUIRKS >
 void
 EightChipCPU::OpCode8XY6( WORD opcode )
 {
-    // Masks off the Vx register
+    // Masks off the Vx and Vy registers
     int Vx = opcode & 0x0F00;
+    int Vy = opcode & 0x00F0;
     Vx >>= 8;
+    Vy >>= 4;
 
-    // If the LSB of Vx is 1, the VF is set to 1
-    // Otherwise, it's set to 0.
-    m_Registers[ 0xF ] = m_Registers[ Vx ] & 0x1;
+    // The COSMAC VIP shifts Vy into Vx, later interpreters shift Vx in place.
+    BYTE value = m_Registers[ QUIRKS::SHIFT_USES_VY ? Vy : Vx ];
 
     // Vx is, then, divided by 2.
-    m_Registers[ Vx ] >>= 1;
+    m_Registers[ Vx ] = value >> 1;
+
+    // If the LSB was 1, the VF is set to 1
+    // Otherwise, it's set to 0.
+    m_Registers[ 0xF ] = value & 0x1;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -482,19 +1122,25 @@ EightChipCPU::OpCode8XY7( WORD opcode )
 
 //-------------------------------------------------------------------------------------------------
 // SHL Vx {, Vy}
-// Set Vx = Vx SHL Vy
+// Set Vx = Vx SHL 1
+template < class QUIRKS >
 void
 EightChipCPU::OpCode8XYE( WORD opcode )
 {
-    // Masks off the Vx register
+    // Masks off the Vx and Vy registers
     int Vx = opcode & 0x0F00;
+    int Vy = opcode & 0x00F0;
     Vx >>= 8;
+    Vy >>= 4;
 
-    // If the MSB of Vx is 1, then VF is set to 1, otherwise to 0.
-    m_Registers[ 0xF ] = m_Registers[ Vx ] >> 7;
+    // Same as 8XY6, the source depends on the interpreter.
+    BYTE value = m_Registers[ QUIRKS::SHIFT_USES_VY ? Vy : Vx ];
 
     // Then Vx is multiplied by 2.
-    m_Registers[ Vx ] <<= 1;
+    m_Registers[ Vx ] = value << 1;
+
+    // If the MSB was 1, then VF is set to 1, otherwise to 0.
+    m_Registers[ 0xF ] = value >> 7;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -523,7 +1169,7 @@ EightChipCPU::OpCodeFX0A( WORD opcode )
     // Retrieve the current keypad's state.
     int keypressed = GetKeyPressed( );
 
-    if ( keypressed = -1 )
+    if ( keypressed == -1 )
     {
         // All execution stops until a key is pressed,
         m_ProgramCounter -= 2;
@@ -591,12 +1237,27 @@ EightChipCPU::OpCodeFX29( WORD opcode )
     // The value of I is set to the location for the hexadecimal sprite
     // corresponding to the value in Vx.
     // Characters 0-F (in hexadecimal) are represented by a 4x5 font.
-    m_AddressI = m_Registers[ Vx ] * 5;
+    m_AddressI = FONT_ADDRESS + ( m_Registers[ Vx ] & 0xF ) * 5;
+}
+
+//-------------------------------------------------------------------------------------------------
+// LD HF, Vx
+// Set I = location of the 8x10 sprite of digit Vx
+void
+EightChipCPU::OpCodeFX30( WORD opcode )
+{
+    // masks off Vx register
+    int Vx = opcode & 0x0F00;
+    Vx >>= 8;
+
+    // Same as FX29 with the SUPER-CHIP 8x10 font.
+    m_AddressI = BIG_FONT_ADDRESS + ( m_Registers[ Vx ] & 0xF ) * 10;
 }
 
 //-------------------------------------------------------------------------------------------------
 // LD B, Vx
 // Store Binary-coded decimal representation of Vx in memory locations I, I+1 and I+2
+template < class QUIRKS >
 void
 EightChipCPU::OpCodeFX33( WORD opcode )
 {
@@ -614,14 +1275,15 @@ EightChipCPU::OpCodeFX33( WORD opcode )
     // and the units digits in I+2.
     int units = value % 10;
 
-    m_GameMemory[ m_AddressI ] = hundreds;
-    m_GameMemory[ m_AddressI + 1 ] = tens;
-    m_GameMemory[ m_AddressI + 2 ] = units;
+    WriteData< QUIRKS >( m_AddressI, hundreds );
+    WriteData< QUIRKS >( m_AddressI + 1, tens );
+    WriteData< QUIRKS >( m_AddressI + 2, units );
 }
 
 //-------------------------------------------------------------------------------------------------
 // LD [I], Vx
 // Stores registers V0 through Vx in memory starting at location I
+template < class QUIRKS >
 void
 EightChipCPU::OpCodeFX55( WORD opcode )
 {
@@ -633,15 +1295,18 @@ EightChipCPU::OpCodeFX55( WORD opcode )
     // into memory, starting at the address in I
     for ( int i = 0; i <= Vx; i++ )
     {
-        m_GameMemory[ m_AddressI + i ] = m_Registers[ i ];
+        WriteData< QUIRKS >( m_AddressI + i, m_Registers[ i ] );
     }
 
-    m_AddressI = m_AddressI + Vx + 1;
+    // SUPER-CHIP leaves I where it was.
+    if ( QUIRKS::LOAD_STORE_INCREMENTS_I )
+        m_AddressI += Vx + 1;
 }
 
 //-------------------------------------------------------------------------------------------------
 // LD Vx, [I]
 // Read registers V0 through Vx from memory starting at location I
+template < class QUIRKS >
 void
 EightChipCPU::OpCodeFX65( WORD opcode )
 {
@@ -653,10 +1318,82 @@ EightChipCPU::OpCodeFX65( WORD opcode )
     // into registers V0 through Vx.
     for ( int i = 0; i <= Vx; i++ )
     {
-        m_Registers[ i ] = m_GameMemory[ m_AddressI + i ];
+        m_Registers[ i ] = ReadData< QUIRKS >( m_AddressI + i );
     }
 
-    m_AddressI = m_AddressI + Vx + 1;
+    // SUPER-CHIP leaves I where it was.
+    if ( QUIRKS::LOAD_STORE_INCREMENTS_I )
+        m_AddressI += Vx + 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+// LD R, Vx
+// Store V0 through Vx in the RPL user flags
+void
+EightChipCPU::OpCodeFX75( WORD opcode )
+{
+    // masks off Vx register
+    int Vx = opcode & 0x0F00;
+    Vx >>= 8;
+
+    memcpy( m_RPLFlags, m_Registers, Vx + 1 );
+}
+
+//-------------------------------------------------------------------------------------------------
+// LD Vx, R
+// Read V0 through Vx from the RPL user flags
+void
+EightChipCPU::OpCodeFX85( WORD opcode )
+{
+    // masks off Vx register
+    int Vx = opcode & 0x0F00;
+    Vx >>= 8;
+
+    memcpy( m_Registers, m_RPLFlags, Vx + 1 );
+}
+
+//-------------------------------------------------------------------------------------------------
+// LD I, long
+// Set I = NNNN, the 16-bits address following the instruction
+void
+EightChipCPU::OpCodeF000( )
+{
+    // The address is read like an opcode, which moves PC past it.
+    m_AddressI = GetNextOpCode( );
+}
+
+//-------------------------------------------------------------------------------------------------
+// PLANE n
+// Select the bit planes used by the display instructions
+void
+EightChipCPU::OpCodeFN01( WORD opcode )
+{
+    // The plane mask sits where Vx usually is.
+    m_PlaneMask = ( opcode & 0x0F00 ) >> 8;
+}
+
+//-------------------------------------------------------------------------------------------------
+// AUDIO
+// Load the 16 bytes audio pattern from memory starting at location I
+template < class QUIRKS >
+void
+EightChipCPU::OpCodeF002( )
+{
+    for ( int i = 0; i < AUDIO_PATTERN_SIZE; i++ )
+        m_AudioPattern[ i ] = ReadData< QUIRKS >( m_AddressI + i );
+}
+
+//-------------------------------------------------------------------------------------------------
+// PITCH Vx
+// Set the playback pitch of the audio pattern = Vx
+void
+EightChipCPU::OpCodeFX3A( WORD opcode )
+{
+    // masks off Vx register
+    int Vx = opcode & 0x0F00;
+    Vx >>= 8;
+
+    m_Pitch = m_Registers[ Vx ];
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -675,9 +1412,18 @@ EightChipCPU::OpCode1KKK( WORD opcode )
 void
 EightChipCPU::OpCode2KKK( WORD opcode )
 {
-    // The interpreter increments the stack pointer (implicit using std::vector)
-    // then puts the current PC on top of the stack.
-    m_Stack.push_back( m_ProgramCounter );
+    // The interpreter puts the current PC on top of the stack, then
+    // increments the stack pointer. Nesting deeper than the stack allows
+    // loses the return address.
+    if ( m_StackPointer < STACK_DEPTH )
+    {
+        m_Stack[ m_StackPointer & ( STACK_DEPTH - 1 ) ] = m_ProgramCounter;
+        m_StackPointer++;
+    }
+    else
+    {
+        m_Faults |= FAULT_STACK_OVERFLOW;
+    }
 
     // The interpreter sets the program counter to KKK.
     m_ProgramCounter = opcode & 0x0FFF;
@@ -686,6 +1432,7 @@ EightChipCPU::OpCode2KKK( WORD opcode )
 //-------------------------------------------------------------------------------------------------
 // SE Vx, byte
 // Skip next instruction if Vx = kk
+template < class QUIRKS >
 void
 EightChipCPU::OpCode3XKK( WORD opcode )
 {
@@ -698,12 +1445,13 @@ EightChipCPU::OpCode3XKK( WORD opcode )
     // The interpreter compares the register Vx to kk
     // If they are equal, the PC is incremented by 2 bytes (to the next OpCode).
     if ( m_Registers[ Vx ] == kk )
-        m_ProgramCounter += 2;
+        SkipNextInstruction< QUIRKS >( );
 }
 
 //-------------------------------------------------------------------------------------------------
 // SNE Vx, byte
 // Skip next instruction if Vx != kk
+template < class QUIRKS >
 void
 EightChipCPU::OpCode4XKK( WORD opcode )
 {
@@ -716,12 +1464,13 @@ EightChipCPU::OpCode4XKK( WORD opcode )
     // The interpreter compares the register Vx to kk
     // If they are not equal, the PC is incremented by 2 bytes.
     if ( m_Registers[ Vx ] != kk )
-        m_ProgramCounter += 2;
+        SkipNextInstruction< QUIRKS >( );
 }
 
 //-------------------------------------------------------------------------------------------------
 // SE Vx, Vy
 // Skip next instruction if Vx = Vy
+template < class QUIRKS >
 void
 EightChipCPU::OpCode5XY0( WORD opcode )
 {
@@ -735,7 +1484,49 @@ EightChipCPU::OpCode5XY0( WORD opcode )
     // The interpreter compares registers Vx and Vy
     // If they are equal, the PC is incremented by 2 bytes.
     if ( m_Registers[ Vx ] == m_Registers[ Vy ] )
-        m_ProgramCounter += 2;
+        SkipNextInstruction< QUIRKS >( );
+}
+
+//-------------------------------------------------------------------------------------------------
+// SAVE Vx - Vy
+// Store registers Vx through Vy in memory starting at location I
+template < class QUIRKS >
+void
+EightChipCPU::OpCode5XY2( WORD opcode )
+{
+    // masks off registers Vx and Vy
+    int Vx = opcode & 0x0F00;
+    int Vy = opcode & 0x00F0;
+    // shifts Vx and Vy across adequately
+    Vx >>= 8;
+    Vy >>= 4;
+
+    // The range can go either way, I is left untouched.
+    int step = ( Vx <= Vy ) ? 1 : -1;
+
+    for ( int i = 0; i <= abs( Vy - Vx ); i++ )
+        WriteData< QUIRKS >( m_AddressI + i, m_Registers[ Vx + i * step ] );
+}
+
+//-------------------------------------------------------------------------------------------------
+// LOAD Vx - Vy
+// Read registers Vx through Vy from memory starting at location I
+template < class QUIRKS >
+void
+EightChipCPU::OpCode5XY3( WORD opcode )
+{
+    // masks off registers Vx and Vy
+    int Vx = opcode & 0x0F00;
+    int Vy = opcode & 0x00F0;
+    // shifts Vx and Vy across adequately
+    Vx >>= 8;
+    Vy >>= 4;
+
+    // The range can go either way, I is left untouched.
+    int step = ( Vx <= Vy ) ? 1 : -1;
+
+    for ( int i = 0; i <= abs( Vy - Vx ); i++ )
+        m_Registers[ Vx + i * step ] = ReadData< QUIRKS >( m_AddressI + i );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -773,6 +1564,7 @@ EightChipCPU::OpCode7XKK( WORD opcode )
 //-------------------------------------------------------------------------------------------------
 // LD Vx, Vy
 // Skip the next instruction if Vx != Vy
+template < class QUIRKS >
 void
 EightChipCPU::OpCode9XY0( WORD opcode )
 {
@@ -785,7 +1577,7 @@ EightChipCPU::OpCode9XY0( WORD opcode )
 
     // Increment program counter if Vx != Vy
     if ( m_Registers[ Vx ] != m_Registers[ Vy ] )
-        m_ProgramCounter += 2;
+        SkipNextInstruction< QUIRKS >( );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -804,14 +1596,18 @@ EightChipCPU::OpCodeANNN( WORD opcode )
 //-------------------------------------------------------------------------------------------------
 // JP V0, addr
 // Jump to location nnn + V0
+template < class QUIRKS >
 void
 EightChipCPU::OpCodeBNNN( WORD opcode )
 {
     // masks off nnn
     int nnn = opcode & 0x0FFF;
 
-    // The program counter is set to nnn plus the value of V0
-    m_ProgramCounter = m_Registers[ 0 ] + nnn;
+    // The program counter is set to nnn plus the value of V0.
+    // SUPER-CHIP reads it as BXNN and adds Vx instead.
+    int Vx = QUIRKS::JUMP_USES_VX ? ( opcode & 0x0F00 ) >> 8 : 0;
+
+    m_ProgramCounter = m_Registers[ Vx ] + nnn;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -829,193 +1625,475 @@ EightChipCPU::OpCodeCXKK( WORD opcode )
     // which is then AND'd with the value of kk.
     // The results are stored in Vx. (see. 8XY2 for more details on AND)
     //	m_Registers[Vx] = (rand() % 256) & kk;
-    m_Registers[ Vx ] = rand( ) & kk;
+    m_Registers[ Vx ] = NextRandom( ) & kk;
 }
 
 //-------------------------------------------------------------------------------------------------
-/**
- * Decode OpCodes grouped in 0, 8, E and F.
- */
+// Opcode that doesn't decode to any instruction, execution carries on past it
+void
+EightChipCPU::OpCodeIllegal( WORD /*opcode*/ )
+{
+    m_Faults |= FAULT_ILLEGAL_OPCODE;
+}
+
 //-------------------------------------------------------------------------------------------------
-// Execute OpCodes of MSB matching the value 0
+/** Gives the handlers without operands the signature of the others. */
+template < void ( EightChipCPU::*HANDLER )( ) >
 void
-EightChipCPU::DecodeOpCode0( WORD opcode )
+EightChipCPU::OpCodeNoOperand( WORD /*opcode*/ )
+{
+    ( this->*HANDLER )( );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Indexed by EightChipOpcodeId, one table per quirk profile. */
+template < class QUIRKS >
+const EightChipCPU::OPCODE_HANDLER EightChipCPU::OPCODE_HANDLERS[ OP_COUNT ] = {
+    &EightChipCPU::OpCodeIllegal,                                  // OP_INVALID
+    &EightChipCPU::OpCodeNoOperand< &EightChipCPU::OpCode00E0 >,   // CLS
+    &EightChipCPU::OpCodeNoOperand< &EightChipCPU::OpCode00EE >,   // RET
+    &EightChipCPU::OpCode1KKK,                                     // JP addr
+    &EightChipCPU::OpCode2KKK,                                     // CALL addr
+    &EightChipCPU::OpCode3XKK< QUIRKS >,                           // SE Vx, byte
+    &EightChipCPU::OpCode4XKK< QUIRKS >,                           // SNE Vx, byte
+    &EightChipCPU::OpCode5XY0< QUIRKS >,                           // SE Vx, Vy
+    &EightChipCPU::OpCode6XKK,                                     // LD Vx, byte
+    &EightChipCPU::OpCode7XKK,                                     // ADD Vx, byte
+    &EightChipCPU::OpCode8XY0,                                     // LD Vx, Vy
+    &EightChipCPU::OpCode8XY1< QUIRKS >,                           // OR Vx, Vy
+    &EightChipCPU::OpCode8XY2< QUIRKS >,                           // AND Vx, Vy
+    &EightChipCPU::OpCode8XY3< QUIRKS >,                           // XOR Vx, Vy
+    &EightChipCPU::OpCode8XY4,                                     // ADD Vx, Vy
+    &EightChipCPU::OpCode8XY5,                                     // SUB Vx, Vy
+    &EightChipCPU::OpCode8XY6< QUIRKS >,                           // SHR Vx {, Vy}
+    &EightChipCPU::OpCode8XY7,                                     // SUBN Vx, Vy
+    &EightChipCPU::OpCode8XYE< QUIRKS >,                           // SHL Vx {, Vy}
+    &EightChipCPU::OpCode9XY0< QUIRKS >,                           // SNE Vx, Vy
+    &EightChipCPU::OpCodeANNN,                                     // LD I, addr
+    &EightChipCPU::OpCodeBNNN< QUIRKS >,                           // JP V0, addr
+    &EightChipCPU::OpCodeCXKK,                                     // RND Vx, byte
+    &EightChipCPU::OpCodeDXYN< QUIRKS >,                           // DRW Vx, Vy, nibble
+    &EightChipCPU::OpCodeEX9E< QUIRKS >,                           // SKP Vx
+    &EightChipCPU::OpCodeEXA1< QUIRKS >,                           // SKNP Vx
+    &EightChipCPU::OpCodeFX07,                                     // LD Vx, DT
+    &EightChipCPU::OpCodeFX0A,                                     // LD Vx, K
+    &EightChipCPU::OpCodeFX15,                                     // LD DT, Vx
+    &EightChipCPU::OpCodeFX18,                                     // LD ST, Vx
+    &EightChipCPU::OpCodeFX1E,                                     // ADD I, Vx
+    &EightChipCPU::OpCodeFX29,                                     // LD F, Vx
+    &EightChipCPU::OpCodeFX33< QUIRKS >,                           // LD B, Vx
+    &EightChipCPU::OpCodeFX55< QUIRKS >,                           // LD [I], Vx
+    &EightChipCPU::OpCodeFX65< QUIRKS >,                           // LD Vx, [I]
+
+    // The extensions trap in the profiles without them
+    Supported< QUIRKS::SUPERCHIP_OPCODES >( &EightChipCPU::OpCode00CN ),  // SCD nibble
+    Supported< QUIRKS::SUPERCHIP_OPCODES >(
+        &EightChipCPU::OpCodeNoOperand< &EightChipCPU::OpCode00FB > ),  // SCR
+    Supported< QUIRKS::SUPERCHIP_OPCODES >(
+        &EightChipCPU::OpCodeNoOperand< &EightChipCPU::OpCode00FC > ),  // SCL
+    Supported< QUIRKS::SUPERCHIP_OPCODES >(
+        &EightChipCPU::OpCodeNoOperand< &EightChipCPU::OpCode00FD > ),  // EXIT
+    Supported< QUIRKS::SUPERCHIP_OPCODES >(
+        &EightChipCPU::OpCodeNoOperand< &EightChipCPU::OpCode00FE > ),  // LOW
+    Supported< QUIRKS::SUPERCHIP_OPCODES >(
+        &EightChipCPU::OpCodeNoOperand< &EightChipCPU::OpCode00FF > ),  // HIGH
+    Supported< QUIRKS::SUPERCHIP_OPCODES >( &EightChipCPU::OpCodeFX30 ),  // LD HF, Vx
+    Supported< QUIRKS::SUPERCHIP_OPCODES >( &EightChipCPU::OpCodeFX75 ),  // LD R, Vx
+    Supported< QUIRKS::SUPERCHIP_OPCODES >( &EightChipCPU::OpCodeFX85 ),  // LD Vx, R
+    Supported< QUIRKS::XOCHIP_OPCODES >( &EightChipCPU::OpCode00DN ),  // SCU nibble
+    Supported< QUIRKS::XOCHIP_OPCODES >( &EightChipCPU::OpCode5XY2< QUIRKS > ),  // SAVE Vx - Vy
+    Supported< QUIRKS::XOCHIP_OPCODES >( &EightChipCPU::OpCode5XY3< QUIRKS > ),  // LOAD Vx - Vy
+    Supported< QUIRKS::XOCHIP_OPCODES >(
+        &EightChipCPU::OpCodeNoOperand< &EightChipCPU::OpCodeF000 > ),  // LD I, long
+    Supported< QUIRKS::XOCHIP_OPCODES >( &EightChipCPU::OpCodeFN01 ),  // PLANE planes
+    Supported< QUIRKS::XOCHIP_OPCODES >(
+        &EightChipCPU::OpCodeNoOperand< &EightChipCPU::OpCodeF002< QUIRKS > > ),  // AUDIO
+    Supported< QUIRKS::XOCHIP_OPCODES >( &EightChipCPU::OpCodeFX3A ),  // PITCH Vx
+};
+
+//-------------------------------------------------------------------------------------------------
+// Instructions that can start a fused sequence, one bit per EightChipOpcodeId
+static const QWORD FUSION_HEADS = ( 1ULL << OP_6XKK ) | ( 1ULL << OP_7XKK ) | ( 1ULL << OP_ANNN )
+                                  | ( 1ULL << OP_FX07 ) | ( 1ULL << OP_FX29 );
+
+static_assert( OP_COUNT <= 64, "Fusion heads are a 64-bits mask" );
+
+//-------------------------------------------------------------------------------------------------
+/** The opcode at an address, without moving the PC or raising faults. */
+WORD
+EightChipCPU::PeekOpCode( WORD address ) const
+{
+    return ( m_GameMemory[ address ] << 8 ) | m_GameMemory[ ( address + 1 ) & ( ROMSIZE - 1 ) ];
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Fused sequences, the state they leave is the one their instructions would have left one by
+ * one, and none of them writes memory so what was peeked is what runs:
+ *  - ANNN; DXYN, FX29; DXYN and runs of 6XKK are dispatched once,
+ *  - FX07; 3XKK; 1NNN back to the FX07 waits for the delay timer, which only moves between
+ *    calls (see. DecreaseTimers), the whole budget goes round it,
+ *  - 7XKK; 3XKK; 1NNN back to the 7XKK counts Vx up to KK, the iterations are computed.
+ * The PC points past the opcode already fetched.
+ **/
+template < class QUIRKS >
+int
+EightChipCPU::RunFused( WORD opcode, EightChipOpcodeId id, int budget )
 {
-    switch ( opcode & 0xF )
+    WORD next = PeekOpCode( m_ProgramCounter );
+    int nextId = ecops::DECODE_TABLE.ids[ next ];
+
+    switch ( id )
+    {
+    case OP_ANNN:
+        if ( nextId == OP_DXYN )
+        {
+            OpCodeANNN( opcode );
+            OpCodeDXYN< QUIRKS >( GetNextOpCode( ) );
+            return 2;
+        }
+        break;
+
+    case OP_FX29:
+        if ( nextId == OP_DXYN )
+        {
+            OpCodeFX29( opcode );
+            OpCodeDXYN< QUIRKS >( GetNextOpCode( ) );
+            return 2;
+        }
+        break;
+
+    case OP_6XKK:
     {
-    case 0x0:
-        OpCode00E0( );
-        break;  // CLS
-    case 0xE:
-        OpCode00EE( );
-        break;  // RET
+        int count = 1;
+
+        OpCode6XKK( opcode );
+
+        while ( count < budget && nextId == OP_6XKK )
+        {
+            OpCode6XKK( GetNextOpCode( ) );
+            count++;
+
+            nextId = ecops::DECODE_TABLE.ids[ PeekOpCode( m_ProgramCounter ) ];
+        }
+
+        return count;
+    }
+
+    case OP_FX07:
+        return RunTimerWait( opcode, budget );
+
+    case OP_7XKK:
+        return RunCountingLoop( opcode, budget );
+
     default:
         break;
     }
+
+    ( this->*OPCODE_HANDLERS< QUIRKS >[ id ] )( opcode );
+
+    return 1;
 }
 
 //-------------------------------------------------------------------------------------------------
-// Execute OpCodes of MSB matching the value 8
-void
-EightChipCPU::DecodeOpCode8( WORD opcode )
+/** FX07; 3XKK; 1NNN, the loop is left when the delay timer reads KK. */
+int
+EightChipCPU::RunTimerWait( WORD opcode, int budget )
+{
+    WORD start = m_ProgramCounter - 2;
+    WORD compare = PeekOpCode( m_ProgramCounter );
+    int Vx = ( opcode & 0x0F00 ) >> 8;
+
+    bool isWait = start < 0x1000 && ( compare & 0xFF00 ) == ( 0x3000 | ( Vx << 8 ) )
+                  && PeekOpCode( m_ProgramCounter + 2 ) == ( 0x1000 | start );
+
+    OpCodeFX07( opcode );
+
+    if ( !isWait || m_DelayTimer == ( compare & 0x00FF ) )
+        return 1;
+
+    // Every time round is the same, only where the budget ends matters
+    m_ProgramCounter = start + 2 * ( budget % 3 );
+
+    return budget;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** 7XKK; 3XKK; 1NNN, the loop is left once Vx reaches the KK of the skip. */
+int
+EightChipCPU::RunCountingLoop( WORD opcode, int budget )
 {
-    switch ( opcode & 0xF )
+    WORD start = m_ProgramCounter - 2;
+    WORD compare = PeekOpCode( m_ProgramCounter );
+    int Vx = ( opcode & 0x0F00 ) >> 8;
+
+    bool isLoop = start < 0x1000 && ( compare & 0xFF00 ) == ( 0x3000 | ( Vx << 8 ) )
+                  && PeekOpCode( m_ProgramCounter + 2 ) == ( 0x1000 | start );
+
+    if ( !isLoop )
     {
-    case 0x0:
-        OpCode8XY0( opcode );
-        break;  // OR  Vx, Vy
-    case 0x1:
-        OpCode8XY1( opcode );
-        break;  // AND Vx, Vy
-    case 0x2:
-        OpCode8XY2( opcode );
-        break;  // XOR Vx, Vy
-    case 0x3:
-        OpCode8XY3( opcode );
-        break;  // ADD Vx, Vy
-    case 0x4:
-        OpCode8XY4( opcode );
-        break;  // SUB Vx,  Vy
-    case 0x5:
-        OpCode8XY5( opcode );
-        break;  // SHR Vx {, Vy}
-    case 0x6:
-        OpCode8XY6( opcode );
-        break;  // SUBN Vx, Vy
-    case 0x7:
-        OpCode8XY7( opcode );
-        break;  // SHL Vx {, Vy}
-    case 0xE:
-        OpCode8XYE( opcode );
-        break;  // SNE Vx, Vy
-    default:
-        break;
+        OpCode7XKK( opcode );
+        return 1;
+    }
+
+    BYTE step = opcode & 0x00FF;
+    BYTE target = compare & 0x00FF;
+    BYTE value = m_Registers[ Vx ];
+
+    // Times round until Vx reaches the target, the last one leaves after the skip. Vx goes
+    // through the same values every 256 times at most, 0 is never.
+    int rounds = 0;
+
+    for ( int i = 1; i <= 256 && rounds == 0; i++ )
+    {
+        if ( static_cast< BYTE >( value + i * step ) == target )
+            rounds = i;
     }
+
+    if ( rounds > 0 && 3 * rounds - 1 <= budget )
+    {
+        m_Registers[ Vx ] = target;
+        m_ProgramCounter = start + 6;
+
+        return 3 * rounds - 1;
+    }
+
+    // The budget ends before the loop does
+    int added = budget / 3 + ( ( budget % 3 ) > 0 );
+
+    m_Registers[ Vx ] = static_cast< BYTE >( value + added * step );
+    m_ProgramCounter = start + 2 * ( budget % 3 );
+
+    return budget;
 }
 
 //-------------------------------------------------------------------------------------------------
-// Execute OpCodes of MSB matching the value E
+/**
+ * The interpreter loop, instantiated once per quirk profile and per set of hooks.
+ * OpCodes are 16-bits long and the decode table has an entry for each of them, so every
+ * instruction costs one lookup and one indirect call. Opcodes that aren't instructions land on
+ * OpCodeIllegal.
+ * The hooks are compile time constants: the plain variant has no trace of them, the debug one
+ * asks the debugger before each instruction and stops as soon as it breaks, the trace one
+ * records each instruction and what it changed. The timing one takes count as machine cycles:
+ * each instruction is paid for before it runs, an overrun is paid back from the next budget, and
+ * a DXYN ends the budget until the next frame.
+ * Only the plain variant fuses instructions (see. RunFused), the others see each one of them.
+ **/
+template < class QUIRKS >
 void
-EightChipCPU::DecodeOpCodeE( WORD opcode )
+EightChipCPU::RunOpCodes( int count )
 {
-    switch ( opcode & 0xF )
+    const int hooks = ecquirks::HooksOf< QUIRKS >::value;
+
+    if ( hooks & HOOKS_TIMING )
     {
-    case 0xE:
-        OpCodeEX9E( opcode );
-        break;  // SKP Vx
-    case 0x1:
-        OpCodeEXA1( opcode );
-        break;  // SKNP Vx
-    default:
-        break;
+        // The VIP idles until the display interrupt, the cycles of the wait are lost
+        if ( m_WaitingFrame )
+        {
+            m_CycleBalance = std::min( m_CycleBalance, 0 );
+            return;
+        }
+
+        m_CycleBalance += count;
+    }
+
+    for ( int i = 0; ( hooks & HOOKS_TIMING ) ? m_CycleBalance > 0 : i < count; i++ )
+    {
+        if ( ( hooks & HOOKS_DEBUG ) && m_Debugger->OnInstruction( *this ) )
+            return;
+
+        if ( hooks & HOOKS_COVERAGE )
+            m_Coverage->OnInstruction( m_ProgramCounter & ( ROMSIZE - 1 ) );
+
+        WORD opcode = GetNextOpCode( );
+        EightChipOpcodeId id =
+            static_cast< EightChipOpcodeId >( ecops::DECODE_TABLE.ids[ opcode ] );
+
+        if ( hooks == HOOKS_NONE && ( ( FUSION_HEADS >> id ) & 1 ) && count - i > 1 )
+        {
+            i += RunFused< QUIRKS >( opcode, id, count - i ) - 1;
+            continue;
+        }
+
+        if ( hooks & HOOKS_TRACE )
+            m_Tracer->OnInstruction( *this, opcode );
+
+        if ( hooks & HOOKS_TIMING )
+            m_CycleBalance -= ectiming::GetCycles( *this, opcode, id );
+
+        ( this->*OPCODE_HANDLERS< QUIRKS >[ id ] )( opcode );
+
+        if ( hooks & HOOKS_TRACE )
+            m_Tracer->OnInstructionDone( *this );
+
+        // A watchpoint hit during the instruction
+        if ( ( hooks & HOOKS_DEBUG ) && m_Debugger->IsStopped( ) )
+            return;
+
+        if ( ( hooks & HOOKS_TIMING ) && id == OP_DXYN )
+        {
+            m_WaitingFrame = true;
+            m_CycleBalance = std::min( m_CycleBalance, 0 );
+            return;
+        }
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-// Execute OpCodes of last two MSB matching the value F
+/** Indexed by EightChipHooks, one table per quirk profile. */
+template < class QUIRKS >
+const EightChipCPU::OPCODE_RUNNER EightChipCPU::HOOKED_RUNNERS[ HOOKS_ALL + 1 ] = {
+    &EightChipCPU::RunOpCodes< QUIRKS >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_DEBUG > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_TRACE > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_DEBUG | HOOKS_TRACE > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_TIMING > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_TIMING | HOOKS_DEBUG > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_TIMING | HOOKS_TRACE > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_ALL & ~HOOKS_COVERAGE > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_COVERAGE > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_COVERAGE | HOOKS_DEBUG > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_COVERAGE | HOOKS_TRACE > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_ALL & ~HOOKS_TIMING > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_COVERAGE | HOOKS_TIMING > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_ALL & ~HOOKS_TRACE > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_ALL & ~HOOKS_DEBUG > >,
+    &EightChipCPU::RunOpCodes< ecquirks::Hooked< QUIRKS, HOOKS_ALL > >,
+};
+
+// Indexed by EightChipProfile
+const EightChipCPU::OPCODE_RUNNER* const EightChipCPU::PROFILE_RUNNERS[ PROFILE_COUNT ] = {
+    EightChipCPU::HOOKED_RUNNERS< ecquirks::EightChip >,
+    EightChipCPU::HOOKED_RUNNERS< ecquirks::Chip8 >,
+    EightChipCPU::HOOKED_RUNNERS< ecquirks::SuperChip >,
+    EightChipCPU::HOOKED_RUNNERS< ecquirks::XoChip >,
+};
+
+//-------------------------------------------------------------------------------------------------
+// Indexed by EightChipProfile
+const EightChipCPU::OPCODE_HANDLER* const EightChipCPU::PROFILE_HANDLERS[ PROFILE_COUNT ] = {
+    EightChipCPU::OPCODE_HANDLERS< ecquirks::EightChip >,
+    EightChipCPU::OPCODE_HANDLERS< ecquirks::Chip8 >,
+    EightChipCPU::OPCODE_HANDLERS< ecquirks::SuperChip >,
+    EightChipCPU::OPCODE_HANDLERS< ecquirks::XoChip >,
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The quirks and hooks are only looked up here and never while executing. */
 void
-EightChipCPU::DecodeOpCodeF( WORD opcode )
+EightChipCPU::SelectRunner( )
 {
-    switch ( opcode & 0xFF )
-    {
-    case 0x07:
-        OpCodeFX07( opcode );
-        break;  // LD Vx, DT
-    case 0x0A:
-        OpCodeFX0A( opcode );
-        break;  // LD Vx, k
-    case 0x15:
-        OpCodeFX15( opcode );
-        break;  // LD DT, Vx
-    case 0x18:
-        OpCodeFX18( opcode );
-        break;  // LD ST, Vx
-    case 0x1E:
-        OpCodeFX1E( opcode );
-        break;  // ADD I, Vx
-    case 0x29:
-        OpCodeFX29( opcode );
-        break;  // LD F, Vx
-    case 0x33:
-        OpCodeFX33( opcode );
-        break;  // LD B, Vx
-    case 0x55:
-        OpCodeFX55( opcode );
-        break;  // LD [I], Vx
-    case 0x65:
-        OpCodeFX65( opcode );
-        break;  // LD Vx, [I]
-    default:
-        break;
-    }
+    m_RunOpCodes = PROFILE_RUNNERS[ m_Profile ][ m_Hooks ];
+    m_RunCycles = PROFILE_RUNNERS[ m_Profile ][ m_Hooks | HOOKS_TIMING ];
+    m_Handlers = PROFILE_HANDLERS[ m_Profile ];
 }
 
 //-------------------------------------------------------------------------------------------------
-/**
- * This method reads the OpCode from the next 16-bits memory block by evaluating the MSB
- * then executes the corresponding OpCode function.
- * As it should be noted, the Most Significant Bit 'was' stored first.
- **/
+void
+EightChipCPU::SetProfile( EightChipProfile profile )
+{
+    m_Profile = profile;
+    SelectRunner( );
+}
+
+EightChipProfile
+EightChipCPU::GetProfile( ) const
+{
+    return m_Profile;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipCPU::SetDebugger( EightChipDebugger* debugger )
+{
+    m_Debugger = debugger;
+
+    if ( debugger != nullptr )
+        m_Hooks |= HOOKS_DEBUG;
+    else
+        m_Hooks &= ~HOOKS_DEBUG;
+
+    SelectRunner( );
+}
+
+EightChipDebugger*
+EightChipCPU::GetDebugger( ) const
+{
+    return m_Debugger;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipCPU::SetTracer( EightChipTracer* tracer )
+{
+    m_Tracer = tracer;
+
+    if ( tracer != nullptr )
+        m_Hooks |= HOOKS_TRACE;
+    else
+        m_Hooks &= ~HOOKS_TRACE;
+
+    SelectRunner( );
+}
+
+EightChipTracer*
+EightChipCPU::GetTracer( ) const
+{
+    return m_Tracer;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipCPU::SetCoverage( EightChipCoverage* coverage )
+{
+    m_Coverage = coverage;
+
+    if ( coverage != nullptr )
+        m_Hooks |= HOOKS_COVERAGE;
+    else
+        m_Hooks &= ~HOOKS_COVERAGE;
+
+    SelectRunner( );
+}
+
+EightChipCoverage*
+EightChipCPU::GetCoverage( ) const
+{
+    return m_Coverage;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Executes the next instruction. */
 void
 EightChipCPU::ExecuteNextOpCode( )
 {
-    // Gets the value of the current OpCode
-    WORD opcode = GetNextOpCode( );
+    ( this->*m_RunOpCodes )( 1 );
+}
 
-    // Evaluate and execute.
-    switch ( opcode & 0xF000 )
-    {
-    case 0x0000:
-        DecodeOpCode0( opcode );
-        break;  // see. DecodeOpCode0 definition
-    case 0x1000:
-        OpCode1KKK( opcode );
-        break;  // JP addr
-    case 0x2000:
-        OpCode2KKK( opcode );
-        break;  // CALL addr
-    case 0x3000:
-        OpCode3XKK( opcode );
-        break;  // SE Vx, byte
-    case 0x4000:
-        OpCode4XKK( opcode );
-        break;  // SNE Vx, byte
-    case 0x5000:
-        OpCode5XY0( opcode );
-        break;  // SE Vx, Vy
-    case 0x6000:
-        OpCode6XKK( opcode );
-        break;  // LD Vx, byte
-    case 0x7000:
-        OpCode7XKK( opcode );
-        break;  // ADD Vx, byte
-    case 0x8000:
-        DecodeOpCode8( opcode );
-        break;  // see. DecodeOpCode8 definition
-    case 0x9000:
-        OpCode9XY0( opcode );
-        break;  // SNE Vx, Vy
-    case 0xA000:
-        OpCodeANNN( opcode );
-        break;  // LD I, addr
-    case 0xB000:
-        OpCodeBNNN( opcode );
-        break;  // JP V0, addr
-    case 0xC000:
-        OpCodeCXKK( opcode );
-        break;  // RND Vx, byte
-    case 0xD000:
-        OpCodeDXYN( opcode );
-        break;  // DRW Vx, Vy, nibble
-    case 0xE000:
-        DecodeOpCodeE( opcode );
-        break;  // see. DecodeOpCodeE definition
-    case 0xF000:
-        DecodeOpCodeF( opcode );
-        break;  // see. DecodeOpCodeF definition
-    default:
-        break;
-    }
+//-------------------------------------------------------------------------------------------------
+/** Executes count instructions without leaving the interpreter loop, the cheaper way to run a
+ * frame.
+ */
+void
+EightChipCPU::ExecuteOpCodes( int count )
+{
+    ( this->*m_RunOpCodes )( count );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Executes instructions until their cost reaches the budget, or until a DXYN. */
+void
+EightChipCPU::ExecuteCycles( int cycles )
+{
+    ( this->*m_RunCycles )( cycles );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipCPU::ExecuteFetchedOpCode( WORD opcode )
+{
+    ( this->*m_Handlers[ ecops::DECODE_TABLE.ids[ opcode ] ] )( opcode );
 }
 
-//-------------------------------------------------------------------------------------------------
\ No newline at end of file
+//-------------------------------------------------------------------------------------------------
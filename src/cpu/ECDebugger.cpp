@@ -0,0 +1,489 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+#include "ECDebugger.h"
+#include "ECOpcodes.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipDebugger::EightChipDebugger( )
+    : m_Breakpoints( ROMSIZE, 0 )
+    , m_Watchpoints( ROMSIZE, 0 )
+    , m_Mode( MODE_RUN )
+    , m_Stopped( false )
+    , m_Reason( BREAK_NONE )
+    , m_Address( 0 )
+    , m_Resuming( false )
+    , m_ReturnAddress( 0 )
+    , m_ReturnDepth( 0 )
+    , m_Faults( FAULT_NONE )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipDebugger::AddBreakpoint( WORD address )
+{
+    m_Breakpoints[ address & ( ROMSIZE - 1 ) ] = 1;
+}
+
+void
+EightChipDebugger::RemoveBreakpoint( WORD address )
+{
+    m_Breakpoints[ address & ( ROMSIZE - 1 ) ] = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipDebugger::SetWatchpoint( WORD address, int access )
+{
+    m_Watchpoints[ address & ( ROMSIZE - 1 ) ] = static_cast< BYTE >( access );
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+EightChipDebugger::AddCondition( const EightChipCondition& condition )
+{
+    m_Conditions.push_back( condition );
+
+    // A condition already true when it's added waits for the next time it becomes true
+    m_ConditionsHeld.push_back( 1 );
+
+    return static_cast< int >( m_Conditions.size( ) ) - 1;
+}
+
+void
+EightChipDebugger::RemoveCondition( int index )
+{
+    if ( index < 0 || index >= static_cast< int >( m_Conditions.size( ) ) )
+        return;
+
+    m_Conditions.erase( m_Conditions.begin( ) + index );
+    m_ConditionsHeld.erase( m_ConditionsHeld.begin( ) + index );
+}
+
+const std::vector< EightChipCondition >&
+EightChipDebugger::GetConditions( ) const
+{
+    return m_Conditions;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipDebugger::ClearAll( )
+{
+    std::fill( m_Breakpoints.begin( ), m_Breakpoints.end( ), 0 );
+    std::fill( m_Watchpoints.begin( ), m_Watchpoints.end( ), 0 );
+
+    m_Conditions.clear( );
+    m_ConditionsHeld.clear( );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipDebugger::Pause( )
+{
+    // The PC is only known once the CPU asks for the next instruction
+    if ( !m_Stopped )
+        m_Mode = MODE_PAUSE;
+}
+
+void
+EightChipDebugger::Continue( )
+{
+    m_Mode = MODE_RUN;
+    m_Stopped = false;
+    m_Resuming = true;
+}
+
+void
+EightChipDebugger::Step( )
+{
+    m_Mode = MODE_STEP;
+    m_Stopped = false;
+    m_Resuming = true;
+}
+
+void
+EightChipDebugger::StepOver( )
+{
+    m_Mode = MODE_STEP_OVER;
+    m_Stopped = false;
+    m_Resuming = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipDebugger::IsStopped( ) const
+{
+    return m_Stopped;
+}
+
+EightChipBreakReason
+EightChipDebugger::GetReason( ) const
+{
+    return m_Reason;
+}
+
+WORD
+EightChipDebugger::GetAddress( ) const
+{
+    return m_Address;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipDebugger::Stop( EightChipBreakReason reason, WORD address )
+{
+    m_Stopped = true;
+    m_Reason = reason;
+    m_Address = address;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipDebugger::Evaluate( const EightChipCondition& condition,
+                             const EightChipState& state ) const
+{
+    int value = ( condition.reg == CONDITION_REGISTER_I )
+                    ? state.m_AddressI
+                    : state.m_Registers[ condition.reg & 0xF ];
+
+    return eccompare::Holds( value, condition.compare, condition.value );
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Everything that stops before an instruction is checked here: stepping, faults raised by the
+ * previous instruction, conditions and breakpoints. The instruction the CPU resumes from is let
+ * through once, otherwise a breakpoint under the PC would never let go.
+ */
+bool
+EightChipDebugger::OnInstruction( const EightChipState& state )
+{
+    if ( m_Stopped )
+        return true;
+
+    WORD pc = state.m_ProgramCounter & ( ROMSIZE - 1 );
+    bool resuming = m_Resuming;
+    m_Resuming = false;
+
+    m_Address = pc;
+
+    // Faults are latched by the CPU, only the new ones stop it
+    if ( state.m_Faults & ~m_Faults )
+    {
+        m_Faults = state.m_Faults;
+        Stop( BREAK_FAULT, pc );
+        return true;
+    }
+
+    m_Faults = state.m_Faults;
+
+    switch ( m_Mode )
+    {
+    case MODE_PAUSE:
+        m_Mode = MODE_RUN;
+        Stop( BREAK_PAUSE, pc );
+        return true;
+
+    case MODE_STEP:
+        if ( !resuming )
+        {
+            Stop( BREAK_STEP, pc );
+            return true;
+        }
+        break;
+
+    case MODE_STEP_OVER:
+    {
+        // Only a call is stepped over, anything else is a plain step. Every profile has CALL.
+        WORD opcode = ( state.m_GameMemory[ pc ] << 8 )
+                      | state.m_GameMemory[ ( pc + 1 ) & ( ROMSIZE - 1 ) ];
+
+        if ( ecops::GetInfo( ecops::Identify( opcode, PROFILE_EIGHTCHIP ) ).flags & OPF_CALL )
+        {
+            m_Mode = MODE_RUN_CALL;
+            m_ReturnAddress = static_cast< WORD >( pc + 2 );
+            m_ReturnDepth = state.m_StackPointer;
+        }
+        else
+        {
+            m_Mode = MODE_STEP;
+        }
+        break;
+    }
+
+    case MODE_RUN_CALL:
+        // Back at the call's return address with the stack as it was: the call is over, a
+        // recursive call coming back through the same address isn't
+        if ( pc == m_ReturnAddress && state.m_StackPointer == m_ReturnDepth )
+        {
+            Stop( BREAK_STEP, pc );
+            return true;
+        }
+        break;
+
+    case MODE_RUN:
+        break;
+    }
+
+    bool stop = false;
+
+    for ( size_t i = 0; i < m_Conditions.size( ); i++ )
+    {
+        bool held = Evaluate( m_Conditions[ i ], state );
+
+        if ( held && !m_ConditionsHeld[ i ] )
+            stop = true;
+
+        m_ConditionsHeld[ i ] = held;
+    }
+
+    if ( !resuming && stop )
+    {
+        Stop( BREAK_CONDITION, pc );
+        return true;
+    }
+
+    if ( !resuming && m_Breakpoints[ pc ] )
+    {
+        Stop( BREAK_POINT, pc );
+        return true;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The instruction completes, the CPU stops right after it. */
+void
+EightChipDebugger::OnRead( WORD address )
+{
+    if ( m_Watchpoints[ address ] & WATCHPOINT_READ )
+        Stop( BREAK_READ, address );
+}
+
+void
+EightChipDebugger::OnWrite( WORD address )
+{
+    if ( m_Watchpoints[ address ] & WATCHPOINT_WRITE )
+        Stop( BREAK_WRITE, address );
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string
+ecdebug::DescribeStop( const EightChipDebugger& debugger )
+{
+    static const char* REASONS[] = {
+        "running", "paused", "stepped", "breakpoint", "read watchpoint", "write watchpoint",
+        "condition", "fault",
+    };
+
+    char res[ 64 ];
+    snprintf( res, sizeof( res ), "%s at 0x%04X", REASONS[ debugger.GetReason( ) ],
+              debugger.GetAddress( ) );
+
+    return res;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+ecdebug::PrintRegisters( const EightChipCPU& cpu, std::ostream& out )
+{
+    const EightChipState& state = cpu.GetState( );
+    char line[ 128 ];
+
+    for ( int i = 0; i < 16; i++ )
+    {
+        snprintf( line,
+                  sizeof( line ),
+                  "V%X=%02X%s",
+                  i,
+                  state.m_Registers[ i ],
+                  ( i == 15 ) ? "\n" : " " );
+        out << line;
+    }
+
+    WORD pc = state.m_ProgramCounter & ( ROMSIZE - 1 );
+    WORD opcode = ( state.m_GameMemory[ pc ] << 8 )
+                  | state.m_GameMemory[ ( pc + 1 ) & ( ROMSIZE - 1 ) ];
+
+    snprintf( line, sizeof( line ), "PC=%04X I=%04X SP=%X DT=%02X ST=%02X faults=%X  %04X %s\n",
+              state.m_ProgramCounter, state.m_AddressI, state.m_StackPointer, state.m_DelayTimer,
+              state.m_SoundTimer, state.m_Faults, opcode, ecops::Disassemble( opcode ).c_str( ) );
+    out << line;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Addresses and values are hexadecimal, with or without 0x. */
+static bool
+ParseHex( std::istream& in, int& value )
+{
+    std::string token;
+
+    if ( !( in >> token ) )
+        return false;
+
+    char* end;
+    value = static_cast< int >( strtol( token.c_str( ), &end, 16 ) );
+
+    return *end == '\0';
+}
+
+//-------------------------------------------------------------------------------------------------
+static bool
+ParseCondition( std::istream& in, EightChipCondition& condition )
+{
+    std::string reg, compare;
+
+    if ( !( in >> reg >> compare ) || !ParseHex( in, condition.value ) )
+        return false;
+
+    if ( reg == "I" || reg == "i" )
+        condition.reg = CONDITION_REGISTER_I;
+    else if ( reg.size( ) == 2 && ( reg[ 0 ] == 'V' || reg[ 0 ] == 'v' ) && isxdigit( reg[ 1 ] ) )
+        condition.reg = static_cast< int >( strtol( reg.c_str( ) + 1, nullptr, 16 ) );
+    else
+        return false;
+
+    if ( compare == "==" )
+        condition.compare = COMPARE_EQUAL;
+    else if ( compare == "!=" )
+        condition.compare = COMPARE_NOT_EQUAL;
+    else if ( compare == "<" )
+        condition.compare = COMPARE_LESS;
+    else if ( compare == "<=" )
+        condition.compare = COMPARE_LESS_EQUAL;
+    else if ( compare == ">" )
+        condition.compare = COMPARE_GREATER;
+    else if ( compare == ">=" )
+        condition.compare = COMPARE_GREATER_EQUAL;
+    else
+        return false;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecdebug::RunCommand( EightChipDebugger& debugger,
+                     const EightChipCPU& cpu,
+                     const std::string& line,
+                     std::ostream& out )
+{
+    std::istringstream in( line );
+    std::string command;
+
+    if ( !( in >> command ) )
+        return true;
+
+    const EightChipState& state = cpu.GetState( );
+    int address = 0;
+
+    if ( command == "q" )
+        return false;
+
+    if ( command == "c" )
+        debugger.Continue( );
+    else if ( command == "s" )
+        debugger.Step( );
+    else if ( command == "n" )
+        debugger.StepOver( );
+    else if ( command == "r" )
+        PrintRegisters( cpu, out );
+    else if ( command == "b" && ParseHex( in, address ) )
+        debugger.AddBreakpoint( static_cast< WORD >( address ) );
+    else if ( command == "bd" && ParseHex( in, address ) )
+        debugger.RemoveBreakpoint( static_cast< WORD >( address ) );
+    else if ( command == "wd" && ParseHex( in, address ) )
+        debugger.SetWatchpoint( static_cast< WORD >( address ), 0 );
+    else if ( command == "w" && ParseHex( in, address ) )
+    {
+        std::string access = "rw";
+        in >> access;
+
+        int mask = ( ( access.find( 'r' ) != std::string::npos ) ? WATCHPOINT_READ : 0 )
+                   | ( ( access.find( 'w' ) != std::string::npos ) ? WATCHPOINT_WRITE : 0 );
+
+        debugger.SetWatchpoint( static_cast< WORD >( address ), mask );
+    }
+    else if ( command == "cond" )
+    {
+        EightChipCondition condition;
+
+        if ( ParseCondition( in, condition ) )
+            out << "condition " << debugger.AddCondition( condition ) << "\n";
+        else
+            out << "usage: cond V0-VF|I ==|!=|<|<=|>|>= VALUE\n";
+    }
+    else if ( command == "condd" )
+    {
+        int index;
+
+        if ( in >> index )
+            debugger.RemoveCondition( index );
+    }
+    else if ( command == "x" && ParseHex( in, address ) )
+    {
+        int count = 16;
+        ParseHex( in, count );
+
+        char field[ 16 ];
+
+        for ( int i = 0; i < count; i++ )
+        {
+            if ( i % 16 == 0 )
+            {
+                snprintf( field,
+                          sizeof( field ),
+                          "%s%04X:",
+                          ( i > 0 ) ? "\n" : "",
+                          ( address + i ) & 0xFFFF );
+                out << field;
+            }
+
+            snprintf( field,
+                      sizeof( field ),
+                      " %02X",
+                      state.m_GameMemory[ ( address + i ) & ( ROMSIZE - 1 ) ] );
+            out << field;
+        }
+
+        out << "\n";
+    }
+    else if ( command == "l" )
+    {
+        address = state.m_ProgramCounter;
+        ParseHex( in, address );
+
+        char field[ 16 ];
+
+        for ( int i = 0; i < 8; i++ )
+        {
+            WORD opcode = ( state.m_GameMemory[ address & ( ROMSIZE - 1 ) ] << 8 )
+                          | state.m_GameMemory[ ( address + 1 ) & ( ROMSIZE - 1 ) ];
+            WORD operand = ( state.m_GameMemory[ ( address + 2 ) & ( ROMSIZE - 1 ) ] << 8 )
+                           | state.m_GameMemory[ ( address + 3 ) & ( ROMSIZE - 1 ) ];
+
+            snprintf( field,
+                      sizeof( field ),
+                      "%c%04X  ",
+                      ( address == state.m_ProgramCounter ) ? '>' : ' ',
+                      address & 0xFFFF );
+            out << field << ecops::Disassemble( opcode, operand ) << "\n";
+
+            address += ecops::GetLength( opcode, cpu.GetProfile( ) );
+        }
+    }
+    else
+    {
+        out << "commands: b bd w wd cond condd c s n r x l q\n";
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <cstring>
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#define EIGHTCHIP_SSE2
+#endif
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#define EIGHTCHIP_AVX2
+#endif
+
+#include "ECDisplay.h"
+
+//-------------------------------------------------------------------------------------------------
+void
+ecdisplay::Clear( EightChipPlane& plane )
+{
+    memset( plane.rows, 0, sizeof( plane.rows ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+ecdisplay::ScrollDown( EightChipPlane& plane, int rows )
+{
+    if ( rows >= DISPLAY_HEIGHT )
+    {
+        Clear( plane );
+        return;
+    }
+
+    memmove( plane.rows[ rows ],
+             plane.rows[ 0 ],
+             sizeof( plane.rows[ 0 ] ) * ( DISPLAY_HEIGHT - rows ) );
+    memset( plane.rows[ 0 ], 0, sizeof( plane.rows[ 0 ] ) * rows );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+ecdisplay::ScrollUp( EightChipPlane& plane, int rows )
+{
+    if ( rows >= DISPLAY_HEIGHT )
+    {
+        Clear( plane );
+        return;
+    }
+
+    memmove( plane.rows[ 0 ],
+             plane.rows[ rows ],
+             sizeof( plane.rows[ 0 ] ) * ( DISPLAY_HEIGHT - rows ) );
+    memset( plane.rows[ DISPLAY_HEIGHT - rows ], 0, sizeof( plane.rows[ 0 ] ) * rows );
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Moving a row left shifts both halves left and carries the top bits of the right half into the
+ * left one. With SSE2 the row is one register: the halves sit in the low (left) and high (right)
+ * lanes, so the carry is the high lane moved down by 8 bytes.
+ */
+void
+ecdisplay::ScrollLeft( EightChipPlane& plane, int pixels )
+{
+#ifdef EIGHTCHIP_SSE2
+    const __m128i shift = _mm_cvtsi32_si128( pixels );
+    const __m128i carry = _mm_cvtsi32_si128( 64 - pixels );
+
+    for ( int y = 0; y < DISPLAY_HEIGHT; y++ )
+    {
+        __m128i* row = reinterpret_cast< __m128i* >( plane.rows[ y ] );
+        __m128i value = _mm_load_si128( row );
+
+        value = _mm_or_si128( _mm_sll_epi64( value, shift ),
+                              _mm_srl_epi64( _mm_srli_si128( value, 8 ), carry ) );
+        _mm_store_si128( row, value );
+    }
+#else
+    for ( int y = 0; y < DISPLAY_HEIGHT; y++ )
+    {
+        QWORD* row = plane.rows[ y ];
+
+        row[ 0 ] = ( row[ 0 ] << pixels ) | ( row[ 1 ] >> ( 64 - pixels ) );
+        row[ 1 ] <<= pixels;
+    }
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Mirror of ScrollLeft: the low bits of the left half are carried into the right one. */
+void
+ecdisplay::ScrollRight( EightChipPlane& plane, int pixels )
+{
+#ifdef EIGHTCHIP_SSE2
+    const __m128i shift = _mm_cvtsi32_si128( pixels );
+    const __m128i carry = _mm_cvtsi32_si128( 64 - pixels );
+
+    for ( int y = 0; y < DISPLAY_HEIGHT; y++ )
+    {
+        __m128i* row = reinterpret_cast< __m128i* >( plane.rows[ y ] );
+        __m128i value = _mm_load_si128( row );
+
+        value = _mm_or_si128( _mm_srl_epi64( value, shift ),
+                              _mm_sll_epi64( _mm_slli_si128( value, 8 ), carry ) );
+        _mm_store_si128( row, value );
+    }
+#else
+    for ( int y = 0; y < DISPLAY_HEIGHT; y++ )
+    {
+        QWORD* row = plane.rows[ y ];
+
+        row[ 1 ] = ( row[ 1 ] >> pixels ) | ( row[ 0 ] << ( 64 - pixels ) );
+        row[ 0 ] >>= pixels;
+    }
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The sprite row is shifted right by x across the 128 bits of the row, then XOR'd in. Wrapping
+ * turns the shift into a rotation.
+ */
+template < bool WRAP >
+bool
+ecdisplay::XorRow( EightChipPlane& plane, int y, int x, QWORD bits )
+{
+    if ( !WRAP && y >= DISPLAY_HEIGHT )
+        return false;
+
+    QWORD left = bits;
+    QWORD right = 0;
+
+    x &= DISPLAY_WIDTH - 1;
+
+    if ( x >= 64 )
+    {
+        right = left;
+        left = 0;
+        x -= 64;
+    }
+
+    if ( x > 0 )
+    {
+        QWORD spill = WRAP ? right << ( 64 - x ) : 0;
+
+        right = ( right >> x ) | ( left << ( 64 - x ) );
+        left = ( left >> x ) | spill;
+    }
+
+    QWORD* row = plane.rows[ y & ( DISPLAY_HEIGHT - 1 ) ];
+    bool collision = ( ( row[ 0 ] & left ) | ( row[ 1 ] & right ) ) != 0;
+
+    row[ 0 ] ^= left;
+    row[ 1 ] ^= right;
+
+    return collision;
+}
+
+template bool ecdisplay::XorRow< true >( EightChipPlane&, int, int, QWORD );
+template bool ecdisplay::XorRow< false >( EightChipPlane&, int, int, QWORD );
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecdisplay::GetPixel( const EightChipPlane& plane, int x, int y )
+{
+    return ( plane.rows[ y ][ x >> 6 ] >> ( 63 - ( x & 63 ) ) ) & 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+ecdisplay::GetColour( const EightChipPlane planes[ DISPLAY_PLANES ], int x, int y )
+{
+    int colour = 0;
+
+    for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+        colour |= GetPixel( planes[ plane ], x, y ) << plane;
+
+    return colour;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** FNV-1a over the pixels, row by row from the most significant bit: the same on any host. */
+QWORD
+ecdisplay::Hash( const EightChipPlane planes[ DISPLAY_PLANES ] )
+{
+    QWORD hash = 0xCBF29CE484222325ULL;
+
+    for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+    {
+        for ( int y = 0; y < DISPLAY_HEIGHT; y++ )
+        {
+            for ( int half = 0; half < 2; half++ )
+            {
+                QWORD pixels = planes[ plane ].rows[ y ][ half ];
+
+                for ( int shift = 56; shift >= 0; shift -= 8 )
+                {
+                    hash ^= ( pixels >> shift ) & 0xFF;
+                    hash *= 0x100000001B3ULL;
+                }
+            }
+        }
+    }
+
+    return hash;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The pixel's bytes are laid out R, G, B, A whatever the endianness. */
+static DWORD
+MakePixel( const BYTE rgb[ 3 ] )
+{
+    const BYTE bytes[ 4 ] = { rgb[ 0 ], rgb[ 1 ], rgb[ 2 ], 0xFF };
+    DWORD pixel;
+
+    memcpy( &pixel, bytes, sizeof( pixel ) );
+
+    return pixel;
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipPalette
+ecdisplay::MakePalette( const BYTE background[ 3 ], const BYTE foreground[ 3 ] )
+{
+    EightChipPalette palette;
+
+    palette.colours[ 0 ] = MakePixel( background );
+
+    for ( int colour = 1; colour < ( 1 << DISPLAY_PLANES ); colour++ )
+        palette.colours[ colour ] = MakePixel( foreground );
+
+    return palette;
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipPalette
+ecdisplay::MakePalette( const BYTE colours[ 1 << DISPLAY_PLANES ][ 3 ] )
+{
+    EightChipPalette palette;
+
+    for ( int colour = 0; colour < ( 1 << DISPLAY_PLANES ); colour++ )
+        palette.colours[ colour ] = MakePixel( colours[ colour ] );
+
+    return palette;
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Row y of plane 0 at one pixel per bit, for rows no other plane draws on. Each bit is compared
+ * against a mask per lane and the comparison picks the foreground or the background, 4 (SSE2)
+ * or 8 (AVX2) pixels per store.
+ */
+static void
+ExpandMonoLine( const QWORD row[ 2 ], DWORD background, DWORD foreground, DWORD* line )
+{
+#if defined( EIGHTCHIP_AVX2 )
+    const __m256i lanes = _mm256_setr_epi32( 0x80000000, 0x40000000, 0x20000000, 0x10000000,
+                                             0x08000000, 0x04000000, 0x02000000, 0x01000000 );
+    const __m256i back = _mm256_set1_epi32( background );
+    const __m256i fore = _mm256_set1_epi32( foreground );
+
+    for ( int chunk = 0; chunk < DISPLAY_WIDTH / 32; chunk++ )
+    {
+        DWORD bits = static_cast< DWORD >( row[ chunk >> 1 ] >> ( ( ~chunk & 1 ) * 32 ) );
+        __m256i value = _mm256_set1_epi32( bits );
+
+        for ( int x = 0; x < 32; x += 8 )
+        {
+            __m256i lit = _mm256_cmpeq_epi32( _mm256_and_si256( value, lanes ), lanes );
+
+            _mm256_storeu_si256( reinterpret_cast< __m256i* >( line + chunk * 32 + x ),
+                                 _mm256_blendv_epi8( back, fore, lit ) );
+
+            value = _mm256_slli_epi32( value, 8 );
+        }
+    }
+#elif defined( EIGHTCHIP_SSE2 )
+    const __m128i lanes = _mm_setr_epi32( 0x80000000, 0x40000000, 0x20000000, 0x10000000 );
+    const __m128i back = _mm_set1_epi32( background );
+    const __m128i fore = _mm_set1_epi32( foreground );
+
+    for ( int chunk = 0; chunk < DISPLAY_WIDTH / 32; chunk++ )
+    {
+        DWORD bits = static_cast< DWORD >( row[ chunk >> 1 ] >> ( ( ~chunk & 1 ) * 32 ) );
+        __m128i value = _mm_set1_epi32( bits );
+
+        for ( int x = 0; x < 32; x += 4 )
+        {
+            __m128i lit = _mm_cmpeq_epi32( _mm_and_si128( value, lanes ), lanes );
+            __m128i pixels =
+                _mm_or_si128( _mm_and_si128( lit, fore ), _mm_andnot_si128( lit, back ) );
+
+            _mm_storeu_si128( reinterpret_cast< __m128i* >( line + chunk * 32 + x ), pixels );
+
+            value = _mm_slli_epi32( value, 4 );
+        }
+    }
+#else
+    for ( int x = 0; x < DISPLAY_WIDTH; x++ )
+        line[ x ] = ( ( row[ x >> 6 ] >> ( 63 - ( x & 63 ) ) ) & 1 ) ? foreground : background;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Row y at one pixel per bit, looking every pixel's plane combination up in the palette. With
+ * AVX2 the combinations of 8 pixels are built side by side and gathered in one go.
+ */
+static void
+ExpandColourLine( const EightChipPlane planes[ DISPLAY_PLANES ],
+                  int y,
+                  const EightChipPalette& palette,
+                  DWORD* line )
+{
+#if defined( EIGHTCHIP_AVX2 )
+    const __m256i lanes = _mm256_setr_epi32( 0x80000000, 0x40000000, 0x20000000, 0x10000000,
+                                             0x08000000, 0x04000000, 0x02000000, 0x01000000 );
+    const int* colours = reinterpret_cast< const int* >( palette.colours );
+
+    for ( int chunk = 0; chunk < DISPLAY_WIDTH / 32; chunk++ )
+    {
+        __m256i value[ DISPLAY_PLANES ];
+
+        for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+        {
+            QWORD bits = planes[ plane ].rows[ y ][ chunk >> 1 ] >> ( ( ~chunk & 1 ) * 32 );
+            value[ plane ] = _mm256_set1_epi32( static_cast< DWORD >( bits ) );
+        }
+
+        for ( int x = 0; x < 32; x += 8 )
+        {
+            __m256i index = _mm256_setzero_si256( );
+
+            for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+            {
+                __m256i lit =
+                    _mm256_cmpeq_epi32( _mm256_and_si256( value[ plane ], lanes ), lanes );
+
+                index = _mm256_or_si256( index,
+                                         _mm256_and_si256( lit, _mm256_set1_epi32( 1 << plane ) ) );
+                value[ plane ] = _mm256_slli_epi32( value[ plane ], 8 );
+            }
+
+            _mm256_storeu_si256( reinterpret_cast< __m256i* >( line + chunk * 32 + x ),
+                                 _mm256_i32gather_epi32( colours, index, 4 ) );
+        }
+    }
+#else
+    for ( int x = 0; x < DISPLAY_WIDTH; x++ )
+        line[ x ] = palette.colours[ ecdisplay::GetColour( planes, x, y ) ];
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Repeats every pixel of the line scale times. The vector paths store whole registers of the
+ * pixel and let the next pixel overwrite what went past its block, the last pixels, whose span
+ * of registers would go past the end of the row, are written exactly.
+ */
+static void
+ScaleLine( const DWORD* line, int scale, DWORD* out )
+{
+    if ( scale == 1 )
+    {
+        memcpy( out, line, DISPLAY_WIDTH * sizeof( DWORD ) );
+        return;
+    }
+
+    int x = 0;
+
+#if defined( EIGHTCHIP_AVX2 )
+    const int span = ( scale + 7 ) & ~7;
+
+    for ( ; x * scale + span <= DISPLAY_WIDTH * scale; x++ )
+    {
+        __m256i pixel = _mm256_set1_epi32( line[ x ] );
+        DWORD* block = out + x * scale;
+
+        for ( int k = 0; k < scale; k += 8 )
+            _mm256_storeu_si256( reinterpret_cast< __m256i* >( block + k ), pixel );
+    }
+#elif defined( EIGHTCHIP_SSE2 )
+    const int span = ( scale + 3 ) & ~3;
+
+    for ( ; x * scale + span <= DISPLAY_WIDTH * scale; x++ )
+    {
+        __m128i pixel = _mm_set1_epi32( line[ x ] );
+        DWORD* block = out + x * scale;
+
+        for ( int k = 0; k < scale; k += 4 )
+            _mm_storeu_si128( reinterpret_cast< __m128i* >( block + k ), pixel );
+    }
+#endif
+
+    for ( ; x < DISPLAY_WIDTH; x++ )
+        std::fill_n( out + x * scale, scale, line[ x ] );
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Each display row is expanded once at one pixel per bit, scaled sideways into the first of its
+ * output rows, which is then copied to the other scale - 1. Rows only drawn on plane 0, every
+ * row of a game that isn't XO-CHIP, take the two colours path.
+ */
+void
+ecdisplay::Expand( const EightChipPlane planes[ DISPLAY_PLANES ],
+                   const EightChipPalette& palette,
+                   int scale,
+                   BYTE* pixels,
+                   size_t pitch )
+{
+    alignas( 32 ) DWORD line[ DISPLAY_WIDTH ];
+
+    const size_t width = DISPLAY_WIDTH * scale * sizeof( DWORD );
+
+    for ( int y = 0; y < DISPLAY_HEIGHT; y++ )
+    {
+        QWORD colour = 0;
+
+        for ( int plane = 1; plane < DISPLAY_PLANES; plane++ )
+            colour |= planes[ plane ].rows[ y ][ 0 ] | planes[ plane ].rows[ y ][ 1 ];
+
+        if ( colour == 0 )
+            ExpandMonoLine( planes[ 0 ].rows[ y ],
+                            palette.colours[ 0 ],
+                            palette.colours[ 1 ],
+                            line );
+        else
+            ExpandColourLine( planes, y, palette, line );
+
+        BYTE* out = pixels + y * scale * pitch;
+
+        // Only 4 bytes alignment is expected from the rows, the vector stores are unaligned
+        ScaleLine( line, scale, reinterpret_cast< DWORD* >( out ) );
+
+        for ( int copy = 1; copy < scale; copy++ )
+            memcpy( out + copy * pitch, out, width );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,131 @@
+#include <iterator>
+
+#include "ECEngine.h"
+
+//-------------------------------------------------------------------------------------------------
+// Indexed by EightChipInterpreterEngine::Mode
+static const char* INTERPRETER_NAMES[] = { "interpreter", "step", "debug", "trace" };
+
+// A ring that small is enough for the trace to be written, nobody reads it
+static const size_t ENGINE_TRACE_RECORDS = 4096;
+
+//-------------------------------------------------------------------------------------------------
+EightChipInterpreterEngine::EightChipInterpreterEngine( Mode mode )
+    : m_Mode( mode )
+    , m_CPU( new EightChipCPU( ) )
+{
+    if ( m_Mode == MODE_DEBUG )
+        m_CPU->SetDebugger( &m_Debugger );
+
+    if ( m_Mode == MODE_TRACE )
+    {
+        m_Tracer.reset( new EightChipTracer( ENGINE_TRACE_RECORDS ) );
+        m_CPU->SetTracer( m_Tracer.get( ) );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+const char*
+EightChipInterpreterEngine::GetName( ) const
+{
+    return INTERPRETER_NAMES[ m_Mode ];
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipInterpreterEngine::Load( const BYTE* rom,
+                                  size_t size,
+                                  EightChipProfile profile,
+                                  unsigned int seed )
+{
+    m_CPU->SetProfile( profile );
+
+    if ( !m_CPU->InitRom( rom, size ) )
+        return false;
+
+    if ( seed != 0 )
+        m_CPU->SetRandomSeed( seed );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipInterpreterEngine::Run( int count )
+{
+    if ( m_Mode != MODE_STEP )
+    {
+        m_CPU->ExecuteOpCodes( count );
+        return;
+    }
+
+    for ( int i = 0; i < count; i++ )
+        m_CPU->ExecuteNextOpCode( );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipInterpreterEngine::DecreaseTimers( )
+{
+    m_CPU->DecreaseTimers( );
+}
+
+void
+EightChipInterpreterEngine::KeyDown( int key )
+{
+    m_CPU->KeyDown( key );
+}
+
+void
+EightChipInterpreterEngine::KeyUp( int key )
+{
+    m_CPU->KeyUp( key );
+}
+
+//-------------------------------------------------------------------------------------------------
+const EightChipState&
+EightChipInterpreterEngine::GetState( ) const
+{
+    return m_CPU->GetState( );
+}
+
+void
+EightChipInterpreterEngine::SetState( const EightChipState& state )
+{
+    m_CPU->SetState( state );
+}
+
+void
+EightChipInterpreterEngine::TakeWrites( QWORD pages[ MEMORY_PAGES / 64 ], int& planes )
+{
+    m_CPU->TakeWrites( pages, planes );
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector< std::string >
+ecengine::GetNames( )
+{
+    return std::vector< std::string >( std::begin( INTERPRETER_NAMES ),
+                                       std::end( INTERPRETER_NAMES ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+std::unique_ptr< EightChipEngine >
+ecengine::CreateEngine( const std::string& name )
+{
+    int modes =
+        static_cast< int >( sizeof( INTERPRETER_NAMES ) / sizeof( INTERPRETER_NAMES[ 0 ] ) );
+
+    for ( int mode = 0; mode < modes; mode++ )
+    {
+        if ( name == INTERPRETER_NAMES[ mode ] )
+        {
+            return std::unique_ptr< EightChipEngine >( new EightChipInterpreterEngine(
+                static_cast< EightChipInterpreterEngine::Mode >( mode ) ) );
+        }
+    }
+
+    return nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,429 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+
+#include "ECCpu.h"
+#include "ECExplore.h"
+#include "ECVMPool.h"
+
+//-------------------------------------------------------------------------------------------------
+namespace
+{
+    // A state of the search: the one it was reached from, and the keys held to reach it
+    struct Node
+    {
+        int parent;
+        WORD keys;
+    };
+
+    // A state of the frontier, waiting to be expanded
+    struct Entry
+    {
+        int node;
+        EightChipSnapshot snapshot;
+    };
+
+    // What expanding one state of the frontier led to, written by the worker that took it
+    struct Expansion
+    {
+        // States not seen at the previous depths, nor among their siblings
+        std::vector< EightChipSnapshot > children;
+        std::vector< WORD > keys;
+        size_t tried = 0;
+        size_t duplicates = 0;
+
+        // First choice that reached the targets, and after how many frames of its decision
+        int hit = -1;
+        int hitFrame = 0;
+        std::unique_ptr< EightChipSnapshot > hitSnapshot;
+    };
+
+    //---------------------------------------------------------------------------------------------
+    void
+    SetKeys( EightChipCPU& cpu, WORD keys )
+    {
+        for ( int key = 0; key < 16; key++ )
+        {
+            if ( ( keys >> key ) & 1 )
+                cpu.KeyDown( key );
+            else
+                cpu.KeyUp( key );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    // Runs a frame the way the batch runner and the host do
+    void
+    RunFrame( EightChipCPU& cpu, int opcodes )
+    {
+        cpu.DecreaseTimers( );
+        cpu.ExecuteOpCodes( opcodes );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    std::vector< WORD >
+    MakePath( const std::vector< Node >& nodes, int node )
+    {
+        std::vector< WORD > path;
+
+        for ( ; nodes[ node ].parent >= 0; node = nodes[ node ].parent )
+            path.push_back( nodes[ node ].keys );
+
+        std::reverse( path.begin( ), path.end( ) );
+
+        return path;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    /**
+     * Tries every choice from one state. The keys are let go once a decision is over: the next
+     * decision sets all of them again, so states only apart by the keys still held are the same.
+     */
+    void
+    Expand( EightChipCPU& cpu,
+            const EightChipSnapshot& from,
+            const std::vector< WORD >& choices,
+            const EightChipExploreConfig& config,
+            const std::unordered_set< QWORD >& seen,
+            Expansion& expansion )
+    {
+        std::unordered_set< QWORD > siblings;
+        EightChipSnapshot child;
+
+        for ( size_t choice = 0; choice < choices.size( ); choice++ )
+        {
+            cpu.LoadSnapshot( from );
+            SetKeys( cpu, choices[ choice ] );
+
+            for ( int frame = 0; frame < config.framesPerDecision; frame++ )
+            {
+                RunFrame( cpu, config.opcodesPerFrame );
+
+                if ( !config.targets.empty( )
+                     && ecexplore::IsReached( cpu.GetState( ), config.targets ) )
+                {
+                    expansion.hit = static_cast< int >( choice );
+                    expansion.hitFrame = frame + 1;
+                    expansion.hitSnapshot.reset( new EightChipSnapshot( ) );
+                    cpu.SaveSnapshot( *expansion.hitSnapshot );
+
+                    return;
+                }
+            }
+
+            SetKeys( cpu, 0 );
+            cpu.SaveSnapshot( child );
+
+            expansion.tried++;
+
+            if ( seen.count( child.GetHash( ) ) != 0
+                 || !siblings.insert( child.GetHash( ) ).second )
+            {
+                expansion.duplicates++;
+                continue;
+            }
+
+            expansion.children.push_back( child );
+            expansion.keys.push_back( choices[ choice ] );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    int
+    ReadTarget( const EightChipState& state, const EightChipExploreTarget& target )
+    {
+        if ( target.kind == TARGET_REGISTER )
+            return state.m_Registers[ target.address & 0xF ];
+
+        if ( target.size == 2 )
+            return ( state.m_GameMemory[ target.address ] << 8 )
+                   | state.m_GameMemory[ static_cast< WORD >( target.address + 1 ) ];
+
+        return state.m_GameMemory[ target.address ];
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Each depth goes in two steps. The workers expand the frontier first, every state on its own,
+ * and only drop the children seen at the previous depths or among their siblings; the set of
+ * states seen doesn't change meanwhile and is read without a lock. The children are then taken
+ * in the order of the frontier, dropping those that came up earlier at the same depth.
+ */
+bool
+ecexplore::Explore( const std::shared_ptr< const EightChipRomImage >& image,
+                    unsigned int seed,
+                    const EightChipExploreConfig& config,
+                    EightChipExploreResult& result )
+{
+    result = EightChipExploreResult( );
+
+    if ( !image )
+        return false;
+
+    const std::vector< WORD > choices = GetChoices( config );
+
+    int threads = config.threads;
+    if ( threads <= 0 )
+        threads = std::max( 1, static_cast< int >( std::thread::hardware_concurrency( ) ) );
+
+    EightChipVMPool pool( threads );
+    pool.SetTemplate( image );
+
+    std::vector< EightChipCPU* > machines;
+
+    for ( int i = 0; i < threads; i++ )
+        machines.push_back( pool.Acquire( ) );
+
+    // The start state, after the frames before the first decision
+    EightChipCPU& start = *machines[ 0 ];
+    start.SetRandomSeed( seed );
+
+    for ( int frame = 0; frame <= config.startFrames; frame++ )
+    {
+        if ( !config.targets.empty( ) && IsReached( start.GetState( ), config.targets ) )
+        {
+            result.reached = true;
+            result.frames = frame;
+            result.states = 1;
+            result.stop = "target";
+            start.SaveSnapshot( result.snapshot );
+
+            return true;
+        }
+
+        if ( frame < config.startFrames )
+            RunFrame( start, config.opcodesPerFrame );
+    }
+
+    std::vector< Node > nodes( 1, Node{ -1, 0 } );
+    std::vector< Entry > frontier( 1 );
+    frontier[ 0 ].node = 0;
+    start.SaveSnapshot( frontier[ 0 ].snapshot );
+
+    std::unordered_set< QWORD > seen;
+    seen.insert( frontier[ 0 ].snapshot.GetHash( ) );
+
+    for ( int depth = 1;; depth++ )
+    {
+        if ( frontier.empty( ) )
+        {
+            result.stop = "exhausted";
+            break;
+        }
+
+        if ( depth > config.depth )
+        {
+            result.stop = "depth";
+            break;
+        }
+
+        auto begin = std::chrono::steady_clock::now( );
+
+        std::vector< Expansion > expansions( frontier.size( ) );
+
+        // Once a state reached the targets, those after it in the frontier can't give an earlier
+        // path and are left alone
+        std::atomic< size_t > next( 0 );
+        std::atomic< size_t > firstHit( frontier.size( ) );
+        std::vector< std::thread > workers;
+
+        int active = std::min( threads, static_cast< int >( frontier.size( ) ) );
+
+        for ( int worker = 0; worker < active; worker++ )
+        {
+            workers.emplace_back( [ &, worker ]( ) {
+                for ( size_t entry = next++; entry < frontier.size( ) && entry < firstHit;
+                      entry = next++ )
+                {
+                    Expansion& expansion = expansions[ entry ];
+                    Expand( *machines[ worker ],
+                            frontier[ entry ].snapshot,
+                            choices,
+                            config,
+                            seen,
+                            expansion );
+
+                    if ( expansion.hit < 0 )
+                        continue;
+
+                    size_t hit = firstHit;
+                    while ( entry < hit && !firstHit.compare_exchange_weak( hit, entry ) )
+                        ;
+                }
+            } );
+        }
+
+        for ( std::thread& worker : workers )
+            worker.join( );
+
+        EightChipExploreLevel level;
+        level.depth = depth;
+        level.frontier = std::min< size_t >( frontier.size( ), firstHit + 1 );
+
+        std::vector< Entry > children;
+
+        for ( size_t entry = 0; entry < level.frontier; entry++ )
+        {
+            Expansion& expansion = expansions[ entry ];
+
+            level.children += expansion.tried;
+            level.duplicates += expansion.duplicates;
+
+            if ( expansion.hit >= 0 )
+            {
+                result.reached = true;
+                result.path = MakePath( nodes, frontier[ entry ].node );
+                result.path.push_back( choices[ expansion.hit ] );
+                result.frames = config.startFrames + ( depth - 1 ) * config.framesPerDecision
+                                + expansion.hitFrame;
+                result.snapshot = *expansion.hitSnapshot;
+                break;
+            }
+
+            for ( size_t i = 0; i < expansion.children.size( ) && seen.size( ) < config.maxStates;
+                  i++ )
+            {
+                if ( !seen.insert( expansion.children[ i ].GetHash( ) ).second )
+                {
+                    level.duplicates++;
+                    continue;
+                }
+
+                nodes.push_back( Node{ frontier[ entry ].node, expansion.keys[ i ] } );
+
+                children.push_back( Entry( ) );
+                children.back( ).node = static_cast< int >( nodes.size( ) - 1 );
+                children.back( ).snapshot = std::move( expansion.children[ i ] );
+
+                level.bytes += children.back( ).snapshot.GetSize( );
+            }
+        }
+
+        std::chrono::duration< double, std::milli > elapsed =
+            std::chrono::steady_clock::now( ) - begin;
+        level.states = children.size( );
+        level.milliseconds = elapsed.count( );
+        result.levels.push_back( level );
+
+        if ( result.reached )
+        {
+            result.stop = "target";
+            break;
+        }
+
+        frontier.swap( children );
+
+        if ( seen.size( ) >= config.maxStates )
+        {
+            result.stop = "states";
+            break;
+        }
+    }
+
+    result.states = seen.size( );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::vector< WORD >
+ecexplore::GetChoices( const EightChipExploreConfig& config )
+{
+    if ( !config.choices.empty( ) )
+        return config.choices;
+
+    std::vector< WORD > choices( 1, 0 );
+
+    for ( int key = 0; key < 16; key++ )
+        choices.push_back( static_cast< WORD >( 1 << key ) );
+
+    return choices;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecexplore::IsReached( const EightChipState& state,
+                      const std::vector< EightChipExploreTarget >& targets )
+{
+    for ( const EightChipExploreTarget& target : targets )
+    {
+        if ( !eccompare::Holds( ReadTarget( state, target ), target.compare, target.value ) )
+            return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecexplore::ParseTarget( const std::string& text, EightChipExploreTarget& target )
+{
+    static const struct
+    {
+        const char* name;
+        EightChipCompare compare;
+    } OPERATORS[ ] = {
+        // Two characters ones first, "<=" isn't "<" followed by "="
+        { "!=", COMPARE_NOT_EQUAL },  { "<=", COMPARE_LESS_EQUAL }, { ">=", COMPARE_GREATER_EQUAL },
+        { "=", COMPARE_EQUAL },       { "<", COMPARE_LESS },        { ">", COMPARE_GREATER },
+    };
+
+    target = EightChipExploreTarget( );
+
+    size_t position = text.find_first_of( "!=<>" );
+
+    if ( position == std::string::npos || position == 0 )
+        return false;
+
+    std::string left = text.substr( 0, position );
+    std::string right;
+
+    for ( const auto& op : OPERATORS )
+    {
+        if ( text.compare( position, strlen( op.name ), op.name ) == 0 )
+        {
+            target.compare = op.compare;
+            right = text.substr( position + strlen( op.name ) );
+            break;
+        }
+    }
+
+    char* end = nullptr;
+
+    if ( right.empty( ) )
+        return false;
+
+    target.value = static_cast< int >( strtol( right.c_str( ), &end, 0 ) );
+
+    if ( *end != '\0' )
+        return false;
+
+    if ( ( left[ 0 ] == 'V' || left[ 0 ] == 'v' ) && left.size( ) == 2 )
+    {
+        target.kind = TARGET_REGISTER;
+        target.address = static_cast< WORD >( strtol( left.c_str( ) + 1, &end, 16 ) );
+
+        return *end == '\0';
+    }
+
+    target.kind = TARGET_MEMORY;
+    target.address = static_cast< WORD >( strtoul( left.c_str( ), &end, 0 ) & ( ROMSIZE - 1 ) );
+
+    if ( *end == ':' )
+    {
+        target.size = static_cast< int >( strtol( end + 1, &end, 0 ) );
+
+        if ( target.size != 1 && target.size != 2 )
+            return false;
+    }
+
+    return *end == '\0' && end != left.c_str( );
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,360 @@
+#include <algorithm>
+
+#include "ECHost.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipHost::EightChipHost( const EightChipHostConfig& config )
+    : m_Config( config )
+    , m_NextId( 0 )
+    , m_NextQueue( 0 )
+    , m_Generation( 0 )
+    , m_Stopping( false )
+{
+    if ( m_Config.threads <= 0 )
+        m_Config.threads =
+            std::max( 1, static_cast< int >( std::thread::hardware_concurrency( ) ) );
+
+    m_Config.frameRate = std::max( 1, m_Config.frameRate );
+    m_Period = std::chrono::duration_cast< CLOCK::duration >( std::chrono::seconds( 1 ) )
+               / m_Config.frameRate;
+
+    for ( int worker = 0; worker < m_Config.threads; worker++ )
+    {
+        m_Queues.emplace_back( new Queue( ) );
+        m_Counters.emplace_back( new Counters( ) );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipHost::~EightChipHost( )
+{
+    Stop( );
+
+    for ( std::unique_ptr< Queue >& queue : m_Queues )
+    {
+        for ( Session* session : queue->sessions )
+            Release( session );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipHost::Start( )
+{
+    if ( !m_Workers.empty( ) )
+        return;
+
+    m_Stopping = false;
+
+    for ( int worker = 0; worker < m_Config.threads; worker++ )
+        m_Workers.emplace_back( &EightChipHost::WorkerLoop, this, worker );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Frames being run are finished, the sessions stay in their queues. */
+void
+EightChipHost::Stop( )
+{
+    {
+        std::lock_guard< std::mutex > lock( m_Mutex );
+        m_Stopping = true;
+        m_Generation++;
+    }
+
+    m_Wake.notify_all( );
+
+    for ( std::thread& worker : m_Workers )
+        worker.join( );
+
+    m_Workers.clear( );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Sessions are spread over the queues in turn, their first frame is due right away. */
+int
+EightChipHost::OpenSession( const std::shared_ptr< const EightChipRomImage >& image,
+                            unsigned int seed,
+                            const std::string& shared_name )
+{
+    Session* session = new Session( );
+
+    session->cpu.reset( new EightChipCPU( ) );
+    session->cpu->IncrementalReset( image );
+    session->cpu->SetRandomSeed( seed );
+    session->deadline = CLOCK::now( );
+    session->keys = 0;
+    session->applied = 0;
+    session->closing = false;
+
+    if ( !shared_name.empty( ) && !session->shared.Create( shared_name ) )
+    {
+        Release( session );
+        return -1;
+    }
+
+    int worker;
+
+    {
+        std::lock_guard< std::mutex > lock( m_Mutex );
+
+        session->id = m_NextId++;
+        m_Sessions[ session->id ] = session;
+
+        worker = m_NextQueue;
+        m_NextQueue = ( m_NextQueue + 1 ) % m_Config.threads;
+    }
+
+    Push( worker, session );
+
+    {
+        std::lock_guard< std::mutex > lock( m_Mutex );
+        m_Generation++;
+    }
+
+    m_Wake.notify_all( );
+
+    return session->id;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The session is freed by the worker that next takes it, or when the host is destroyed. */
+void
+EightChipHost::CloseSession( int session )
+{
+    std::lock_guard< std::mutex > lock( m_Mutex );
+
+    auto it = m_Sessions.find( session );
+
+    if ( it == m_Sessions.end( ) )
+        return;
+
+    // Out of the map first: SetKeys( ) can't reach it any more once it is marked
+    Session* closed = it->second;
+    m_Sessions.erase( it );
+    closed->closing = true;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipHost::SetKeys( int session, WORD keys )
+{
+    std::lock_guard< std::mutex > lock( m_Mutex );
+
+    auto it = m_Sessions.find( session );
+
+    if ( it != m_Sessions.end( ) )
+        it->second->keys.store( keys, std::memory_order_relaxed );
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+EightChipHost::GetSessions( ) const
+{
+    std::lock_guard< std::mutex > lock( m_Mutex );
+
+    return static_cast< int >( m_Sessions.size( ) );
+}
+
+int
+EightChipHost::GetThreads( ) const
+{
+    return m_Config.threads;
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipHostStats
+EightChipHost::GetStats( ) const
+{
+    EightChipHostStats stats;
+    unsigned long long latenessSum = 0;
+    unsigned long long latenessMax = 0;
+
+    for ( const std::unique_ptr< Counters >& counters : m_Counters )
+    {
+        stats.frames += counters->frames.load( std::memory_order_relaxed );
+        stats.parked += counters->parked.load( std::memory_order_relaxed );
+        stats.missed += counters->missed.load( std::memory_order_relaxed );
+        stats.steals += counters->steals.load( std::memory_order_relaxed );
+        latenessSum += counters->latenessSum.load( std::memory_order_relaxed );
+        latenessMax =
+            std::max( latenessMax, counters->latenessMax.load( std::memory_order_relaxed ) );
+    }
+
+    // The counters are in microseconds
+    stats.meanLateness = ( stats.frames > 0 ) ? latenessSum / 1000.0 / stats.frames : 0.0;
+    stats.maxLateness = latenessMax / 1000.0;
+
+    return stats;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipHost::WorkerLoop( int worker )
+{
+    while ( !m_Stopping )
+    {
+        unsigned int generation = m_Generation;
+
+        CLOCK::time_point next;
+        Session* session = TakeSession( worker, CLOCK::now( ), next );
+
+        if ( session == nullptr )
+        {
+            std::unique_lock< std::mutex > lock( m_Mutex );
+            m_Wake.wait_until(
+                lock, next, [ & ] { return m_Stopping || m_Generation != generation; } );
+
+            continue;
+        }
+
+        if ( session->closing )
+        {
+            Release( session );
+            continue;
+        }
+
+        RunFrame( worker, session );
+
+        // A stolen session stays with the worker that stole it
+        Push( worker, session );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipHost::Session*
+EightChipHost::TakeSession( int worker, CLOCK::time_point now, CLOCK::time_point& next )
+{
+    int queues = static_cast< int >( m_Queues.size( ) );
+
+    // Nothing queued at all: sleep until a session is opened, or a frame period at most
+    next = now + m_Period;
+
+    for ( int i = 0; i < queues; i++ )
+    {
+        Queue& queue = *m_Queues[ ( worker + i ) % queues ];
+        std::lock_guard< std::mutex > lock( queue.mutex );
+
+        if ( queue.sessions.empty( ) )
+            continue;
+
+        Session* first = queue.sessions.front( );
+
+        // Another worker's session is only taken once it is half a period late, when its worker
+        // is behind rather than about to get to it
+        CLOCK::time_point due = ( i == 0 ) ? first->deadline : first->deadline + m_Period / 2;
+
+        if ( due > now )
+        {
+            next = std::min( next, due );
+            continue;
+        }
+
+        std::pop_heap( queue.sessions.begin( ), queue.sessions.end( ), IsLater );
+        queue.sessions.pop_back( );
+
+        if ( i > 0 )
+            m_Counters[ worker ]->steals.fetch_add( 1, std::memory_order_relaxed );
+
+        return first;
+    }
+
+    return nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipHost::Push( int worker, Session* session )
+{
+    Queue& queue = *m_Queues[ worker ];
+    std::lock_guard< std::mutex > lock( queue.mutex );
+
+    queue.sessions.push_back( session );
+    std::push_heap( queue.sessions.begin( ), queue.sessions.end( ), IsLater );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Input first, then the frame unless the session is parked, then the next deadline. A session
+ * that fell more than a frame behind starts over from now rather than running its backlog.
+ */
+void
+EightChipHost::RunFrame( int worker, Session* session )
+{
+    Counters& counters = *m_Counters[ worker ];
+    EightChipCPU& cpu = *session->cpu;
+    CLOCK::time_point now = CLOCK::now( );
+
+    unsigned int keys = session->keys.load( std::memory_order_relaxed );
+
+    for ( int key = 0; key < 16 && keys != session->applied; key++ )
+    {
+        if ( ( ( keys ^ session->applied ) >> key ) & 1 )
+        {
+            if ( ( keys >> key ) & 1 )
+                cpu.KeyDown( key );
+            else
+                cpu.KeyUp( key );
+        }
+    }
+
+    session->applied = keys;
+    session->shared.PollInput( cpu );
+
+    bool parked = IsParked( cpu );
+    bool late = now - session->deadline > m_Period;
+
+    if ( parked )
+    {
+        counters.parked.fetch_add( 1, std::memory_order_relaxed );
+    }
+    else
+    {
+        cpu.DecreaseTimers( );
+        cpu.ExecuteOpCodes( m_Config.opcodesPerFrame );
+
+        session->shared.PublishFrame( cpu );
+
+        unsigned long long lateness =
+            std::chrono::duration_cast< std::chrono::microseconds >( now - session->deadline )
+                .count( );
+
+        counters.frames.fetch_add( 1, std::memory_order_relaxed );
+        counters.latenessSum.fetch_add( lateness, std::memory_order_relaxed );
+
+        if ( lateness > counters.latenessMax.load( std::memory_order_relaxed ) )
+            counters.latenessMax.store( lateness, std::memory_order_relaxed );
+    }
+
+    if ( late && !parked )
+        counters.missed.fetch_add( 1, std::memory_order_relaxed );
+
+    session->deadline = late ? now + m_Period : session->deadline + m_Period;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipHost::Release( Session* session )
+{
+    delete session;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipHost::IsLater( const Session* first, const Session* second )
+{
+    return first->deadline > second->deadline;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The timers still count down in FX0A, a session only parks once they stopped. */
+bool
+EightChipHost::IsParked( const EightChipCPU& cpu )
+{
+    const EightChipState& state = cpu.GetState( );
+
+    if ( cpu.IsHalted( ) )
+        return true;
+
+    return cpu.IsWaitingForKey( ) && state.m_DelayTimer == 0 && state.m_SoundTimer == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "ECLatency.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipLatencyHistogram::EightChipLatencyHistogram( )
+    : m_Count( 0 )
+    , m_Total( 0 )
+    , m_Max( 0 )
+{
+    memset( m_Buckets, 0, sizeof( m_Buckets ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipLatencyHistogram::Record( unsigned long long microseconds )
+{
+    unsigned long long bucket = microseconds / LATENCY_BUCKET_US;
+
+    m_Buckets[ std::min< unsigned long long >( bucket, LATENCY_BUCKETS - 1 ) ]++;
+    m_Count++;
+    m_Total += microseconds;
+    m_Max = std::max( m_Max, microseconds );
+}
+
+//-------------------------------------------------------------------------------------------------
+unsigned int
+EightChipLatencyHistogram::GetCount( ) const
+{
+    return m_Count;
+}
+
+//-------------------------------------------------------------------------------------------------
+unsigned long long
+EightChipLatencyHistogram::GetPercentile( double percentile ) const
+{
+    if ( m_Count == 0 )
+        return 0;
+
+    // Rank of the sample, 1 based
+    double rank = std::max( 1.0, percentile / 100.0 * m_Count );
+    unsigned int seen = 0;
+
+    for ( int i = 0; i < LATENCY_BUCKETS - 1; i++ )
+    {
+        seen += m_Buckets[ i ];
+
+        if ( seen >= rank )
+            return static_cast< unsigned long long >( i + 1 ) * LATENCY_BUCKET_US;
+    }
+
+    return m_Max;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string
+EightChipLatencyHistogram::Report( ) const
+{
+    char line[ 128 ];
+    std::string res;
+
+    snprintf( line, sizeof( line ),
+              "Input latency, %u events: "
+              "p50 <%.1fms p95 <%.1fms p99 <%.1fms mean %.1fms max %.1fms\n",
+              m_Count, GetPercentile( 50 ) / 1000.0, GetPercentile( 95 ) / 1000.0,
+              GetPercentile( 99 ) / 1000.0, m_Count ? m_Total / 1000.0 / m_Count : 0.0,
+              m_Max / 1000.0 );
+    res += line;
+
+    unsigned int largest = *std::max_element( m_Buckets, m_Buckets + LATENCY_BUCKETS );
+
+    for ( int i = 0; i < LATENCY_BUCKETS; i++ )
+    {
+        if ( m_Buckets[ i ] == 0 )
+            continue;
+
+        // Bars are scaled to 40 characters for the largest bucket
+        int bar = static_cast< int >( 40ULL * m_Buckets[ i ] / largest );
+
+        if ( i < LATENCY_BUCKETS - 1 )
+            snprintf( line, sizeof( line ), "%3d-%3dms %6u ", i, i + 1, m_Buckets[ i ] );
+        else
+            snprintf( line, sizeof( line ), "   >%3dms %6u ", i, m_Buckets[ i ] );
+
+        res += line;
+        res += std::string( std::max( bar, 1 ), '#' );
+        res += '\n';
+    }
+
+    return res;
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipLatencyTracker::EightChipLatencyTracker( )
+{
+    // Plenty for the events of a frame, so tracking doesn't allocate while playing
+    m_Pending.reserve( 64 );
+    m_Executed.reserve( 64 );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipLatencyTracker::OnInput( unsigned long long time )
+{
+    m_Pending.push_back( time );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipLatencyTracker::OnSlice( )
+{
+    m_Executed.insert( m_Executed.end( ), m_Pending.begin( ), m_Pending.end( ) );
+    m_Pending.clear( );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipLatencyTracker::OnPresent( unsigned long long time )
+{
+    for ( unsigned long long input : m_Executed )
+        m_Histogram.Record( time > input ? time - input : 0 );
+
+    m_Executed.clear( );
+}
+
+//-------------------------------------------------------------------------------------------------
+const EightChipLatencyHistogram&
+EightChipLatencyTracker::GetHistogram( ) const
+{
+    return m_Histogram;
+}
+
+//-------------------------------------------------------------------------------------------------
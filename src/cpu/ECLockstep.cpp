@@ -0,0 +1,399 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "ECLockstep.h"
+#include "ECSnapshot.h"
+
+//-------------------------------------------------------------------------------------------------
+// The memory and the display are hashed by lines of that many bytes, which never straddle a page
+// or a plane
+static const size_t HASH_LINE = 64;
+
+static_assert( MEMORY_PAGE_SIZE % HASH_LINE == 0 && sizeof( EightChipPlane ) % HASH_LINE == 0,
+               "pages and planes must be whole lines" );
+
+//-------------------------------------------------------------------------------------------------
+// The line's place is part of its hash, the same bytes elsewhere hash differently
+static QWORD
+HashLine( size_t offset, const BYTE* data, size_t size )
+{
+    return ecsnapshot::HashBytes( ecsnapshot::Mix( offset + 1 ), data, size );
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipStateHash::EightChipStateHash( )
+    : m_Shadow( sizeof( EightChipState::m_GameMemory ) + sizeof( EightChipState::m_Display ), 0 )
+    , m_Lines( 0 )
+    , m_Value( 0 )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipStateHash::Reset( const EightChipState& state )
+{
+    memcpy( m_Shadow.data( ), state.m_GameMemory, sizeof( state.m_GameMemory ) );
+    memcpy( m_Shadow.data( ) + sizeof( state.m_GameMemory ),
+            state.m_Display,
+            sizeof( state.m_Display ) );
+
+    m_Lines = 0;
+
+    for ( size_t offset = 0; offset < m_Shadow.size( ); offset += HASH_LINE )
+        m_Lines += HashLine( offset,
+                             &m_Shadow[ offset ],
+                             std::min( HASH_LINE, m_Shadow.size( ) - offset ) );
+
+    m_Value = ecsnapshot::Mix( ecsnapshot::HashFields( state ) ^ m_Lines );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipStateHash::UpdateLines( const BYTE* data, size_t size, size_t offset )
+{
+    for ( size_t i = 0; i < size; i += HASH_LINE )
+    {
+        size_t length = std::min( HASH_LINE, size - i );
+        BYTE* shadow = &m_Shadow[ offset + i ];
+
+        if ( memcmp( shadow, data + i, length ) == 0 )
+            continue;
+
+        m_Lines -= HashLine( offset + i, shadow, length );
+        memcpy( shadow, data + i, length );
+        m_Lines += HashLine( offset + i, shadow, length );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+QWORD
+EightChipStateHash::Update( const EightChipState& state,
+                            const QWORD pages[ MEMORY_PAGES / 64 ],
+                            int planes )
+{
+    for ( int word = 0; word < MEMORY_PAGES / 64; word++ )
+    {
+        QWORD bits = pages[ word ];
+
+        for ( int page = word * 64; bits != 0; page++, bits >>= 1 )
+        {
+            if ( bits & 1 )
+            {
+                size_t address = page * MEMORY_PAGE_SIZE;
+                UpdateLines( &state.m_GameMemory[ address ], MEMORY_PAGE_SIZE, address );
+            }
+        }
+    }
+
+    for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+    {
+        if ( planes & ( 1 << plane ) )
+        {
+            UpdateLines( reinterpret_cast< const BYTE* >( &state.m_Display[ plane ] ),
+                         sizeof( EightChipPlane ),
+                         sizeof( state.m_GameMemory ) + plane * sizeof( EightChipPlane ) );
+        }
+    }
+
+    m_Value = ecsnapshot::Mix( ecsnapshot::HashFields( state ) ^ m_Lines );
+
+    return m_Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+QWORD
+EightChipStateHash::GetValue( ) const
+{
+    return m_Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Writes made before the hash is reset are already in it
+static void
+ResetHash( EightChipStateHash& hash, EightChipEngine& engine )
+{
+    QWORD pages[ MEMORY_PAGES / 64 ];
+    int planes;
+
+    engine.TakeWrites( pages, planes );
+    hash.Reset( engine.GetState( ) );
+}
+
+static QWORD
+UpdateHash( EightChipStateHash& hash, EightChipEngine& engine )
+{
+    QWORD pages[ MEMORY_PAGES / 64 ];
+    int planes;
+
+    engine.TakeWrites( pages, planes );
+
+    return hash.Update( engine.GetState( ), pages, planes );
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Blocks are run while the hashes agree. The state they last agreed on is kept so a block that
+ * ends apart can be replayed an instruction at a time, down to the one that made the difference.
+ */
+bool
+eclockstep::Run( EightChipEngine& first,
+                 EightChipEngine& second,
+                 const BYTE* rom,
+                 size_t size,
+                 const EightChipLockstepConfig& config,
+                 EightChipLockstepResult& result )
+{
+    result = EightChipLockstepResult( );
+
+    if ( !first.Load( rom, size, config.profile, config.seed )
+         || !second.Load( rom, size, config.profile, config.seed ) )
+    {
+        return false;
+    }
+
+    EightChipStateHash hashes[ 2 ];
+    ResetHash( hashes[ 0 ], first );
+    ResetHash( hashes[ 1 ], second );
+
+    const int block = std::max( 1, config.block );
+
+    // Only needed to replay a block
+    EightChipState agreed;
+
+    size_t event = 0;
+
+    for ( int frame = 0; frame < config.frames && !result.diverged; frame++ )
+    {
+        for ( ; event < config.input.size( ) && config.input[ event ].frame <= frame; event++ )
+        {
+            const EightChipKeyEvent& key = config.input[ event ];
+
+            if ( key.down )
+            {
+                first.KeyDown( key.key );
+                second.KeyDown( key.key );
+            }
+            else
+            {
+                first.KeyUp( key.key );
+                second.KeyUp( key.key );
+            }
+        }
+
+        first.DecreaseTimers( );
+        second.DecreaseTimers( );
+
+        for ( int done = 0; done < config.opcodesPerFrame; )
+        {
+            int count = std::min( block, config.opcodesPerFrame - done );
+
+            WORD programCounter = first.GetState( ).m_ProgramCounter;
+
+            if ( count > 1 )
+                agreed = first.GetState( );
+
+            first.Run( count );
+            second.Run( count );
+
+            if ( UpdateHash( hashes[ 0 ], first ) == UpdateHash( hashes[ 1 ], second ) )
+            {
+                result.instructions += count;
+                done += count;
+                continue;
+            }
+
+            result.diverged = true;
+            result.programCounter = programCounter;
+
+            if ( count > 1 )
+            {
+                first.SetState( agreed );
+                second.SetState( agreed );
+                ResetHash( hashes[ 0 ], first );
+                ResetHash( hashes[ 1 ], second );
+
+                for ( int i = 0; i < count; i++ )
+                {
+                    result.programCounter = first.GetState( ).m_ProgramCounter;
+
+                    first.Run( 1 );
+                    second.Run( 1 );
+
+                    if ( UpdateHash( hashes[ 0 ], first ) != UpdateHash( hashes[ 1 ], second ) )
+                        break;
+
+                    result.instructions++;
+                }
+            }
+
+            result.diff = DiffStates( first.GetState( ), second.GetState( ) );
+
+            // An engine that doesn't do the same twice from the same state
+            if ( result.diff.empty( ) )
+                result.diff = "the block parted, replaying it one instruction at a time didn't\n";
+
+            break;
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+static void
+DiffField( std::string& diff, const char* name, int first, int second )
+{
+    if ( first == second )
+        return;
+
+    char line[ 64 ];
+    snprintf( line, sizeof( line ), "%s: %X != %X\n", name, first, second );
+    diff += line;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string
+eclockstep::DiffStates( const EightChipState& first, const EightChipState& second )
+{
+    std::string diff;
+    char name[ 32 ];
+
+    DiffField( diff, "PC", first.m_ProgramCounter, second.m_ProgramCounter );
+    DiffField( diff, "I", first.m_AddressI, second.m_AddressI );
+
+    for ( int i = 0; i < 16; i++ )
+    {
+        snprintf( name, sizeof( name ), "V%X", i );
+        DiffField( diff, name, first.m_Registers[ i ], second.m_Registers[ i ] );
+    }
+
+    DiffField( diff, "DT", first.m_DelayTimer, second.m_DelayTimer );
+    DiffField( diff, "ST", first.m_SoundTimer, second.m_SoundTimer );
+    DiffField( diff, "SP", first.m_StackPointer, second.m_StackPointer );
+
+    for ( int i = 0; i < STACK_DEPTH; i++ )
+    {
+        snprintf( name, sizeof( name ), "stack[%d]", i );
+        DiffField( diff, name, first.m_Stack[ i ], second.m_Stack[ i ] );
+    }
+
+    for ( int i = 0; i < 16; i++ )
+    {
+        snprintf( name, sizeof( name ), "key %X", i );
+        DiffField( diff, name, first.m_KeyState[ i ], second.m_KeyState[ i ] );
+
+        snprintf( name, sizeof( name ), "RPL%X", i );
+        DiffField( diff, name, first.m_RPLFlags[ i ], second.m_RPLFlags[ i ] );
+
+        snprintf( name, sizeof( name ), "audio[%d]", i );
+        DiffField( diff, name, first.m_AudioPattern[ i ], second.m_AudioPattern[ i ] );
+    }
+
+    DiffField( diff, "hires", first.m_HighResolution, second.m_HighResolution );
+    DiffField( diff, "halted", first.m_Halted, second.m_Halted );
+    DiffField( diff, "planes", first.m_PlaneMask, second.m_PlaneMask );
+    DiffField( diff, "pitch", first.m_Pitch, second.m_Pitch );
+    DiffField( diff, "faults", first.m_Faults, second.m_Faults );
+    DiffField( diff,
+               "random",
+               static_cast< int >( first.m_RandomState ),
+               static_cast< int >( second.m_RandomState ) );
+    DiffField( diff, "cycles", first.m_CycleBalance, second.m_CycleBalance );
+    DiffField( diff, "waiting", first.m_WaitingFrame, second.m_WaitingFrame );
+
+    // Runs of different bytes, the first few of each
+    char line[ 128 ];
+    int address = 0;
+
+    while ( address < ROMSIZE )
+    {
+        if ( first.m_GameMemory[ address ] == second.m_GameMemory[ address ] )
+        {
+            address++;
+            continue;
+        }
+
+        int end = address;
+
+        while ( end < ROMSIZE && first.m_GameMemory[ end ] != second.m_GameMemory[ end ] )
+            end++;
+
+        snprintf( line, sizeof( line ), "memory 0x%04X-0x%04X:", address, end - 1 );
+        diff += line;
+
+        for ( int side = 0; side < 2; side++ )
+        {
+            const BYTE* memory = ( side == 0 ) ? first.m_GameMemory : second.m_GameMemory;
+
+            diff += ( side == 0 ) ? "" : " !=";
+
+            for ( int i = address; i < end && i < address + 8; i++ )
+            {
+                snprintf( line, sizeof( line ), " %02X", memory[ i ] );
+                diff += line;
+            }
+
+            if ( end - address > 8 )
+                diff += " ...";
+        }
+
+        diff += "\n";
+        address = end;
+    }
+
+    for ( int plane = 0; plane < DISPLAY_PLANES; plane++ )
+    {
+        std::string rows;
+
+        for ( int y = 0; y < DISPLAY_HEIGHT; y++ )
+        {
+            if ( memcmp( first.m_Display[ plane ].rows[ y ], second.m_Display[ plane ].rows[ y ],
+                         sizeof( first.m_Display[ plane ].rows[ y ] ) ) != 0 )
+            {
+                snprintf( line, sizeof( line ), " %d", y );
+                rows += line;
+            }
+        }
+
+        if ( !rows.empty( ) )
+        {
+            snprintf( line, sizeof( line ), "display plane %d rows:", plane );
+            diff += line + rows + "\n";
+        }
+    }
+
+    return diff;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A key changes about every 8 frames, held down for as long as it takes to come up again. */
+std::vector< EightChipKeyEvent >
+eclockstep::RandomInput( unsigned int seed, int frames )
+{
+    std::vector< EightChipKeyEvent > input;
+    unsigned int state = ( seed != 0 ) ? seed : 0x2545F491;
+    bool down[ 16 ] = {};
+
+    for ( int frame = 0; frame < frames; frame++ )
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        if ( ( state & 0x7 ) != 0 )
+            continue;
+
+        EightChipKeyEvent event;
+        event.frame = frame;
+        event.key = static_cast< BYTE >( ( state >> 8 ) & 0xF );
+        event.down = !down[ event.key ];
+
+        down[ event.key ] = event.down;
+        input.push_back( event );
+    }
+
+    return input;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,257 @@
+#include <cstdio>
+
+#include "ECOpcodes.h"
+
+//-------------------------------------------------------------------------------------------------
+/** Indexed by EightChipOpcodeId. */
+static const EightChipOpcodeInfo OPCODE_INFO[ OP_COUNT ] = {
+    { "???", OPF_NONE },
+    { "CLS", OPF_NONE },
+    { "RET", OPF_RETURN },
+    { "JP addr", OPF_JUMP },
+    { "CALL addr", OPF_CALL },
+    { "SE Vx, byte", OPF_SKIP },
+    { "SNE Vx, byte", OPF_SKIP },
+    { "SE Vx, Vy", OPF_SKIP },
+    { "LD Vx, byte", OPF_NONE },
+    { "ADD Vx, byte", OPF_NONE },
+    { "LD Vx, Vy", OPF_NONE },
+    { "OR Vx, Vy", OPF_NONE },
+    { "AND Vx, Vy", OPF_NONE },
+    { "XOR Vx, Vy", OPF_NONE },
+    { "ADD Vx, Vy", OPF_NONE },
+    { "SUB Vx, Vy", OPF_NONE },
+    { "SHR Vx {, Vy}", OPF_NONE },
+    { "SUBN Vx, Vy", OPF_NONE },
+    { "SHL Vx {, Vy}", OPF_NONE },
+    { "SNE Vx, Vy", OPF_SKIP },
+    { "LD I, addr", OPF_SETS_I },
+    { "JP V0, addr", OPF_COMPUTED_JUMP },
+    { "RND Vx, byte", OPF_NONE },
+    { "DRW Vx, Vy, nibble", OPF_READS_MEMORY },
+    { "SKP Vx", OPF_SKIP },
+    { "SKNP Vx", OPF_SKIP },
+    { "LD Vx, DT", OPF_NONE },
+    { "LD Vx, K", OPF_NONE },
+    { "LD DT, Vx", OPF_NONE },
+    { "LD ST, Vx", OPF_NONE },
+    { "ADD I, Vx", OPF_MODIFIES_I },
+    { "LD F, Vx", OPF_MODIFIES_I },
+    { "LD B, Vx", OPF_WRITES_MEMORY },
+    { "LD [I], Vx", OPF_WRITES_MEMORY | OPF_MODIFIES_I },
+    { "LD Vx, [I]", OPF_READS_MEMORY | OPF_MODIFIES_I },
+    { "SCD nibble", OPF_NONE },
+    { "SCR", OPF_NONE },
+    { "SCL", OPF_NONE },
+    { "EXIT", OPF_EXIT },
+    { "LOW", OPF_NONE },
+    { "HIGH", OPF_NONE },
+    { "LD HF, Vx", OPF_MODIFIES_I },
+    { "LD R, Vx", OPF_NONE },
+    { "LD Vx, R", OPF_NONE },
+    { "SCU nibble", OPF_NONE },
+    { "SAVE Vx - Vy", OPF_WRITES_MEMORY },
+    { "LOAD Vx - Vy", OPF_READS_MEMORY },
+    { "LD I, long", OPF_SETS_I | OPF_LONG },
+    { "PLANE planes", OPF_NONE },
+    { "AUDIO", OPF_READS_MEMORY },
+    { "PITCH Vx", OPF_NONE },
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Sets the instruction of every opcode equal to pattern on the bits of mask. The free bits are
+ * walked as subsets, so only the matching opcodes are visited.
+ */
+static constexpr void
+Fill( EightChipDecodeTable& table, WORD pattern, WORD mask, EightChipOpcodeId id )
+{
+    WORD free = ~mask & 0xFFFF;
+    WORD bits = free;
+
+    while ( true )
+    {
+        table.ids[ pattern | bits ] = id;
+
+        if ( bits == 0 )
+            break;
+
+        bits = ( bits - 1 ) & free;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Every opcode not listed here stays OP_INVALID and traps. */
+static constexpr EightChipDecodeTable
+BuildDecodeTable( )
+{
+    EightChipDecodeTable table = { };
+
+    Fill( table, 0x00E0, 0xFFFF, OP_00E0 );
+    Fill( table, 0x00EE, 0xFFFF, OP_00EE );
+    Fill( table, 0x00C0, 0xFFF0, OP_00CN );
+    Fill( table, 0x00D0, 0xFFF0, OP_00DN );
+    Fill( table, 0x00FB, 0xFFFF, OP_00FB );
+    Fill( table, 0x00FC, 0xFFFF, OP_00FC );
+    Fill( table, 0x00FD, 0xFFFF, OP_00FD );
+    Fill( table, 0x00FE, 0xFFFF, OP_00FE );
+    Fill( table, 0x00FF, 0xFFFF, OP_00FF );
+    Fill( table, 0x1000, 0xF000, OP_1NNN );
+    Fill( table, 0x2000, 0xF000, OP_2NNN );
+    Fill( table, 0x3000, 0xF000, OP_3XKK );
+    Fill( table, 0x4000, 0xF000, OP_4XKK );
+    Fill( table, 0x5000, 0xF00F, OP_5XY0 );
+    Fill( table, 0x5002, 0xF00F, OP_5XY2 );
+    Fill( table, 0x5003, 0xF00F, OP_5XY3 );
+    Fill( table, 0x6000, 0xF000, OP_6XKK );
+    Fill( table, 0x7000, 0xF000, OP_7XKK );
+    Fill( table, 0x8000, 0xF00F, OP_8XY0 );
+    Fill( table, 0x8001, 0xF00F, OP_8XY1 );
+    Fill( table, 0x8002, 0xF00F, OP_8XY2 );
+    Fill( table, 0x8003, 0xF00F, OP_8XY3 );
+    Fill( table, 0x8004, 0xF00F, OP_8XY4 );
+    Fill( table, 0x8005, 0xF00F, OP_8XY5 );
+    Fill( table, 0x8006, 0xF00F, OP_8XY6 );
+    Fill( table, 0x8007, 0xF00F, OP_8XY7 );
+    Fill( table, 0x800E, 0xF00F, OP_8XYE );
+    Fill( table, 0x9000, 0xF000, OP_9XY0 );
+    Fill( table, 0xA000, 0xF000, OP_ANNN );
+    Fill( table, 0xB000, 0xF000, OP_BNNN );
+    Fill( table, 0xC000, 0xF000, OP_CXKK );
+    Fill( table, 0xD000, 0xF000, OP_DXYN );
+    Fill( table, 0xE09E, 0xF0FF, OP_EX9E );
+    Fill( table, 0xE0A1, 0xF0FF, OP_EXA1 );
+    Fill( table, 0xF000, 0xFFFF, OP_F000 );
+    Fill( table, 0xF001, 0xF0FF, OP_FN01 );
+    Fill( table, 0xF002, 0xFFFF, OP_F002 );
+    Fill( table, 0xF007, 0xF0FF, OP_FX07 );
+    Fill( table, 0xF00A, 0xF0FF, OP_FX0A );
+    Fill( table, 0xF015, 0xF0FF, OP_FX15 );
+    Fill( table, 0xF018, 0xF0FF, OP_FX18 );
+    Fill( table, 0xF01E, 0xF0FF, OP_FX1E );
+    Fill( table, 0xF029, 0xF0FF, OP_FX29 );
+    Fill( table, 0xF030, 0xF0FF, OP_FX30 );
+    Fill( table, 0xF033, 0xF0FF, OP_FX33 );
+    Fill( table, 0xF03A, 0xF0FF, OP_FX3A );
+    Fill( table, 0xF055, 0xF0FF, OP_FX55 );
+    Fill( table, 0xF065, 0xF0FF, OP_FX65 );
+    Fill( table, 0xF075, 0xF0FF, OP_FX75 );
+    Fill( table, 0xF085, 0xF0FF, OP_FX85 );
+
+    return table;
+}
+
+//-------------------------------------------------------------------------------------------------
+constexpr EightChipDecodeTable ecops::DECODE_TABLE = BuildDecodeTable( );
+
+// EX9E and EXA1 are told apart by their whole low byte
+static_assert( ecops::DECODE_TABLE.ids[ 0xE39E ] == OP_EX9E, "EX9E decodes to SKP" );
+static_assert( ecops::DECODE_TABLE.ids[ 0xE3A1 ] == OP_EXA1, "EXA1 decodes to SKNP" );
+static_assert( ecops::DECODE_TABLE.ids[ 0xE30E ] == OP_INVALID, "EX0E is not an instruction" );
+
+//-------------------------------------------------------------------------------------------------
+/** The extensions come after CHIP-8's instructions, SUPER-CHIP first (see. EightChipOpcodeId). */
+bool
+ecops::IsSupported( EightChipOpcodeId id, EightChipProfile profile )
+{
+    if ( id >= OP_00DN )
+        return ecquirks::HasXoChipOpcodes( profile );
+
+    if ( id >= OP_00CN )
+        return ecquirks::HasSuperChipOpcodes( profile );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipOpcodeId
+ecops::Identify( WORD opcode, EightChipProfile profile )
+{
+    EightChipOpcodeId id = static_cast< EightChipOpcodeId >( DECODE_TABLE.ids[ opcode ] );
+
+    return IsSupported( id, profile ) ? id : OP_INVALID;
+}
+
+//-------------------------------------------------------------------------------------------------
+const EightChipOpcodeInfo&
+ecops::GetInfo( EightChipOpcodeId id )
+{
+    return OPCODE_INFO[ id ];
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+ecops::GetLength( WORD opcode, EightChipProfile profile )
+{
+    return ( GetInfo( Identify( opcode, profile ) ).flags & OPF_LONG ) ? 4 : 2;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Fills in the operands of the syntax string with the fields of the opcode. */
+std::string
+ecops::Disassemble( WORD opcode, WORD operand )
+{
+    EightChipOpcodeId id = static_cast< EightChipOpcodeId >( DECODE_TABLE.ids[ opcode ] );
+
+    if ( id == OP_INVALID )
+    {
+        char data[ 16 ];
+        snprintf( data, sizeof( data ), "DW 0x%04X", opcode );
+        return data;
+    }
+
+    std::string syntax = GetInfo( id ).syntax;
+    std::string res;
+    char field[ 8 ];
+
+    size_t i = 0;
+    while ( i < syntax.size( ) )
+    {
+        if ( syntax.compare( i, 2, "Vx" ) == 0 )
+        {
+            snprintf( field, sizeof( field ), "V%X", ( opcode >> 8 ) & 0xF );
+            i += 2;
+        }
+        else if ( syntax.compare( i, 2, "Vy" ) == 0 )
+        {
+            snprintf( field, sizeof( field ), "V%X", ( opcode >> 4 ) & 0xF );
+            i += 2;
+        }
+        else if ( syntax.compare( i, 4, "byte" ) == 0 )
+        {
+            snprintf( field, sizeof( field ), "0x%02X", opcode & 0xFF );
+            i += 4;
+        }
+        else if ( syntax.compare( i, 4, "addr" ) == 0 )
+        {
+            snprintf( field, sizeof( field ), "0x%03X", opcode & 0xFFF );
+            i += 4;
+        }
+        else if ( syntax.compare( i, 6, "planes" ) == 0 )
+        {
+            snprintf( field, sizeof( field ), "%X", ( opcode >> 8 ) & 0xF );
+            i += 6;
+        }
+        else if ( syntax.compare( i, 4, "long" ) == 0 )
+        {
+            snprintf( field, sizeof( field ), "0x%04X", operand );
+            i += 4;
+        }
+        else if ( syntax.compare( i, 6, "nibble" ) == 0 )
+        {
+            snprintf( field, sizeof( field ), "%X", opcode & 0xF );
+            i += 6;
+        }
+        else
+        {
+            field[ 0 ] = syntax[ i ];
+            field[ 1 ] = '\0';
+            i++;
+        }
+
+        res += field;
+    }
+
+    return res;
+}
+
+//-------------------------------------------------------------------------------------------------
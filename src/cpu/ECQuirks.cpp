@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cctype>
+
+#include "ECQuirks.h"
+
+//-------------------------------------------------------------------------------------------------
+// Indexed by EightChipProfile
+static const char* PROFILE_NAMES[ PROFILE_COUNT ] = { "eightchip", "chip8", "schip", "xochip" };
+
+//-------------------------------------------------------------------------------------------------
+// The policies' constants the code that isn't instantiated per profile looks up
+struct PolicyConstants
+{
+    bool loadStoreIncrementsI;
+    bool superChipOpcodes;
+    bool xoChipOpcodes;
+};
+
+template < class QUIRKS >
+static constexpr PolicyConstants
+ConstantsOf( )
+{
+    return { QUIRKS::LOAD_STORE_INCREMENTS_I, QUIRKS::SUPERCHIP_OPCODES, QUIRKS::XOCHIP_OPCODES };
+}
+
+// Indexed by EightChipProfile
+static const PolicyConstants POLICY_CONSTANTS[ PROFILE_COUNT ] = {
+    ConstantsOf< ecquirks::EightChip >( ),
+    ConstantsOf< ecquirks::Chip8 >( ),
+    ConstantsOf< ecquirks::SuperChip >( ),
+    ConstantsOf< ecquirks::XoChip >( ),
+};
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecquirks::ProfileFromName( const std::string& name, EightChipProfile& profile )
+{
+    std::string lower = name;
+    std::transform( lower.begin( ), lower.end( ), lower.begin( ), ::tolower );
+
+    for ( int i = 0; i < PROFILE_COUNT; i++ )
+    {
+        if ( lower == PROFILE_NAMES[ i ] )
+        {
+            profile = static_cast< EightChipProfile >( i );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipProfile
+ecquirks::ProfileFromRomFile( const std::string& filename )
+{
+    size_t dot = filename.find_last_of( '.' );
+
+    if ( dot == std::string::npos )
+        return PROFILE_EIGHTCHIP;
+
+    std::string extension = filename.substr( dot + 1 );
+    std::transform( extension.begin( ), extension.end( ), extension.begin( ), ::tolower );
+
+    if ( extension == "ch8" )
+        return PROFILE_CHIP8;
+    if ( extension == "sc8" )
+        return PROFILE_SUPERCHIP;
+    if ( extension == "xo8" )
+        return PROFILE_XOCHIP;
+
+    return PROFILE_EIGHTCHIP;
+}
+
+//-------------------------------------------------------------------------------------------------
+const char*
+ecquirks::GetProfileName( EightChipProfile profile )
+{
+    return PROFILE_NAMES[ profile ];
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecquirks::LoadStoreIncrementsI( EightChipProfile profile )
+{
+    return POLICY_CONSTANTS[ profile ].loadStoreIncrementsI;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecquirks::HasSuperChipOpcodes( EightChipProfile profile )
+{
+    return POLICY_CONSTANTS[ profile ].superChipOpcodes;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecquirks::HasXoChipOpcodes( EightChipProfile profile )
+{
+    return POLICY_CONSTANTS[ profile ].xoChipOpcodes;
+}
+
+//-------------------------------------------------------------------------------------------------
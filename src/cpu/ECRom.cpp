@@ -0,0 +1,39 @@
+#include <cstdio>
+
+#include "ECRom.h"
+
+//-------------------------------------------------------------------------------------------------
+bool
+ecrom::ReadFile( const std::string& filename, std::vector< BYTE >& data )
+{
+    FILE* file = fopen( filename.c_str( ), "rb" );
+
+    if ( file == NULL )
+        return false;
+
+    BYTE buffer[ 4096 ];
+    size_t read;
+
+    data.clear( );
+
+    while ( ( read = fread( buffer, 1, sizeof( buffer ), file ) ) > 0 )
+        data.insert( data.end( ), buffer, buffer + read );
+
+    fclose( file );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string
+ecrom::BaseName( const std::string& filename )
+{
+    size_t separator = filename.find_last_of( "/\\" );
+
+    if ( separator == std::string::npos )
+        return filename;
+
+    return filename.substr( separator + 1 );
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,45 @@
+#include "ECRomImage.h"
+#include "ECCpu.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipRomImage::EightChipRomImage( )
+    : m_CPU( new EightChipCPU( ) )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipRomImage::~EightChipRomImage( )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipRomImage::Load( const BYTE* rom, size_t size, EightChipProfile profile )
+{
+    m_CPU->SetProfile( profile );
+
+    return m_CPU->InitRom( rom, size );
+}
+
+bool
+EightChipRomImage::Load( const std::string& rom_filename, EightChipProfile profile )
+{
+    m_CPU->SetProfile( profile );
+
+    return m_CPU->InitRom( rom_filename );
+}
+
+//-------------------------------------------------------------------------------------------------
+const EightChipState&
+EightChipRomImage::GetState( ) const
+{
+    return m_CPU->GetState( );
+}
+
+EightChipProfile
+EightChipRomImage::GetProfile( ) const
+{
+    return m_CPU->GetProfile( );
+}
+
+//-------------------------------------------------------------------------------------------------
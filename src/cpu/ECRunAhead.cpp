@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include "ECRunAhead.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipRunAhead::EightChipRunAhead( int frames, int budget, bool vipTiming )
+    : m_Frames( std::max( 0, std::min( frames, RUN_AHEAD_MAX_FRAMES ) ) )
+    , m_Budget( budget )
+    , m_VipTiming( vipTiming )
+    , m_Debugger( nullptr )
+    , m_Tracer( nullptr )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+EightChipRunAhead::GetFrames( ) const
+{
+    return m_Frames;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipRunAhead::RunFrame( EightChipCPU& cpu ) const
+{
+    cpu.DecreaseTimers( );
+
+    if ( m_VipTiming )
+        cpu.ExecuteCycles( m_Budget );
+    else
+        cpu.ExecuteOpCodes( m_Budget );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipRunAhead::RunAhead( EightChipCPU& cpu )
+{
+    m_Snapshot = cpu.GetState( );
+
+    m_Debugger = cpu.GetDebugger( );
+    m_Tracer = cpu.GetTracer( );
+
+    if ( m_Debugger != nullptr )
+        cpu.SetDebugger( nullptr );
+
+    if ( m_Tracer != nullptr )
+        cpu.SetTracer( nullptr );
+
+    for ( int i = 0; i < m_Frames; i++ )
+        RunFrame( cpu );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipRunAhead::Restore( EightChipCPU& cpu )
+{
+    cpu.SetState( m_Snapshot );
+
+    if ( m_Debugger != nullptr )
+        cpu.SetDebugger( m_Debugger );
+
+    if ( m_Tracer != nullptr )
+        cpu.SetTracer( m_Tracer );
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,241 @@
+#include <cstring>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define EIGHTCHIP_POSIX_SHM
+#endif
+
+#include "ECShared.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipSharedMemory::EightChipSharedMemory( )
+    : m_Segment( nullptr )
+    , m_FrameCount( 0 )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipSharedMemory::~EightChipSharedMemory( )
+{
+    Close( );
+}
+
+//-------------------------------------------------------------------------------------------------
+#ifdef EIGHTCHIP_POSIX_SHM
+/** Maps the segment, creating and sizing it first on the emulator side. */
+static EightChipSharedSegment*
+MapSegment( const std::string& name, bool create )
+{
+    int descriptor = create ? shm_open( name.c_str( ), O_CREAT | O_RDWR, 0600 )
+                            : shm_open( name.c_str( ), O_RDWR, 0 );
+
+    if ( descriptor < 0 )
+        return nullptr;
+
+    if ( create && ftruncate( descriptor, sizeof( EightChipSharedSegment ) ) != 0 )
+    {
+        close( descriptor );
+        shm_unlink( name.c_str( ) );
+        return nullptr;
+    }
+
+    void* address = mmap( nullptr, sizeof( EightChipSharedSegment ), PROT_READ | PROT_WRITE,
+                          MAP_SHARED, descriptor, 0 );
+
+    // The mapping stays valid once the descriptor is closed
+    close( descriptor );
+
+    return ( address != MAP_FAILED ) ? static_cast< EightChipSharedSegment* >( address ) : nullptr;
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipSharedMemory::Create( const std::string& name )
+{
+#ifdef EIGHTCHIP_POSIX_SHM
+    Close( );
+
+    m_Segment = MapSegment( name, true );
+
+    if ( m_Segment == nullptr )
+        return false;
+
+    // A segment left behind by an earlier run is started over
+    memset( static_cast< void* >( m_Segment ), 0, sizeof( EightChipSharedSegment ) );
+    m_Segment->magic = SHARED_MAGIC;
+    m_Segment->version = SHARED_VERSION;
+
+    m_Owned = name;
+    m_FrameCount = 0;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipSharedMemory::Open( const std::string& name )
+{
+#ifdef EIGHTCHIP_POSIX_SHM
+    Close( );
+
+    m_Segment = MapSegment( name, false );
+
+    if ( m_Segment == nullptr )
+        return false;
+
+    if ( m_Segment->magic != SHARED_MAGIC || m_Segment->version != SHARED_VERSION )
+    {
+        Close( );
+        return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipSharedMemory::Close( )
+{
+#ifdef EIGHTCHIP_POSIX_SHM
+    if ( m_Segment != nullptr )
+        munmap( m_Segment, sizeof( EightChipSharedSegment ) );
+
+    if ( !m_Owned.empty( ) )
+        shm_unlink( m_Owned.c_str( ) );
+#endif
+
+    m_Segment = nullptr;
+    m_Owned.clear( );
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipSharedMemory::IsOpen( ) const
+{
+    return m_Segment != nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+const EightChipSharedSegment*
+EightChipSharedMemory::GetSegment( ) const
+{
+    return m_Segment;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The slot goes odd, is filled, then goes even again: a reader that overlaps the write sees
+ * the sequence change and retries.
+ */
+void
+EightChipSharedMemory::PublishFrame( const EightChipCPU& cpu )
+{
+    if ( m_Segment == nullptr )
+        return;
+
+    const EightChipState& state = cpu.GetState( );
+    EightChipSharedSlot& slot = m_Segment->frames[ m_FrameCount % SHARED_FRAME_SLOTS ];
+
+    unsigned int sequence = slot.sequence.load( std::memory_order_relaxed );
+    slot.sequence.store( sequence + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    EightChipSharedFrame& frame = slot.data;
+
+    frame.frame = m_FrameCount;
+    frame.programCounter = state.m_ProgramCounter;
+    frame.addressI = state.m_AddressI;
+    memcpy( frame.registers, state.m_Registers, sizeof( frame.registers ) );
+    frame.delayTimer = state.m_DelayTimer;
+    frame.soundTimer = state.m_SoundTimer;
+    frame.highResolution = state.m_HighResolution;
+    frame.planeMask = state.m_PlaneMask;
+    memcpy( frame.display, state.m_Display, sizeof( frame.display ) );
+
+    slot.sequence.store( sequence + 2, std::memory_order_release );
+
+    m_FrameCount++;
+    m_Segment->latestFrame.store( static_cast< unsigned int >( m_FrameCount ),
+                                  std::memory_order_release );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipSharedMemory::PollInput( EightChipCPU& cpu )
+{
+    if ( m_Segment == nullptr )
+        return;
+
+    unsigned int tail = m_Segment->inputTail.load( std::memory_order_relaxed );
+    unsigned int head = m_Segment->inputHead.load( std::memory_order_acquire );
+
+    for ( ; tail != head; tail++ )
+    {
+        const EightChipSharedKey& event = m_Segment->input[ tail % SHARED_INPUT_SLOTS ];
+
+        if ( event.down )
+            cpu.KeyDown( event.key & 0xF );
+        else
+            cpu.KeyUp( event.key & 0xF );
+    }
+
+    m_Segment->inputTail.store( tail, std::memory_order_release );
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipSharedMemory::ReadFrame( EightChipSharedFrame& frame ) const
+{
+    if ( m_Segment == nullptr )
+        return false;
+
+    unsigned int latest = m_Segment->latestFrame.load( std::memory_order_acquire );
+
+    if ( latest == 0 )
+        return false;
+
+    const EightChipSharedSlot& slot = m_Segment->frames[ ( latest - 1 ) % SHARED_FRAME_SLOTS ];
+
+    unsigned int before = slot.sequence.load( std::memory_order_acquire );
+
+    if ( before & 1 )
+        return false;
+
+    memcpy( &frame, &slot.data, sizeof( frame ) );
+
+    std::atomic_thread_fence( std::memory_order_acquire );
+
+    return slot.sequence.load( std::memory_order_relaxed ) == before;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipSharedMemory::SendKey( int key, bool down )
+{
+    if ( m_Segment == nullptr )
+        return false;
+
+    unsigned int head = m_Segment->inputHead.load( std::memory_order_relaxed );
+    unsigned int tail = m_Segment->inputTail.load( std::memory_order_acquire );
+
+    if ( head - tail >= static_cast< unsigned int >( SHARED_INPUT_SLOTS ) )
+        return false;
+
+    EightChipSharedKey& event = m_Segment->input[ head % SHARED_INPUT_SLOTS ];
+    event.key = static_cast< BYTE >( key & 0xF );
+    event.down = down ? 1 : 0;
+
+    m_Segment->inputHead.store( head + 1, std::memory_order_release );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstring>
+
+#include "ECSnapshot.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipSnapshot::EightChipSnapshot( )
+    : m_Hash( 0 )
+{
+    memset( m_Fields, 0, sizeof( m_Fields ) );
+    memset( m_Display, 0, sizeof( m_Display ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+QWORD
+EightChipSnapshot::GetHash( ) const
+{
+    return m_Hash;
+}
+
+//-------------------------------------------------------------------------------------------------
+size_t
+EightChipSnapshot::GetSize( ) const
+{
+    return sizeof( *this ) + m_Pages.capacity( ) * sizeof( WORD ) + m_Memory.capacity( );
+}
+
+//-------------------------------------------------------------------------------------------------
+const std::shared_ptr< const EightChipRomImage >&
+EightChipSnapshot::GetImage( ) const
+{
+    return m_Image;
+}
+
+//-------------------------------------------------------------------------------------------------
+QWORD
+ecsnapshot::Mix( QWORD value )
+{
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBULL;
+    value ^= value >> 31;
+
+    return value;
+}
+
+//-------------------------------------------------------------------------------------------------
+QWORD
+ecsnapshot::HashBytes( QWORD hash, const void* data, size_t size )
+{
+    const BYTE* bytes = static_cast< const BYTE* >( data );
+
+    for ( size_t i = 0; i < size; i += 8 )
+    {
+        QWORD word = 0;
+        memcpy( &word, bytes + i, std::min< size_t >( 8, size - i ) );
+
+        hash = Mix( hash ^ word ) + i;
+    }
+
+    return hash;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Field by field, the padding between them is whatever the allocator left there. */
+QWORD
+ecsnapshot::HashFields( const EightChipState& state )
+{
+    QWORD hash = 0x8C8C8C8C8C8C8C8CULL;
+
+    hash = HashBytes( hash, &state.m_ProgramCounter, sizeof( state.m_ProgramCounter ) );
+    hash = HashBytes( hash, &state.m_AddressI, sizeof( state.m_AddressI ) );
+    hash = HashBytes( hash, state.m_Registers, sizeof( state.m_Registers ) );
+    hash = HashBytes( hash, &state.m_DelayTimer, sizeof( state.m_DelayTimer ) );
+    hash = HashBytes( hash, &state.m_SoundTimer, sizeof( state.m_SoundTimer ) );
+    hash = HashBytes( hash, &state.m_StackPointer, sizeof( state.m_StackPointer ) );
+    hash = HashBytes( hash, state.m_Stack, sizeof( state.m_Stack ) );
+    hash = HashBytes( hash, state.m_KeyState, sizeof( state.m_KeyState ) );
+    hash = HashBytes( hash, &state.m_HighResolution, sizeof( state.m_HighResolution ) );
+    hash = HashBytes( hash, &state.m_Halted, sizeof( state.m_Halted ) );
+    hash = HashBytes( hash, &state.m_PlaneMask, sizeof( state.m_PlaneMask ) );
+    hash = HashBytes( hash, &state.m_Pitch, sizeof( state.m_Pitch ) );
+    hash = HashBytes( hash, &state.m_Faults, sizeof( state.m_Faults ) );
+    hash = HashBytes( hash, &state.m_RandomState, sizeof( state.m_RandomState ) );
+    hash = HashBytes( hash, &state.m_CycleBalance, sizeof( state.m_CycleBalance ) );
+    hash = HashBytes( hash, &state.m_WaitingFrame, sizeof( state.m_WaitingFrame ) );
+    hash = HashBytes( hash, state.m_RPLFlags, sizeof( state.m_RPLFlags ) );
+    hash = HashBytes( hash, state.m_AudioPattern, sizeof( state.m_AudioPattern ) );
+
+    return hash;
+}
+
+//-------------------------------------------------------------------------------------------------
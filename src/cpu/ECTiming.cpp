@@ -0,0 +1,120 @@
+#include "ECTiming.h"
+
+//-------------------------------------------------------------------------------------------------
+// The interpreter's loop at 0x01B, from fetching the opcode to the SEP into its routine and the
+// branch back once it returns, is 34 1802 instructions of 2 machine cycles each.
+static const int VIP_FETCH_CYCLES = 68;
+
+// Indexed by EightChipOpcodeId: fixed part of each instruction's routine, in machine cycles,
+// averages measured on the VIP interpreter. Fetch and decode are VIP_FETCH_CYCLES on top.
+static const WORD VIP_CYCLES[ OP_COUNT ] = {
+    20,   // ???
+    24,   // CLS
+    23,   // RET
+    23,   // JP addr
+    23,   // CALL addr
+    12,   // SE Vx, byte
+    12,   // SNE Vx, byte
+    16,   // SE Vx, Vy
+    6,    // LD Vx, byte
+    10,   // ADD Vx, byte
+    44,   // LD Vx, Vy
+    44,   // OR Vx, Vy
+    44,   // AND Vx, Vy
+    44,   // XOR Vx, Vy
+    44,   // ADD Vx, Vy
+    44,   // SUB Vx, Vy
+    44,   // SHR Vx, Vy
+    44,   // SUBN Vx, Vy
+    44,   // SHL Vx, Vy
+    16,   // SNE Vx, Vy
+    12,   // LD I, addr
+    23,   // JP V0, addr
+    36,   // RND Vx, byte
+    26,   // DRW Vx, Vy, nibble, plus the rows
+    16,   // SKP Vx
+    16,   // SKNP Vx
+    10,   // LD Vx, DT
+    10,   // LD Vx, K, for each time it looks at the keypad
+    10,   // LD DT, Vx
+    10,   // LD ST, Vx
+    19,   // ADD I, Vx
+    20,   // LD F, Vx
+    40,   // LD B, Vx, plus the subtractions
+    14,   // LD [I], Vx, plus the registers
+    14,   // LD Vx, [I], plus the registers
+
+    // SUPER-CHIP
+    24,   // SCD nibble
+    24,   // SCR
+    24,   // SCL
+    23,   // EXIT
+    24,   // LOW
+    24,   // HIGH
+    20,   // LD HF, Vx
+    14,   // LD R, Vx, plus the registers
+    14,   // LD Vx, R, plus the registers
+
+    // XO-CHIP
+    24,   // SCU nibble
+    14,   // SAVE Vx - Vy, plus the registers
+    14,   // LOAD Vx - Vy, plus the registers
+    24,   // LD I, long
+    10,   // PLANE n
+    20,   // AUDIO
+    10,   // PITCH Vx
+};
+
+// Drawing one sprite row, and each bit it's shifted by when x isn't a multiple of 8
+static const int VIP_CYCLES_PER_ROW = 14;
+static const int VIP_CYCLES_PER_SHIFT = 4;
+
+// Each subtraction of the BCD conversion, and each register loaded or stored
+static const int VIP_CYCLES_PER_DIGIT = 8;
+static const int VIP_CYCLES_PER_REGISTER = 14;
+
+//-------------------------------------------------------------------------------------------------
+int
+ectiming::GetCycles( const EightChipState& state, WORD opcode, EightChipOpcodeId id )
+{
+    int cycles = VIP_FETCH_CYCLES + VIP_CYCLES[ id ];
+    int x = ( opcode & 0x0F00 ) >> 8;
+
+    switch ( id )
+    {
+    case OP_DXYN:
+    {
+        int rows = ( opcode & 0x000F ) ? ( opcode & 0x000F ) : 16;
+        int shift = state.m_Registers[ x ] & 7;
+
+        return cycles + rows * ( VIP_CYCLES_PER_ROW + shift * VIP_CYCLES_PER_SHIFT );
+    }
+
+    case OP_FX33:
+    {
+        // Hundreds, tens then units are counted by subtracting 100, then 10, then 1
+        int value = state.m_Registers[ x ];
+
+        return cycles + ( value / 100 + ( value / 10 ) % 10 + value % 10 ) * VIP_CYCLES_PER_DIGIT;
+    }
+
+    case OP_FX55:
+    case OP_FX65:
+    case OP_FX75:
+    case OP_FX85:
+        return cycles + ( x + 1 ) * VIP_CYCLES_PER_REGISTER;
+
+    case OP_5XY2:
+    case OP_5XY3:
+    {
+        int y = ( opcode & 0x00F0 ) >> 4;
+
+        return cycles + ( ( x > y ) ? x - y + 1 : y - x + 1 ) * VIP_CYCLES_PER_REGISTER;
+    }
+
+    default:
+        return cycles;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
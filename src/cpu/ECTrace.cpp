@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "ECCpu.h"
+#include "ECOpcodes.h"
+#include "ECTrace.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipTracer::EightChipTracer( size_t records )
+    : m_Head( 0 )
+    , m_Faults( FAULT_NONE )
+{
+    size_t capacity = 1;
+
+    while ( capacity < records )
+        capacity <<= 1;
+
+    m_Slots.reset( new std::atomic< unsigned long long >[ capacity ] );
+    m_Mask = capacity - 1;
+
+    for ( size_t i = 0; i < capacity; i++ )
+        m_Slots[ i ].store( 0, std::memory_order_relaxed );
+
+    memset( m_Registers, 0, sizeof( m_Registers ) );
+    memset( &m_Memory, 0, sizeof( m_Memory ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipTracer::SetFaultFile( const std::string& filename )
+{
+    m_FaultFile = filename;
+}
+
+//-------------------------------------------------------------------------------------------------
+unsigned long long
+EightChipTracer::GetTotal( ) const
+{
+    return m_Head.load( std::memory_order_acquire );
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * The slot is stored with release semantics after the head was moved to it: a reader that sees
+ * the new record in a slot also sees a head at least that far when it reads it again.
+ */
+void
+EightChipTracer::Push( const EightChipTraceRecord& record )
+{
+    unsigned long long head = m_Head.load( std::memory_order_relaxed );
+    unsigned long long bits;
+
+    memcpy( &bits, &record, sizeof( bits ) );
+
+    m_Slots[ head & m_Mask ].store( bits, std::memory_order_release );
+    m_Head.store( head + 1, std::memory_order_release );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipTracer::PushMemory( )
+{
+    if ( m_Memory.count == 0 )
+        return;
+
+    Push( m_Memory );
+    m_Memory.count = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipTracer::OnInstruction( const EightChipState& state, WORD opcode )
+{
+    // The opcode has already been fetched
+    EightChipTraceRecord record;
+    record.kind = TRACE_INSTRUCTION;
+    record.count = state.m_StackPointer;
+    record.words[ 0 ] = static_cast< WORD >( state.m_ProgramCounter - 2 );
+    record.words[ 1 ] = opcode;
+    record.words[ 2 ] = state.m_AddressI;
+
+    Push( record );
+
+    memcpy( m_Registers, state.m_Registers, sizeof( m_Registers ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Instructions write runs of consecutive bytes (FX33, FX55, 5XY2): they share records. */
+void
+EightChipTracer::OnWrite( WORD address, BYTE value )
+{
+    if ( m_Memory.count == 4
+         || ( m_Memory.count > 0 && address != m_Memory.words[ 0 ] + m_Memory.count ) )
+        PushMemory( );
+
+    if ( m_Memory.count == 0 )
+    {
+        m_Memory.kind = TRACE_MEMORY;
+        m_Memory.words[ 0 ] = address;
+    }
+
+    reinterpret_cast< BYTE* >( &m_Memory.words[ 1 ] )[ m_Memory.count++ ] = value;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipTracer::OnInstructionDone( const EightChipState& state )
+{
+    PushMemory( );
+
+    if ( memcmp( m_Registers, state.m_Registers, sizeof( m_Registers ) ) != 0 )
+    {
+        EightChipTraceRecord record;
+        record.kind = TRACE_REGISTERS;
+        record.count = 0;
+
+        for ( int i = 0; i < 16; i++ )
+        {
+            if ( m_Registers[ i ] == state.m_Registers[ i ] )
+                continue;
+
+            record.words[ record.count++ ] =
+                static_cast< WORD >( ( i << 8 ) | state.m_Registers[ i ] );
+
+            if ( record.count == 3 )
+            {
+                Push( record );
+                record.count = 0;
+            }
+        }
+
+        if ( record.count > 0 )
+            Push( record );
+    }
+
+    // Faults are latched by the CPU, only the new ones are recorded
+    int faults = state.m_Faults & ~m_Faults;
+    m_Faults = state.m_Faults;
+
+    if ( faults == FAULT_NONE )
+        return;
+
+    EightChipTraceRecord record;
+    record.kind = TRACE_FAULT;
+    record.count = 0;
+    record.words[ 0 ] = static_cast< WORD >( faults );
+    record.words[ 1 ] = 0;
+    record.words[ 2 ] = 0;
+
+    Push( record );
+
+    if ( !m_FaultFile.empty( ) )
+        Flush( m_FaultFile );
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * The slots are copied while the writer may go on. Whatever it can have overwritten meanwhile,
+ * up to the slot after the head read once the copy is done, is dropped, as are the change
+ * records left without their instruction.
+ */
+void
+EightChipTracer::Snapshot( std::vector< EightChipTraceRecord >& records ) const
+{
+    const unsigned long long capacity = m_Mask + 1;
+
+    unsigned long long end = m_Head.load( std::memory_order_acquire );
+    unsigned long long begin = ( end > capacity ) ? end - capacity : 0;
+
+    std::vector< unsigned long long > bits( static_cast< size_t >( end - begin ) );
+
+    for ( unsigned long long i = begin; i < end; i++ )
+        bits[ static_cast< size_t >( i - begin ) ] =
+            m_Slots[ i & m_Mask ].load( std::memory_order_relaxed );
+
+    std::atomic_thread_fence( std::memory_order_acquire );
+
+    unsigned long long head = m_Head.load( std::memory_order_relaxed );
+    unsigned long long first = begin;
+
+    if ( head + 1 > begin + capacity )
+        first = head + 1 - capacity;
+
+    records.clear( );
+
+    for ( unsigned long long i = first; i < end; i++ )
+    {
+        EightChipTraceRecord record;
+        memcpy( &record, &bits[ static_cast< size_t >( i - begin ) ], sizeof( record ) );
+
+        if ( records.empty( ) && record.kind != TRACE_INSTRUCTION )
+            continue;
+
+        records.push_back( record );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipTracer::Flush( const std::string& filename, size_t* count ) const
+{
+    std::vector< EightChipTraceRecord > records;
+    Snapshot( records );
+
+    if ( count != nullptr )
+        *count = records.size( );
+
+    EightChipTraceHeader header;
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.count = records.size( );
+    header.total = GetTotal( );
+
+    FILE* file = fopen( filename.c_str( ), "wb" );
+
+    if ( file == NULL )
+        return false;
+
+    bool written = fwrite( &header, sizeof( header ), 1, file ) == 1;
+
+    if ( written && !records.empty( ) )
+        written = fwrite( records.data( ), sizeof( EightChipTraceRecord ), records.size( ), file )
+                  == records.size( );
+
+    return ( fclose( file ) == 0 ) && written;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+ectrace::Load( const std::string& filename,
+               std::vector< EightChipTraceRecord >& records,
+               EightChipTraceHeader& header )
+{
+    FILE* file = fopen( filename.c_str( ), "rb" );
+
+    if ( file == NULL )
+        return false;
+
+    bool read = fread( &header, sizeof( header ), 1, file ) == 1 && header.magic == TRACE_MAGIC
+                && header.version == TRACE_VERSION;
+
+    if ( read )
+    {
+        records.resize( static_cast< size_t >( header.count ) );
+
+        if ( !records.empty( ) )
+            read = fread( records.data( ), sizeof( EightChipTraceRecord ), records.size( ), file )
+                   == records.size( );
+    }
+
+    fclose( file );
+
+    return read;
+}
+
+//-------------------------------------------------------------------------------------------------
+std::string
+ectrace::Describe( const std::vector< EightChipTraceRecord >& records, size_t& index )
+{
+    char field[ 64 ];
+    std::string res;
+
+    const EightChipTraceRecord& instruction = records[ index++ ];
+
+    snprintf( field,
+              sizeof( field ),
+              "0x%04X  %04X  ",
+              instruction.words[ 0 ],
+              instruction.words[ 1 ] );
+    res = field;
+
+    std::string text = ecops::Disassemble( instruction.words[ 1 ] );
+    text.resize( std::max< size_t >( text.size( ), 18 ), ' ' );
+    res += text;
+
+    snprintf( field, sizeof( field ), "  I=%04X SP=%X", instruction.words[ 2 ], instruction.count );
+    res += field;
+
+    if ( index < records.size( ) && records[ index ].kind != TRACE_INSTRUCTION )
+        res += " ";
+
+    for ( ; index < records.size( ) && records[ index ].kind != TRACE_INSTRUCTION; index++ )
+    {
+        const EightChipTraceRecord& change = records[ index ];
+
+        switch ( change.kind )
+        {
+        case TRACE_REGISTERS:
+            for ( int i = 0; i < change.count && i < 3; i++ )
+            {
+                snprintf( field,
+                          sizeof( field ),
+                          " V%X=%02X",
+                          change.words[ i ] >> 8,
+                          change.words[ i ] & 0xFF );
+                res += field;
+            }
+            break;
+
+        case TRACE_MEMORY:
+        {
+            const BYTE* bytes = reinterpret_cast< const BYTE* >( &change.words[ 1 ] );
+
+            snprintf( field, sizeof( field ), " [%04X]=", change.words[ 0 ] );
+            res += field;
+
+            for ( int i = 0; i < change.count && i < 4; i++ )
+            {
+                snprintf( field, sizeof( field ), "%s%02X", ( i > 0 ) ? " " : "", bytes[ i ] );
+                res += field;
+            }
+            break;
+        }
+
+        case TRACE_FAULT:
+            snprintf( field, sizeof( field ), " !faults=%X", change.words[ 0 ] );
+            res += field;
+            break;
+        }
+    }
+
+    return res;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,94 @@
+#include "ECVMPool.h"
+
+//-------------------------------------------------------------------------------------------------
+EightChipVMPool::EightChipVMPool( int capacity )
+    : m_Template( std::make_shared< EightChipRomImage >( ) )
+{
+    m_Machines.reserve( capacity );
+    m_Free.reserve( capacity );
+
+    for ( int i = 0; i < capacity; i++ )
+    {
+        m_Machines.emplace_back( new EightChipCPU( ) );
+        m_Free.push_back( m_Machines.back( ).get( ) );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A new image every time: CPUs still holding the previous one must not mistake it for theirs. */
+bool
+EightChipVMPool::SetTemplate( const BYTE* rom, size_t size )
+{
+    std::shared_ptr< EightChipRomImage > image = std::make_shared< EightChipRomImage >( );
+
+    if ( !image->Load( rom, size, PROFILE_EIGHTCHIP ) )
+        return false;
+
+    m_Template = image;
+
+    return true;
+}
+
+bool
+EightChipVMPool::SetTemplate( const std::string& rom_filename )
+{
+    std::shared_ptr< EightChipRomImage > image = std::make_shared< EightChipRomImage >( );
+
+    if ( !image->Load( rom_filename, PROFILE_EIGHTCHIP ) )
+        return false;
+
+    m_Template = image;
+
+    return true;
+}
+
+void
+EightChipVMPool::SetTemplate( const std::shared_ptr< const EightChipRomImage >& image )
+{
+    m_Template = image;
+}
+
+const std::shared_ptr< const EightChipRomImage >&
+EightChipVMPool::GetTemplate( ) const
+{
+    return m_Template;
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipCPU*
+EightChipVMPool::Acquire( )
+{
+    if ( m_Free.empty( ) )
+        return nullptr;
+
+    EightChipCPU* cpu = m_Free.back( );
+    m_Free.pop_back( );
+
+    Reset( cpu );
+
+    return cpu;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipVMPool::Release( EightChipCPU* cpu )
+{
+    m_Free.push_back( cpu );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A reset never allocates, and mostly copies the pages written since the previous one. */
+void
+EightChipVMPool::Reset( EightChipCPU* cpu ) const
+{
+    cpu->IncrementalReset( m_Template );
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+EightChipVMPool::GetCapacity( ) const
+{
+    return static_cast< int >( m_Machines.size( ) );
+}
+
+//-------------------------------------------------------------------------------------------------
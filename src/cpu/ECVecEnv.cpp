@@ -0,0 +1,316 @@
+#include <algorithm>
+
+#include "ECVecEnv.h"
+
+//-------------------------------------------------------------------------------------------------
+/** Keeps the even pixels of a 64 pixels half row, packed into the low 32 bits. */
+static QWORD
+PackEvenPixels( QWORD pixels )
+{
+    // The leftmost pixel is bit 63, the even pixels are the odd bits
+    QWORD x = ( pixels >> 1 ) & 0x5555555555555555ULL;
+
+    x = ( x | ( x >> 1 ) ) & 0x3333333333333333ULL;
+    x = ( x | ( x >> 2 ) ) & 0x0F0F0F0F0F0F0F0FULL;
+    x = ( x | ( x >> 4 ) ) & 0x00FF00FF00FF00FFULL;
+    x = ( x | ( x >> 8 ) ) & 0x0000FFFF0000FFFFULL;
+    x = ( x | ( x >> 16 ) ) & 0x00000000FFFFFFFFULL;
+
+    return x;
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipVecEnv::EightChipVecEnv( const EightChipEnvConfig& config )
+    : m_Config( config )
+    , m_Pool( config.instances )
+    , m_Episodes( config.instances, 0 )
+    , m_Watched( config.instances * config.watches.size( ), 0 )
+    , m_Done( config.instances, 0 )
+    , m_Seed( 0 )
+    , m_Actions( nullptr )
+    , m_Frames( 0 )
+    , m_Observations( nullptr )
+    , m_Rewards( nullptr )
+    , m_Dones( nullptr )
+    , m_Work( nullptr )
+    , m_Generation( 0 )
+    , m_Pending( 0 )
+    , m_Stopping( false )
+{
+    m_Config.observationPlanes =
+        std::max( 1, std::min( m_Config.observationPlanes, DISPLAY_PLANES ) );
+
+    for ( int i = 0; i < config.instances; i++ )
+        m_Machines.push_back( m_Pool.Acquire( ) );
+
+    int threads = m_Config.threads;
+    if ( threads <= 0 )
+        threads = std::max( 1, static_cast< int >( std::thread::hardware_concurrency( ) ) );
+
+    // The calling thread takes the last share itself
+    threads = std::min( threads, std::max( 1, config.instances ) );
+    m_Config.threads = threads;
+
+    for ( int worker = 0; worker < threads - 1; worker++ )
+        m_Workers.emplace_back( &EightChipVecEnv::WorkerLoop, this, worker );
+}
+
+//-------------------------------------------------------------------------------------------------
+EightChipVecEnv::~EightChipVecEnv( )
+{
+    {
+        std::lock_guard< std::mutex > lock( m_Mutex );
+        m_Stopping = true;
+    }
+
+    m_WorkReady.notify_all( );
+
+    for ( std::thread& worker : m_Workers )
+        worker.join( );
+}
+
+//-------------------------------------------------------------------------------------------------
+bool
+EightChipVecEnv::LoadRom( const BYTE* rom, size_t size )
+{
+    return m_Pool.SetTemplate( rom, size );
+}
+
+bool
+EightChipVecEnv::LoadRom( const std::string& rom_filename )
+{
+    return m_Pool.SetTemplate( rom_filename );
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+EightChipVecEnv::GetInstances( ) const
+{
+    return m_Config.instances;
+}
+
+int
+EightChipVecEnv::GetObservationSize( ) const
+{
+    return m_Config.observationPlanes * OBSERVATION_HEIGHT;
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipVecEnv::Reset( unsigned int seed, QWORD* observations )
+{
+    m_Seed = seed;
+    m_Observations = observations;
+
+    std::fill( m_Episodes.begin( ), m_Episodes.end( ), 0 );
+
+    RunParallel( &EightChipVecEnv::ResetRange );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipVecEnv::Step( const WORD* actions,
+                       int frames,
+                       QWORD* observations,
+                       float* rewards,
+                       BYTE* dones )
+{
+    m_Actions = actions;
+    m_Frames = frames;
+    m_Observations = observations;
+    m_Rewards = rewards;
+    m_Dones = dones;
+
+    RunParallel( &EightChipVecEnv::StepRange );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipVecEnv::ResetRange( int begin, int end )
+{
+    for ( int index = begin; index < end; index++ )
+    {
+        ResetInstance( index );
+
+        if ( m_Observations != nullptr )
+            Observe( index );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Each episode gets its own seed, so that runs can be replayed from the seed of Reset( ). */
+void
+EightChipVecEnv::ResetInstance( int index )
+{
+    EightChipCPU* cpu = m_Machines[ index ];
+
+    m_Pool.Reset( cpu );
+    cpu->SetProfile( m_Config.profile );
+    cpu->SetRandomSeed( m_Seed + index + m_Episodes[ index ] * m_Config.instances );
+
+    m_Episodes[ index ]++;
+    m_Done[ index ] = 0;
+
+    int watches = static_cast< int >( m_Config.watches.size( ) );
+
+    for ( int w = 0; w < watches; w++ )
+        m_Watched[ index * watches + w ] = ReadWatch( cpu, m_Config.watches[ w ] );
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipVecEnv::StepRange( int begin, int end )
+{
+    int watches = static_cast< int >( m_Config.watches.size( ) );
+
+    for ( int index = begin; index < end; index++ )
+    {
+        EightChipCPU* cpu = m_Machines[ index ];
+
+        if ( m_Done[ index ] )
+            ResetInstance( index );
+
+        // The action holds its keys down for the whole step
+        WORD action = m_Actions[ index ];
+
+        for ( int key = 0; key < 16; key++ )
+        {
+            if ( action & ( 1 << key ) )
+                cpu->KeyDown( key );
+            else
+                cpu->KeyUp( key );
+        }
+
+        for ( int frame = 0; frame < m_Frames && !cpu->IsHalted( ); frame++ )
+        {
+            cpu->DecreaseTimers( );
+            cpu->ExecuteOpCodes( m_Config.opcodesPerFrame );
+
+            if ( cpu->GetFaults( ) & FAULT_ILLEGAL_OPCODE )
+                break;
+        }
+
+        float reward = 0;
+        bool done = cpu->IsHalted( ) || ( cpu->GetFaults( ) & FAULT_ILLEGAL_OPCODE );
+
+        for ( int w = 0; w < watches; w++ )
+        {
+            const EightChipWatch& watch = m_Config.watches[ w ];
+            int value = ReadWatch( cpu, watch );
+            int& previous = m_Watched[ index * watches + w ];
+
+            if ( watch.kind == WATCH_REWARD )
+                reward += watch.scale * ( value - previous );
+            else if ( value == watch.value )
+                done = true;
+
+            previous = value;
+        }
+
+        m_Done[ index ] = done;
+
+        if ( m_Rewards != nullptr )
+            m_Rewards[ index ] = reward;
+
+        if ( m_Dones != nullptr )
+            m_Dones[ index ] = done;
+
+        if ( m_Observations != nullptr )
+            Observe( index );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+int
+EightChipVecEnv::ReadWatch( const EightChipCPU* cpu, const EightChipWatch& watch ) const
+{
+    const BYTE* memory = cpu->GetState( ).m_GameMemory;
+
+    if ( watch.size == 2 )
+        return ( memory[ watch.address ] << 8 )
+               | memory[ static_cast< WORD >( watch.address + 1 ) ];
+
+    return memory[ watch.address ];
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Samples the top left display pixel of every low resolution pixel. */
+void
+EightChipVecEnv::Observe( int index )
+{
+    const EightChipPlane* display = m_Machines[ index ]->m_Display;
+    QWORD* out = m_Observations + static_cast< size_t >( index ) * GetObservationSize( );
+
+    for ( int plane = 0; plane < m_Config.observationPlanes; plane++ )
+    {
+        for ( int y = 0; y < OBSERVATION_HEIGHT; y++ )
+        {
+            const QWORD* row = display[ plane ].rows[ y * 2 ];
+
+            *out++ = ( PackEvenPixels( row[ 0 ] ) << 32 ) | PackEvenPixels( row[ 1 ] );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipVecEnv::RunParallel( void ( EightChipVecEnv::*work )( int begin, int end ) )
+{
+    int threads = m_Config.threads;
+    int instances = m_Config.instances;
+
+    if ( threads > 1 )
+    {
+        std::lock_guard< std::mutex > lock( m_Mutex );
+        m_Work = work;
+        m_Pending = threads - 1;
+        m_Generation++;
+    }
+
+    m_WorkReady.notify_all( );
+
+    // The calling thread runs the last share
+    ( this->*work )( instances * ( threads - 1 ) / threads, instances );
+
+    if ( threads > 1 )
+    {
+        std::unique_lock< std::mutex > lock( m_Mutex );
+        m_WorkDone.wait( lock, [ this ] { return m_Pending == 0; } );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+void
+EightChipVecEnv::WorkerLoop( int worker )
+{
+    int threads = m_Config.threads;
+    int instances = m_Config.instances;
+    unsigned int generation = 0;
+
+    while ( true )
+    {
+        void ( EightChipVecEnv::*work )( int begin, int end );
+
+        {
+            std::unique_lock< std::mutex > lock( m_Mutex );
+            m_WorkReady.wait( lock, [ & ] { return m_Stopping || m_Generation != generation; } );
+
+            if ( m_Stopping )
+                return;
+
+            generation = m_Generation;
+            work = m_Work;
+        }
+
+        ( this->*work )( instances * worker / threads, instances * ( worker + 1 ) / threads );
+
+        {
+            std::lock_guard< std::mutex > lock( m_Mutex );
+            m_Pending--;
+        }
+
+        m_WorkDone.notify_one( );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
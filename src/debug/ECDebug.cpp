@@ -0,0 +1,132 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "ECCpu.h"
+#include "ECDebugger.h"
+#include "ECQuirks.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * eight_chip_debug: runs a rom headless under the debugger, driven from the console.
+ *
+ * usage: eight_chip_debug ROMFILE [--opcodes-per-frame N] [--frames N]
+ *                         [--profile eightchip|chip8|schip|xochip]
+ *
+ * The rom starts paused before its first instruction. Commands are read from the standard input
+ * whenever the CPU is stopped (see. ecdebug::RunCommand), so a script can be piped in. After
+ * --frames frames without a stop the CPU is paused again, 0 never pauses it.
+ */
+namespace
+{
+    struct DebugOptions
+    {
+        std::string rom;
+        int opcodesPerFrame = 10;
+        int frames = 0;
+        bool hasProfile = false;
+        EightChipProfile profile = PROFILE_EIGHTCHIP;
+    };
+
+    bool
+    ParseArguments( int argc, char* argv[ ], DebugOptions& options )
+    {
+        for ( int i = 1; i < argc; i++ )
+        {
+            bool hasValue = i + 1 < argc;
+
+            if ( strcmp( argv[ i ], "--opcodes-per-frame" ) == 0 && hasValue )
+                options.opcodesPerFrame = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--frames" ) == 0 && hasValue )
+                options.frames = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--profile" ) == 0 && hasValue )
+            {
+                if ( !ecquirks::ProfileFromName( argv[ ++i ], options.profile ) )
+                    return false;
+
+                options.hasProfile = true;
+            }
+            else if ( argv[ i ][ 0 ] != '-' && options.rom.empty( ) )
+                options.rom = argv[ i ];
+            else
+                return false;
+        }
+
+        if ( options.rom.empty( ) )
+            return false;
+
+        if ( !options.hasProfile )
+            options.profile = ecquirks::ProfileFromRomFile( options.rom );
+
+        return true;
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+int
+main( int argc, char* argv[ ] )
+{
+    DebugOptions options;
+
+    if ( !ParseArguments( argc, argv, options ) )
+    {
+        fprintf( stderr,
+                 "usage: %s ROMFILE [--opcodes-per-frame N] [--frames N]\n"
+                 "       [--profile eightchip|chip8|schip|xochip]\n",
+                 argv[ 0 ] );
+        return 1;
+    }
+
+    std::unique_ptr< EightChipCPU > cpu( new EightChipCPU( ) );
+    cpu->SetProfile( options.profile );
+
+    if ( !cpu->InitRom( options.rom ) )
+    {
+        fprintf( stderr, ERR03 "\n" );
+        return 1;
+    }
+
+    EightChipDebugger debugger;
+    cpu->SetDebugger( &debugger );
+    debugger.Pause( );
+
+    int frames = 0;
+
+    while ( !cpu->IsHalted( ) )
+    {
+        if ( debugger.IsStopped( ) )
+        {
+            frames = 0;
+
+            std::cout << ecdebug::DescribeStop( debugger ) << "\n";
+            ecdebug::PrintRegisters( *cpu, std::cout );
+
+            // Reads commands until one of them resumes the CPU
+            std::string line;
+
+            while ( debugger.IsStopped( ) )
+            {
+                std::cout << "> " << std::flush;
+
+                if ( !std::getline( std::cin, line )
+                     || !ecdebug::RunCommand( debugger, *cpu, line, std::cout ) )
+                    return 0;
+            }
+        }
+
+        cpu->DecreaseTimers( );
+        cpu->ExecuteOpCodes( options.opcodesPerFrame );
+
+        if ( options.frames > 0 && ++frames >= options.frames )
+            debugger.Pause( );
+    }
+
+    std::cout << "halted\n";
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
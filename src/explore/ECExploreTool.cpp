@@ -0,0 +1,215 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "ECExplore.h"
+#include "ECQuirks.h"
+#include "ECRomImage.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * eight_chip_explore: searches the inputs that lead a rom to a state (see. ecexplore::Explore).
+ *
+ * usage: eight_chip_explore ROMFILE [--target CONDITION]... [--depth N] [--frames-per-decision N]
+ *                           [--start-frames N] [--opcodes-per-frame N] [--keys LIST]
+ *                           [--max-states N] [--threads N] [--seed N] [--profile NAME]
+ *
+ * A condition is "ADDR[:SIZE]OP VALUE" or "VX OP VALUE", as in --target 0x2F0:2>=100 or
+ * --target V3=0; the search stops at the first state where all of them hold and prints the keys
+ * to hold at each decision to get there. --keys lists the keys a decision chooses from, in hex
+ * as in 4,6,C, besides pressing none. Without targets the space is explored up to the limits and
+ * the tool reports how many states it found. Exits with 2 when a target wasn't reached.
+ */
+namespace
+{
+    struct ExploreOptions
+    {
+        std::string rom;
+        EightChipExploreConfig config;
+        unsigned int seed = 1;
+        bool hasProfile = false;
+        EightChipProfile profile = PROFILE_EIGHTCHIP;
+    };
+
+    //---------------------------------------------------------------------------------------------
+    // Hex keys separated by commas, no key being always one of the choices
+    bool
+    ParseKeys( const char* text, std::vector< WORD >& choices )
+    {
+        choices.assign( 1, 0 );
+
+        while ( *text != '\0' )
+        {
+            char* end = nullptr;
+            long key = strtol( text, &end, 16 );
+
+            if ( end == text || key < 0 || key > 0xF )
+                return false;
+
+            choices.push_back( static_cast< WORD >( 1 << key ) );
+
+            text = ( *end == ',' ) ? end + 1 : end;
+
+            if ( *end != ',' && *end != '\0' )
+                return false;
+        }
+
+        return choices.size( ) > 1;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    bool
+    ParseArguments( int argc, char* argv[ ], ExploreOptions& options )
+    {
+        EightChipExploreConfig& config = options.config;
+
+        for ( int i = 1; i < argc; i++ )
+        {
+            bool hasValue = i + 1 < argc;
+
+            if ( strcmp( argv[ i ], "--target" ) == 0 && hasValue )
+            {
+                EightChipExploreTarget target;
+
+                if ( !ecexplore::ParseTarget( argv[ ++i ], target ) )
+                {
+                    fprintf( stderr, "%s: not a condition\n", argv[ i ] );
+                    return false;
+                }
+
+                config.targets.push_back( target );
+            }
+            else if ( strcmp( argv[ i ], "--keys" ) == 0 && hasValue )
+            {
+                if ( !ParseKeys( argv[ ++i ], config.choices ) )
+                    return false;
+            }
+            else if ( strcmp( argv[ i ], "--depth" ) == 0 && hasValue )
+                config.depth = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--frames-per-decision" ) == 0 && hasValue )
+                config.framesPerDecision = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--start-frames" ) == 0 && hasValue )
+                config.startFrames = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--opcodes-per-frame" ) == 0 && hasValue )
+                config.opcodesPerFrame = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--max-states" ) == 0 && hasValue )
+                config.maxStates = strtoul( argv[ ++i ], nullptr, 0 );
+            else if ( strcmp( argv[ i ], "--threads" ) == 0 && hasValue )
+                config.threads = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--seed" ) == 0 && hasValue )
+                options.seed = static_cast< unsigned int >( strtoul( argv[ ++i ], nullptr, 0 ) );
+            else if ( strcmp( argv[ i ], "--profile" ) == 0 && hasValue )
+            {
+                if ( !ecquirks::ProfileFromName( argv[ ++i ], options.profile ) )
+                    return false;
+
+                options.hasProfile = true;
+            }
+            else if ( argv[ i ][ 0 ] != '-' && options.rom.empty( ) )
+                options.rom = argv[ i ];
+            else
+                return false;
+        }
+
+        return !options.rom.empty( ) && config.framesPerDecision > 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    // "none", or the keys held as in "4+6"
+    std::string
+    KeysName( WORD keys )
+    {
+        if ( keys == 0 )
+            return "none";
+
+        std::string name;
+
+        for ( int key = 0; key < 16; key++ )
+        {
+            if ( ( keys >> key ) & 1 )
+            {
+                if ( !name.empty( ) )
+                    name += "+";
+
+                name += "0123456789ABCDEF"[ key ];
+            }
+        }
+
+        return name;
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+int
+main( int argc, char* argv[ ] )
+{
+    ExploreOptions options;
+
+    if ( !ParseArguments( argc, argv, options ) )
+    {
+        fprintf( stderr,
+                 "usage: %s ROMFILE [--target CONDITION]... [--depth N]\n"
+                 "       [--frames-per-decision N] [--start-frames N] [--opcodes-per-frame N]\n"
+                 "       [--keys LIST] [--max-states N] [--threads N] [--seed N]\n"
+                 "       [--profile eightchip|chip8|schip|xochip]\n",
+                 argv[ 0 ] );
+        return 1;
+    }
+
+    EightChipProfile profile = options.hasProfile ? options.profile
+                                                  : ecquirks::ProfileFromRomFile( options.rom );
+    std::shared_ptr< EightChipRomImage > image = std::make_shared< EightChipRomImage >( );
+
+    if ( !image->Load( options.rom, profile ) )
+    {
+        printf( "%s: %s\n", options.rom.c_str( ), ERR03 );
+        return 1;
+    }
+
+    EightChipExploreResult result;
+    ecexplore::Explore( image, options.seed, options.config, result );
+
+    printf( "%s: %zu states, stopped on %s\n", options.rom.c_str( ), result.states, result.stop );
+    printf( "  depth   frontier   children   duplicates   new states       MB         ms\n" );
+
+    for ( const EightChipExploreLevel& level : result.levels )
+    {
+        printf( "  %5d %10zu %10zu %12zu %12zu %8.1f %10.1f\n",
+                level.depth,
+                level.frontier,
+                level.children,
+                level.duplicates,
+                level.states,
+                level.bytes / 1048576.0,
+                level.milliseconds );
+    }
+
+    if ( options.config.targets.empty( ) )
+        return 0;
+
+    if ( !result.reached )
+    {
+        printf( "  target not reached\n" );
+        return 2;
+    }
+
+    printf( "  target reached after %d frames, %zu decisions of %d frames from frame %d:\n",
+            result.frames,
+            result.path.size( ),
+            options.config.framesPerDecision,
+            options.config.startFrames );
+
+    for ( size_t i = 0; i < result.path.size( ); i++ )
+    {
+        int frame =
+            options.config.startFrames + static_cast< int >( i ) * options.config.framesPerDecision;
+
+        printf( "    frame %6d: %s\n", frame, KeysName( result.path[ i ] ).c_str( ) );
+    }
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,194 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "ECCoverage.h"
+#include "ECRom.h"
+#include "ECVMPool.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * libFuzzer harness. Each input is split into an input schedule and a rom:
+ *
+ * byte 0          : number of key events E in the low 5 bits, quirk profile in bits 5-6
+ * bytes 1 .. 2E   : key events, { frame, key | down << 7 }
+ * bytes 2E+1 ..   : rom image, loaded at 0x200
+ *
+ * The rom runs for FUZZ_FRAMES frames or until it hits an illegal opcode. Faults listed in the
+ * EIGHTCHIP_FUZZ_TRAP environment variable (hex EightChipFault mask, defaults to stack and memory
+ * faults) abort the process so the fuzzer keeps the input as a crash.
+ *
+ * With EIGHTCHIP_FUZZ_COVERAGE set to a file name, the inputs run on the coverage interpreter and
+ * what they covered together is merged into that file at exit (see. EightChipCoverage). Addresses
+ * are those of the guest, so the bitmap shows which parts of the memory the corpus reaches. An
+ * input trapping a fault aborts before the file is written.
+ */
+namespace
+{
+    const int FUZZ_FRAMES = 64;
+    const int FUZZ_OPCODES_PER_FRAME = 16;
+    const int FUZZ_MAX_EVENTS = 0x1F;
+    const int FUZZ_PROFILE_SHIFT = 5;
+
+    const int FUZZ_DEFAULT_TRAP =
+        FAULT_STACK_UNDERFLOW | FAULT_STACK_OVERFLOW | FAULT_MEMORY_BOUNDS;
+
+    // Built once, every input then starts from a copy of the blank template
+    EightChipVMPool* g_Pool = nullptr;
+    int g_TrapMask = FUZZ_DEFAULT_TRAP;
+
+    // Coverage of the current input, and of all the inputs so far
+    EightChipCoverage* g_Coverage = nullptr;
+    EightChipCoverage* g_CoverageTotal = nullptr;
+    std::string g_CoverageFile;
+
+    void
+    SaveCoverage( )
+    {
+        if ( g_CoverageTotal != nullptr && !g_CoverageTotal->MergeInto( g_CoverageFile ) )
+            fprintf( stderr, "EightChip fuzz: unable to write %s\n", g_CoverageFile.c_str( ) );
+    }
+
+    const char*
+    FaultName( int faults )
+    {
+        if ( faults & FAULT_STACK_UNDERFLOW )
+            return "stack underflow";
+        if ( faults & FAULT_STACK_OVERFLOW )
+            return "stack overflow";
+        if ( faults & FAULT_MEMORY_BOUNDS )
+            return "memory access out of bounds";
+        if ( faults & FAULT_ILLEGAL_OPCODE )
+            return "illegal opcode";
+
+        return "unknown fault";
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+extern "C" int
+LLVMFuzzerInitialize( int*, char*** )
+{
+    const char* trap = getenv( "EIGHTCHIP_FUZZ_TRAP" );
+    if ( trap != nullptr )
+        g_TrapMask = static_cast< int >( strtol( trap, nullptr, 16 ) );
+
+    g_Pool = new EightChipVMPool( 1 );
+    g_Pool->SetTemplate( nullptr, 0 );
+
+    const char* coverage = getenv( "EIGHTCHIP_FUZZ_COVERAGE" );
+    if ( coverage != nullptr && coverage[ 0 ] != '\0' )
+    {
+        g_Coverage = new EightChipCoverage( );
+        g_CoverageFile = coverage;
+        atexit( SaveCoverage );
+    }
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+extern "C" int
+LLVMFuzzerTestOneInput( const BYTE* data, size_t size )
+{
+    if ( size < 1 )
+        return 0;
+
+    int events = data[ 0 ] & FUZZ_MAX_EVENTS;
+    size_t schedule = 1 + 2 * static_cast< size_t >( events );
+
+    if ( size < schedule )
+        return 0;
+
+    const BYTE* rom = data + schedule;
+    size_t romSize = size - schedule;
+
+    if ( romSize > ROMSIZE - 0x200 )
+        romSize = ROMSIZE - 0x200;
+
+    EightChipCPU* cpu = g_Pool->Acquire( );
+    cpu->SetProfile( static_cast< EightChipProfile >( ( data[ 0 ] >> FUZZ_PROFILE_SHIFT ) & 0x3 ) );
+    cpu->PatchMemory( 0x200, rom, romSize );
+
+    if ( g_Coverage != nullptr )
+    {
+        g_Coverage->Clear( );
+        cpu->SetCoverage( g_Coverage );
+    }
+
+    for ( int frame = 0; frame < FUZZ_FRAMES; frame++ )
+    {
+        // Feed the keys scheduled for this frame
+        for ( int e = 0; e < events; e++ )
+        {
+            const BYTE* event = data + 1 + 2 * e;
+            if ( event[ 0 ] != frame )
+                continue;
+
+            if ( event[ 1 ] & 0x80 )
+                cpu->KeyDown( event[ 1 ] & 0xF );
+            else
+                cpu->KeyUp( event[ 1 ] & 0xF );
+        }
+
+        cpu->DecreaseTimers( );
+
+        cpu->ExecuteOpCodes( FUZZ_OPCODES_PER_FRAME );
+
+        int faults = cpu->GetFaults( );
+
+        if ( faults & g_TrapMask )
+        {
+            fprintf( stderr,
+                     "EightChip fuzz: %s at frame %d\n",
+                     FaultName( faults & g_TrapMask ),
+                     frame );
+            abort( );
+        }
+
+        // Nothing sensible runs past an illegal opcode
+        if ( faults & FAULT_ILLEGAL_OPCODE )
+            break;
+    }
+
+    if ( g_Coverage != nullptr )
+    {
+        cpu->SetCoverage( nullptr );
+
+        if ( g_CoverageTotal == nullptr )
+            g_CoverageTotal = new EightChipCoverage( *g_Coverage );
+        else
+            g_CoverageTotal->Merge( *g_Coverage );
+    }
+
+    g_Pool->Release( cpu );
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+#ifdef EIGHTCHIP_FUZZ_STANDALONE
+/** Without libFuzzer, replays the inputs given on the command line. */
+int
+main( int argc, char* argv[ ] )
+{
+    LLVMFuzzerInitialize( &argc, &argv );
+
+    for ( int i = 1; i < argc; i++ )
+    {
+        std::vector< BYTE > data;
+
+        if ( !ecrom::ReadFile( argv[ i ], data ) )
+        {
+            fprintf( stderr, "EightChip fuzz: unable to open %s\n", argv[ i ] );
+            continue;
+        }
+
+        LLVMFuzzerTestOneInput( data.data( ), data.size( ) );
+    }
+
+    return 0;
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,194 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ECHost.h"
+#include "ECQuirks.h"
+#include "ECRomImage.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * eight_chip_host: serves many sessions of a rom from a few worker threads (see. EightChipHost).
+ *
+ * usage: eight_chip_host ROMFILE [--sessions N] [--threads N] [--seconds N]
+ *                        [--opcodes-per-frame N] [--profile NAME] [--seed N]
+ *                        [--shared-memory PREFIX] [--idle PERCENT]
+ *
+ * With --shared-memory, session n publishes its frames and takes its keys in the segment
+ * PREFIXn, as the emulator does with SharedMemory. Otherwise users are simulated: --idle percent
+ * of them never press a key, the others press a random key now and then. The host runs for
+ * --seconds and reports on its frames and deadlines.
+ */
+namespace
+{
+    struct HostOptions
+    {
+        std::string rom;
+        int sessions = 64;
+        int threads = 0;
+        int seconds = 10;
+        int opcodesPerFrame = 1000;
+        bool hasProfile = false;
+        EightChipProfile profile = PROFILE_EIGHTCHIP;
+        unsigned int seed = 1;
+        std::string sharedPrefix;
+        int idle = 50;
+    };
+
+    //---------------------------------------------------------------------------------------------
+    bool
+    ParseArguments( int argc, char* argv[ ], HostOptions& options )
+    {
+        for ( int i = 1; i < argc; i++ )
+        {
+            bool hasValue = i + 1 < argc;
+
+            if ( strcmp( argv[ i ], "--sessions" ) == 0 && hasValue )
+                options.sessions = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--threads" ) == 0 && hasValue )
+                options.threads = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--seconds" ) == 0 && hasValue )
+                options.seconds = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--opcodes-per-frame" ) == 0 && hasValue )
+                options.opcodesPerFrame = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--seed" ) == 0 && hasValue )
+                options.seed = static_cast< unsigned int >( strtoul( argv[ ++i ], nullptr, 0 ) );
+            else if ( strcmp( argv[ i ], "--shared-memory" ) == 0 && hasValue )
+                options.sharedPrefix = argv[ ++i ];
+            else if ( strcmp( argv[ i ], "--idle" ) == 0 && hasValue )
+                options.idle = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--profile" ) == 0 && hasValue )
+            {
+                if ( !ecquirks::ProfileFromName( argv[ ++i ], options.profile ) )
+                    return false;
+
+                options.hasProfile = true;
+            }
+            else if ( argv[ i ][ 0 ] != '-' && options.rom.empty( ) )
+                options.rom = argv[ i ];
+            else
+                return false;
+        }
+
+        return !options.rom.empty( ) && options.sessions > 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    // xorshift32, as the CPU's, so runs can be replayed from --seed
+    unsigned int
+    NextRandom( unsigned int& state )
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        return state;
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+int
+main( int argc, char* argv[ ] )
+{
+    HostOptions options;
+
+    if ( !ParseArguments( argc, argv, options ) )
+    {
+        fprintf( stderr,
+                 "usage: %s ROMFILE [--sessions N] [--threads N] [--seconds N]\n"
+                 "       [--opcodes-per-frame N] [--profile NAME] [--seed N]\n"
+                 "       [--shared-memory PREFIX] [--idle PERCENT]\n",
+                 argv[ 0 ] );
+        return 1;
+    }
+
+    EightChipProfile profile = options.hasProfile ? options.profile
+                                                  : ecquirks::ProfileFromRomFile( options.rom );
+    std::shared_ptr< EightChipRomImage > image = std::make_shared< EightChipRomImage >( );
+
+    if ( !image->Load( options.rom, profile ) )
+    {
+        printf( "%s: %s\n", options.rom.c_str( ), ERR03 );
+        return 1;
+    }
+
+    EightChipHostConfig config;
+    config.threads = options.threads;
+    config.opcodesPerFrame = options.opcodesPerFrame;
+
+    EightChipHost host( config );
+    std::vector< int > sessions;
+
+    // Sessions start as they are opened, as users would connect
+    host.Start( );
+
+    for ( int i = 0; i < options.sessions; i++ )
+    {
+        std::string shared;
+
+        if ( !options.sharedPrefix.empty( ) )
+            shared = options.sharedPrefix + std::to_string( i );
+
+        int session = host.OpenSession( image, options.seed + i, shared );
+
+        if ( session < 0 )
+        {
+            fprintf( stderr, "%s: can't create the shared memory segment\n", shared.c_str( ) );
+            return 1;
+        }
+
+        sessions.push_back( session );
+    }
+
+    // Simulated users change their keys about twice a second
+    unsigned int random = ( options.seed != 0 ) ? options.seed : 1;
+    int idle = options.sessions * options.idle / 100;
+    int frames = options.seconds * config.frameRate;
+
+    auto start = std::chrono::steady_clock::now( );
+
+    for ( int frame = 0; frame < frames; frame++ )
+    {
+        if ( options.sharedPrefix.empty( ) )
+        {
+            for ( int i = idle; i < options.sessions; i++ )
+            {
+                if ( NextRandom( random ) % 30 != 0 )
+                    continue;
+
+                unsigned int press = NextRandom( random ) % 32;
+                WORD keys = ( press < 16 ) ? static_cast< WORD >( 1 << press ) : 0;
+
+                host.SetKeys( sessions[ i ], keys );
+            }
+        }
+
+        std::this_thread::sleep_until(
+            start + std::chrono::microseconds( 1000000LL * ( frame + 1 ) / config.frameRate ) );
+    }
+
+    host.Stop( );
+
+    std::chrono::duration< double > elapsed = std::chrono::steady_clock::now( ) - start;
+    EightChipHostStats stats = host.GetStats( );
+    unsigned long long checked = stats.frames + stats.parked;
+
+    printf( "%s: %d sessions on %d threads for %.1fs\n", options.rom.c_str( ), options.sessions,
+            host.GetThreads( ), elapsed.count( ) );
+    printf( "  frames run      %llu (%.1f per session per second)\n", stats.frames,
+            stats.frames / elapsed.count( ) / options.sessions );
+    printf( "  frames parked   %llu (%.1f%%)\n", stats.parked,
+            ( checked > 0 ) ? stats.parked * 100.0 / checked : 0.0 );
+    printf( "  deadlines       %llu missed, %.3fms late on average, %.3fms at most\n", stats.missed,
+            stats.meanLateness, stats.maxLateness );
+    printf( "  steals          %llu\n", stats.steals );
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,151 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ECLockstep.h"
+#include "ECRom.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * eight_chip_lockstep: runs two engines side by side on each rom and reports where they part.
+ *
+ * usage: eight_chip_lockstep ROMFILE... [--engines A,B] [--frames N] [--opcodes-per-frame N]
+ *                            [--block N] [--input SEED] [--seed N]
+ *                            [--profile eightchip|chip8|schip|xochip]
+ *
+ * The engines default to interpreter,step (see. ecengine::GetNames). Keys are pressed at random
+ * from the input seed, the same for both engines. Each rom gets its profile from its extension
+ * unless --profile is given. Exits with 2 when any rom diverged.
+ */
+namespace
+{
+    struct LockstepOptions
+    {
+        std::vector< std::string > roms;
+        std::string engines[ 2 ] = { "interpreter", "step" };
+        int frames = 600;
+        int opcodesPerFrame = 10;
+        int block = 1;
+        unsigned int input = 1;
+        unsigned int seed = 0;
+        bool hasProfile = false;
+        EightChipProfile profile = PROFILE_EIGHTCHIP;
+    };
+
+    bool
+    ParseArguments( int argc, char* argv[ ], LockstepOptions& options )
+    {
+        for ( int i = 1; i < argc; i++ )
+        {
+            bool hasValue = i + 1 < argc;
+
+            if ( strcmp( argv[ i ], "--engines" ) == 0 && hasValue )
+            {
+                std::string engines = argv[ ++i ];
+                size_t comma = engines.find( ',' );
+
+                if ( comma == std::string::npos )
+                    return false;
+
+                options.engines[ 0 ] = engines.substr( 0, comma );
+                options.engines[ 1 ] = engines.substr( comma + 1 );
+            }
+            else if ( strcmp( argv[ i ], "--frames" ) == 0 && hasValue )
+                options.frames = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--opcodes-per-frame" ) == 0 && hasValue )
+                options.opcodesPerFrame = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--block" ) == 0 && hasValue )
+                options.block = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--input" ) == 0 && hasValue )
+                options.input = static_cast< unsigned int >( strtoul( argv[ ++i ], nullptr, 0 ) );
+            else if ( strcmp( argv[ i ], "--seed" ) == 0 && hasValue )
+                options.seed = static_cast< unsigned int >( strtoul( argv[ ++i ], nullptr, 0 ) );
+            else if ( strcmp( argv[ i ], "--profile" ) == 0 && hasValue )
+            {
+                if ( !ecquirks::ProfileFromName( argv[ ++i ], options.profile ) )
+                    return false;
+
+                options.hasProfile = true;
+            }
+            else if ( argv[ i ][ 0 ] != '-' )
+                options.roms.push_back( argv[ i ] );
+            else
+                return false;
+        }
+
+        return !options.roms.empty( );
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+int
+main( int argc, char* argv[ ] )
+{
+    LockstepOptions options;
+
+    if ( !ParseArguments( argc, argv, options ) )
+    {
+        fprintf( stderr,
+                 "usage: %s ROMFILE... [--engines A,B] [--frames N] [--opcodes-per-frame N]\n"
+                 "       [--block N] [--input SEED] [--seed N]\n"
+                 "       [--profile eightchip|chip8|schip|xochip]\n",
+                 argv[ 0 ] );
+        return 1;
+    }
+
+    std::unique_ptr< EightChipEngine > engines[ 2 ];
+
+    for ( int i = 0; i < 2; i++ )
+    {
+        engines[ i ] = ecengine::CreateEngine( options.engines[ i ] );
+
+        if ( !engines[ i ] )
+        {
+            fprintf( stderr, "unknown engine %s\n", options.engines[ i ].c_str( ) );
+            return 1;
+        }
+    }
+
+    EightChipLockstepConfig config;
+    config.seed = options.seed;
+    config.frames = options.frames;
+    config.opcodesPerFrame = options.opcodesPerFrame;
+    config.block = options.block;
+    config.input = eclockstep::RandomInput( options.input, options.frames );
+
+    int diverged = 0;
+
+    for ( const std::string& filename : options.roms )
+    {
+        std::vector< BYTE > rom;
+
+        config.profile = options.hasProfile ? options.profile
+                                            : ecquirks::ProfileFromRomFile( filename );
+
+        EightChipLockstepResult result;
+
+        if ( !ecrom::ReadFile( filename, rom )
+             || !eclockstep::Run(
+                    *engines[ 0 ], *engines[ 1 ], rom.data( ), rom.size( ), config, result ) )
+        {
+            printf( "%s: %s\n", filename.c_str( ), ERR03 );
+            diverged++;
+            continue;
+        }
+
+        if ( !result.diverged )
+        {
+            printf( "%s: %llu instructions alike\n", filename.c_str( ), result.instructions );
+            continue;
+        }
+
+        printf( "%s: %s and %s part after %llu instructions, at 0x%04X\n%s", filename.c_str( ),
+                engines[ 0 ]->GetName( ), engines[ 1 ]->GetName( ), result.instructions,
+                result.programCounter, result.diff.c_str( ) );
+        diverged++;
+    }
+
+    return ( diverged > 0 ) ? 2 : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
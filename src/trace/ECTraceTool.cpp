@@ -0,0 +1,254 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "ECCpu.h"
+#include "ECQuirks.h"
+#include "ECTrace.h"
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * eight_chip_trace: records, decodes and compares execution traces (see. EightChipTracer).
+ *
+ * usage: eight_chip_trace record ROMFILE TRACEFILE [--frames N] [--opcodes-per-frame N]
+ *                                [--records N] [--seed N] [--profile eightchip|chip8|schip|xochip]
+ *        eight_chip_trace decode TRACEFILE
+ *        eight_chip_trace diff TRACEFILE TRACEFILE [--context N]
+ *
+ * record runs the rom headless and keeps the latest records, as the emulator does with Trace in
+ * its settings. diff walks both traces from their first instruction and stops at the first one
+ * that differs in any way, with the instructions leading to it.
+ */
+namespace
+{
+    struct TraceOptions
+    {
+        std::string command;
+        std::string files[ 2 ];
+        int fileCount = 0;
+        int frames = 600;
+        int opcodesPerFrame = 10;
+        size_t records = TRACE_DEFAULT_RECORDS;
+        unsigned int seed = 0;
+        int context = 8;
+        bool hasProfile = false;
+        EightChipProfile profile = PROFILE_EIGHTCHIP;
+    };
+
+    bool
+    ParseArguments( int argc, char* argv[ ], TraceOptions& options )
+    {
+        if ( argc < 2 )
+            return false;
+
+        options.command = argv[ 1 ];
+
+        for ( int i = 2; i < argc; i++ )
+        {
+            bool hasValue = i + 1 < argc;
+
+            if ( strcmp( argv[ i ], "--frames" ) == 0 && hasValue )
+                options.frames = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--opcodes-per-frame" ) == 0 && hasValue )
+                options.opcodesPerFrame = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--records" ) == 0 && hasValue )
+            {
+                long long records = atoll( argv[ ++i ] );
+
+                // An empty ring would have nowhere to keep even the latest instruction
+                if ( records <= 0 )
+                    return false;
+
+                options.records = static_cast< size_t >( records );
+            }
+            else if ( strcmp( argv[ i ], "--seed" ) == 0 && hasValue )
+                options.seed = static_cast< unsigned int >( strtoul( argv[ ++i ], nullptr, 0 ) );
+            else if ( strcmp( argv[ i ], "--context" ) == 0 && hasValue )
+                options.context = atoi( argv[ ++i ] );
+            else if ( strcmp( argv[ i ], "--profile" ) == 0 && hasValue )
+            {
+                if ( !ecquirks::ProfileFromName( argv[ ++i ], options.profile ) )
+                    return false;
+
+                options.hasProfile = true;
+            }
+            else if ( argv[ i ][ 0 ] != '-' && options.fileCount < 2 )
+                options.files[ options.fileCount++ ] = argv[ i ];
+            else
+                return false;
+        }
+
+        if ( options.command == "decode" )
+            return options.fileCount == 1;
+
+        if ( options.command == "record" || options.command == "diff" )
+            return options.fileCount == 2;
+
+        return false;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    int
+    Record( const TraceOptions& options )
+    {
+        std::unique_ptr< EightChipCPU > cpu( new EightChipCPU( ) );
+        cpu->SetProfile( options.hasProfile ? options.profile
+                                            : ecquirks::ProfileFromRomFile( options.files[ 0 ] ) );
+
+        if ( !cpu->InitRom( options.files[ 0 ] ) )
+        {
+            fprintf( stderr, ERR03 "\n" );
+            return 1;
+        }
+
+        if ( options.seed != 0 )
+            cpu->SetRandomSeed( options.seed );
+
+        EightChipTracer tracer( options.records );
+        tracer.SetFaultFile( options.files[ 1 ] );
+        cpu->SetTracer( &tracer );
+
+        for ( int frame = 0; frame < options.frames && !cpu->IsHalted( ); frame++ )
+        {
+            cpu->DecreaseTimers( );
+            cpu->ExecuteOpCodes( options.opcodesPerFrame );
+        }
+
+        cpu->SetTracer( nullptr );
+
+        size_t written = 0;
+
+        if ( !tracer.Flush( options.files[ 1 ], &written ) )
+        {
+            fprintf( stderr, ERR15 "\n" );
+            return 1;
+        }
+
+        // The file only keeps the latest records the ring held
+        printf( "%llu records traced, %zu written, faults=%X\n",
+                tracer.GetTotal( ),
+                written,
+                cpu->GetFaults( ) );
+
+        return 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    bool
+    LoadTrace( const std::string& filename, std::vector< EightChipTraceRecord >& records )
+    {
+        EightChipTraceHeader header;
+
+        if ( ectrace::Load( filename, records, header ) )
+            return true;
+
+        fprintf( stderr, "%s: not a trace file\n", filename.c_str( ) );
+
+        return false;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    int
+    Decode( const TraceOptions& options )
+    {
+        std::vector< EightChipTraceRecord > records;
+
+        if ( !LoadTrace( options.files[ 0 ], records ) )
+            return 1;
+
+        size_t index = 0;
+
+        while ( index < records.size( ) )
+            printf( "%s\n", ectrace::Describe( records, index ).c_str( ) );
+
+        return 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    int
+    Diff( const TraceOptions& options )
+    {
+        std::vector< EightChipTraceRecord > records[ 2 ];
+
+        if ( !LoadTrace( options.files[ 0 ], records[ 0 ] )
+             || !LoadTrace( options.files[ 1 ], records[ 1 ] ) )
+            return 1;
+
+        // Lines of the latest instructions both traces agree on
+        std::vector< std::string > history;
+        size_t index[ 2 ] = { 0, 0 };
+        size_t instruction = 0;
+
+        while ( index[ 0 ] < records[ 0 ].size( ) && index[ 1 ] < records[ 1 ].size( ) )
+        {
+            std::string lines[ 2 ] = {
+                ectrace::Describe( records[ 0 ], index[ 0 ] ),
+                ectrace::Describe( records[ 1 ], index[ 1 ] ),
+            };
+
+            if ( lines[ 0 ] != lines[ 1 ] )
+            {
+                printf( "traces diverge at instruction %zu\n", instruction );
+
+                for ( const std::string& line : history )
+                    printf( "  %s\n", line.c_str( ) );
+
+                printf( "< %s\n> %s\n", lines[ 0 ].c_str( ), lines[ 1 ].c_str( ) );
+
+                return 2;
+            }
+
+            history.push_back( lines[ 0 ] );
+
+            if ( static_cast< int >( history.size( ) ) > options.context )
+                history.erase( history.begin( ) );
+
+            instruction++;
+        }
+
+        if ( index[ 0 ] < records[ 0 ].size( ) || index[ 1 ] < records[ 1 ].size( ) )
+        {
+            const std::string& longer =
+                ( index[ 0 ] < records[ 0 ].size( ) ) ? options.files[ 0 ] : options.files[ 1 ];
+
+            printf( "traces agree on %zu instructions, then %s goes on\n",
+                    instruction,
+                    longer.c_str( ) );
+
+            return 2;
+        }
+
+        printf( "traces identical, %zu instructions\n", instruction );
+
+        return 0;
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+int
+main( int argc, char* argv[ ] )
+{
+    TraceOptions options;
+
+    if ( !ParseArguments( argc, argv, options ) )
+    {
+        fprintf( stderr,
+                 "usage: %s record ROMFILE TRACEFILE [--frames N] [--opcodes-per-frame N]\n"
+                 "       [--records N] [--seed N] [--profile eightchip|chip8|schip|xochip]\n"
+                 "       %s decode TRACEFILE\n"
+                 "       %s diff TRACEFILE TRACEFILE [--context N]\n",
+                 argv[ 0 ], argv[ 0 ], argv[ 0 ] );
+        return 1;
+    }
+
+    if ( options.command == "record" )
+        return Record( options );
+
+    if ( options.command == "decode" )
+        return Decode( options );
+
+    return Diff( options );
+}
+
+//-------------------------------------------------------------------------------------------------